@@ -23,6 +23,11 @@ namespace enumeration {
 				return maekawaValidCount_;
 			}
 
+			// counters of the detecter itself, e.g. memo hits.
+			virtual mylib::EnumerationStats detecterStats() const {
+				return mylib::EnumerationStats();
+			}
+
 		protected:
 
 			bool maekawaTheoremHolds(const TSet_Assignment& pattern) {
@@ -42,6 +47,26 @@ namespace enumeration {
 		public:
 			virtual ~IFlapCPAnswerDetecterFactory() {}
 			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const EncodablePatternBase& flap) const = 0;
+
+			// the default ignores the context.
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context) const {
+				return create(context.flap());
+			}
+
+			// the detecter may be on the arena. release it by destroy().
+			// the default allocates on the heap.
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context, mylib::MonotonicArena&) const {
+				return create(context);
+			}
+
+			static void destroy(AbstractFlapCPAnswerDetecter<TSet_Assignment>* detecter, const mylib::MonotonicArena& arena) {
+				if (arena.owns(detecter)) {
+					detecter->~AbstractFlapCPAnswerDetecter<TSet_Assignment>();
+				}
+				else {
+					delete detecter;
+				}
+			}
 		};
 
 
@@ -14,6 +14,13 @@
 #include "FlapCPEnumeration.hpp"
 #include "ItemCountingStream.hpp"
 #include "ParallelEnumeration.hpp"
+#include "BinaryCPFormat.hpp"
+#include "AsyncWriter.hpp"
+#include "IndexedCPFormat.hpp"
+#include "CPArchiveMerger.hpp"
+#include "SuccinctCPFormat.hpp"
+#include "KernelBenchmark.hpp"
+#include "ScalingReport.hpp"
 
 class AppMain {
 	std::string createRightAlignedString(int val, int maxLength) {
@@ -24,15 +31,102 @@ class AppMain {
 	}
 
 
+	enum class PatternOutput { NONE, TEXT, BINARY, INDEXED, SUCCINCT };
+
+	// one CP string per line, or binary records after a header
+	// (grouped by flap with an index if INDEXED, answer ranks of each flap if SUCCINCT).
+	// if async, the file is written on a writer thread so that file system stalls do not stop the enumeration.
 	class FileOutStream {
+		static const size_t BUFFER_SIZE = (size_t)1 << 20;
+
+		std::vector<char> buffer;
 		std::ofstream fout;
+
+		std::unique_ptr<mylib::AsyncWriter> async;
+		std::unique_ptr<mylib::AsyncWriterBuffer> asyncBuffer;
+		std::unique_ptr<std::ostream> asyncOut;
+
+		// fout or asyncOut.
+		std::ostream* out;
+		std::unique_ptr<enumeration::origami::BinaryCPWriter> binary;
+		std::unique_ptr<enumeration::origami::IndexedCPWriter> indexed;
+		std::unique_ptr<enumeration::origami::SuccinctCPWriter> succinct;
+
+		void openAsync() {
+			async.reset(new mylib::AsyncWriter(fout));
+			asyncBuffer.reset(new mylib::AsyncWriterBuffer(*async));
+			asyncOut.reset(new std::ostream(asyncBuffer.get()));
+			out = asyncOut.get();
+		}
+
 	public:
-		FileOutStream(const std::string& path) : fout(path) {
+		FileOutStream(const std::string& path, const bool isAsync = false) : buffer(BUFFER_SIZE), out(&fout) {
+			fout.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+			fout.open(path);
+			if (isAsync) {
+				openAsync();
+			}
+		}
+
+		FileOutStream(const std::string& path, const enumeration::origami::BinaryCPHeader& header, const PatternOutput format,
+			const bool isAsync = false) : out(&fout) {
+			fout.open(path, std::ios::binary);
+			if (isAsync) {
+				openAsync();
+			}
+			if (format == PatternOutput::INDEXED) {
+				indexed.reset(new enumeration::origami::IndexedCPWriter(*out, header));
+			}
+			else if (format == PatternOutput::SUCCINCT) {
+				succinct.reset(new enumeration::origami::SuccinctCPWriter(*out, header));
+			}
+			else {
+				binary.reset(new enumeration::origami::BinaryCPWriter(*out, header));
+			}
+		}
+
+		~FileOutStream() {
+			try {
+				close();
+			}
+			catch (...) {
+			}
+		}
+
+		// writes everything to the file. nothing should be written after this.
+		void close() {
+			binary.reset();
+			indexed.reset();
+			succinct.reset();
+			out->flush();
+			if (async) {
+				async->close();
+			}
+		}
+
+		// time the enumeration waited for the writer thread.
+		double stallSeconds() const {
+			return async ? async->stallSeconds() : 0.0;
 		}
 
 		template<typename T>
 		FileOutStream& operator<<(const T& val) {
-			fout << val << std::endl;
+			(*out) << val << '\n';
+			return *this;
+		}
+
+		FileOutStream& operator<<(const enumeration::origami::BinaryCPRecord& record) {
+			(*binary) << record;
+			return *this;
+		}
+
+		FileOutStream& operator<<(const enumeration::origami::IndexedCPRecord& record) {
+			(*indexed) << record;
+			return *this;
+		}
+
+		FileOutStream& operator<<(const enumeration::origami::SuccinctCPRecord& record) {
+			(*succinct) << record;
 			return *this;
 		}
 	};
@@ -40,13 +134,25 @@ class AppMain {
 	typedef typename enumeration::ItemCountingStream<FileOutStream> CountingStream;
 
 	template<typename TEnumerator, typename TOStream>
-	TEnumerator run(const int placeCount, TOStream& os, bool patternOutputIsNeeded) {
+	TEnumerator run(const int placeCount, TOStream& os, PatternOutput patternOutput) {
 		TEnumerator enumerator;
 
-		if (patternOutputIsNeeded) {
+		if (patternOutput == PatternOutput::TEXT) {
 			enumeration::origami::CPStringEncoder<CountingStream> cpStream(os);
 			enumerator.enumerate(placeCount, cpStream);
 		}
+		else if (patternOutput == PatternOutput::BINARY) {
+			enumeration::origami::BinaryCPEncoder<CountingStream> cpStream(os);
+			enumerator.enumerate(placeCount, cpStream);
+		}
+		else if (patternOutput == PatternOutput::INDEXED) {
+			enumeration::origami::IndexedCPEncoder<CountingStream> cpStream(os);
+			enumerator.enumerate(placeCount, cpStream);
+		}
+		else if (patternOutput == PatternOutput::SUCCINCT) {
+			enumeration::origami::SuccinctCPEncoder<CountingStream> cpStream(os);
+			enumerator.enumerate(placeCount, cpStream);
+		}
 		else {
 			enumeration::origami::CountOnlyEncoder<CountingStream> cpStream(os);
 			enumerator.enumerate(placeCount, cpStream);
@@ -59,8 +165,10 @@ class AppMain {
 
 	void printParameterHelp() {
 		std::cerr << "wrong parameters. please pass the followings:" << std::endl
-			<< "placeCount, [\"cp\" | \"cp_MVLSL\" | \"cp_ExMVLSL\" | \"maekawa\" | \"kawasaki\" | "
-			<< "\"cp_parallel\" | \"cp_exLSLparallel\" | \"maekawa_parallel\"] [output directory]";
+			<< "placeCount, [\"cp\" | \"cp_MVLSL\" | \"cp_linearMVTrie\" | \"cp_ExMVLSL\" | \"cp_revolving\" | \"cp_crimpPruning\" | \"cp_batch\" | \"cp_memo\" | \"cp_adaptive\" | \"bench_foldability\" | \"bench_kernels\" | \"maekawa\" | \"maekawa_revolving\" | \"kawasaki\" | "
+			<< "\"cp_parallel\" | \"cp_exLSLparallel\" | \"cp_crimpParallel\" | \"maekawa_parallel\"] [output directory] [\"binary\" | \"indexed\" | \"succinct\"] [\"async\"] [\"phases\"] [report=file] [trace=file]" << std::endl
+			<< "or merge pattern files into a sorted archive: merge archive patternFile..." << std::endl
+			<< "or compare reports of runs: compare baselineReport report [timeTolerance]";
 	}
 
 	std::string formatDirectoryText(const char* text) {
@@ -70,20 +178,358 @@ class AppMain {
 		return directory;
 	}
 
-	void enableFileOutput(CountingStream& counting, const std::string& directory, const std::string& algorithmName, const u_int placeCount) {
+	void enableFileOutput(CountingStream& counting, const std::string& directory, const std::string& algorithmName, const u_int placeCount,
+		const bool isAsync) {
 
 		std::shared_ptr<FileOutStream> fout_ptr(new FileOutStream(
-			directory + algorithmName + "_" + createRightAlignedString(placeCount, 3) + ".txt"));
+			directory + algorithmName + "_" + createRightAlignedString(placeCount, 3) + ".txt", isAsync));
 
 		counting.setStream(fout_ptr);
+		fileOut = fout_ptr;
+	}
+
+	// the file name is the same as the text output but .cpb (BINARY), .cpi (INDEXED) or .cpr (SUCCINCT).
+	void enableBinaryFileOutput(CountingStream& counting, const std::string& directory, const std::string& algorithmName,
+		const u_int placeCount, const int rank, const PatternOutput format, const bool isAsync) {
+
+		const std::string extension = (format == PatternOutput::INDEXED) ? ".cpi" :
+			(format == PatternOutput::SUCCINCT) ? ".cpr" : ".cpb";
+		enumeration::origami::BinaryCPHeader header(placeCount, algorithmName, rank);
+		std::shared_ptr<FileOutStream> fout_ptr(new FileOutStream(
+			directory + algorithmName + "_ID_" + std::to_string(rank) + "_" + createRightAlignedString(placeCount, 3) + extension,
+			header, format, isAsync));
+
+		counting.setStream(fout_ptr);
+		fileOut = fout_ptr;
+	}
+
+	bool hasOption(const int argc, char *argv[], const std::string& option) {
+		for (int i = ARG_INDEX_OUTPUT_FORMAT; i < argc; i++) {
+			if (option == argv[i]) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// returns the value of "prefix value" such as "report=file", or empty if it is not given.
+	// it is removed from the arguments after the algorithm name so that the positional arguments are unchanged.
+	std::string takeValueOption(int& argc, char *argv[], const std::string& prefix) {
+		for (int i = ARG_INDEX_OUTPUT; i < argc; i++) {
+			const std::string argument(argv[i]);
+			if (argument.compare(0, prefix.size(), prefix) == 0) {
+				std::copy(argv + i + 1, argv + argc, argv + i);
+				argc--;
+				return argument.substr(prefix.size());
+			}
+		}
+		return "";
+	}
+
+	// removes the flag from the arguments after the algorithm name so that the positional arguments are unchanged.
+	bool takeFlagOption(int& argc, char *argv[], const std::string& flag) {
+		for (int i = ARG_INDEX_OUTPUT; i < argc; i++) {
+			if (flag == argv[i]) {
+				std::copy(argv + i + 1, argv + argc, argv + i);
+				argc--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// compare baselineReport report [timeTolerance]
+	// returns 1 if a run is slower than the tolerance or has a different pattern count.
+	int runCompare(int argc, char *argv[]) {
+		if (argc < 4) {
+			printParameterHelp();
+			return 1;
+		}
+
+		const double timeTolerance = (argc >= 5) ? atof(argv[4]) : 0.1;
+		mylib::ScalingComparison comparison(timeTolerance);
+		auto differences = comparison.compare(mylib::ScalingReport::read(argv[2]), mylib::ScalingReport::read(argv[3]));
+
+		bool hasRegression = false;
+		for (const auto& difference : differences) {
+			std::cout << difference.toString() << std::endl;
+			hasRegression |= difference.isRegression();
+		}
+		std::cout << (hasRegression ? "regression found." : "no regression.") << std::endl;
+
+		return hasRegression ? 1 : 0;
+	}
+
+	template<typename TEnumerator>
+	void recordStats(TEnumerator& enumerator) {
+		report.kawasakiStats = enumerator.kawasakiStats();
+		report.mvStats = enumerator.mvStats();
+		phaseTimes = enumerator.phaseTimes();
+	}
+
+	// sums the phase times of the processes.
+	void printPhaseTimes(const std::string& title) {
+		int myID;
+		MPI_Comm_rank(MPI_COMM_WORLD, &myID);
+
+		enumeration::origami::PhaseTimes total;
+		MPI_Reduce(phaseTimes.seconds, total.seconds, enumeration::origami::PhaseTimes::PHASE_COUNT,
+			MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+		if (myID == 0) {
+			std::cout << title << std::endl;
+			total.write(std::cout);
+		}
+	}
+
+	// the serial algorithms on rank 0. returns false if there is no such algorithm.
+	template<bool needTimers>
+	bool runSerial(const std::string& algorithmName, const u_int placeCount, CountingStream& os, PatternOutput patternOutput) {
+		using namespace enumeration::origami;
+
+		if (algorithmName == "kawasaki") {
+			auto enumerator = run<KawasakiFlapEnumeration<true> >(placeCount, os, patternOutput);
+			report.kawasakiStats = enumerator.kawasakiStats();
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+		}
+		else if (algorithmName == "maekawa") {
+			auto enumerator = run<MaekawaFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "maekawa_revolving") {
+			auto enumerator = run<RevolvingDoorMaekawaFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "cp") {
+			auto enumerator = run<FoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "cp_revolving") {
+			auto enumerator = run<RevolvingDoorFoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "cp_linearMV") {
+			auto enumerator = run<LinearMVFoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "cp_linearMVTrie") {
+			auto enumerator = run<TrieLinearMVFoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "cp_MVLSL") {
+			auto enumerator = run<MVLSLFoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "cp_ExMVLSL") {
+			auto enumerator = run<ExMVLSLFoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "cp_crimpPruning") {
+			auto enumerator = run<CrimpPruningFoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "cp_memo") {
+			auto enumerator = run<MemoizedFoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+			std::cout << "memo hit rate       " << enumerator.mvStats().memoHitRate() << std::endl;
+		}
+		else if (algorithmName == "cp_adaptive") {
+			auto enumerator = run<AdaptiveFoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "linear threshold    " << enumerator.linearThreshold() << std::endl;
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else if (algorithmName == "cp_batch") {
+			auto enumerator = run<BatchFoldableFlapCPEnumeration<true, mylib::BitSet, needTimers> >(placeCount, os, patternOutput);
+			recordStats(enumerator);
+			std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
+			std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
+			std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
+		}
+		else {
+			return false;
+		}
+		return true;
+	}
+
+	template<typename TEnumerator>
+	void recordParallel(TEnumerator& enumerator) {
+		phaseTimes = enumerator.phaseTimes();
+		traceEvents = enumerator.traceEvents();
+	}
+
+	template<bool needTimers, bool needTrace>
+	void runParallel(const std::string& algorithmName, const u_int placeCount, CountingStream& os, PatternOutput patternOutput) {
+		using namespace enumeration::origami;
+
+		if (algorithmName == "cp_parallel") {
+			auto enumerator = run<FoldableFlapCPParallelEnumeration<mylib::BitSet, needTimers, needTrace> >(placeCount, os, patternOutput);
+			recordParallel(enumerator);
+		}
+		else if (algorithmName == "cp_exLSLparallel") {
+			auto enumerator = run<ExLSLFoldableFlapCPParallelEnumeration<mylib::BitSet, needTimers, needTrace> >(placeCount, os, patternOutput);
+			recordParallel(enumerator);
+		}
+		else if (algorithmName == "cp_crimpParallel") {
+			auto enumerator = run<CrimpPruningFoldableFlapCPParallelEnumeration<mylib::BitSet, needTimers, needTrace> >(placeCount, os, patternOutput);
+			recordParallel(enumerator);
+		}
+		else{
+			auto enumerator = run<MaekawaFlapCPParallelEnumeration<mylib::BitSet, needTimers, needTrace> >(placeCount, os, patternOutput);
+			recordParallel(enumerator);
+		}
+	}
+
+	template<bool needTimers>
+	void runParallel(const std::string& algorithmName, const u_int placeCount, CountingStream& os, PatternOutput patternOutput,
+		const bool needTrace) {
+
+		if (needTrace) {
+			runParallel<needTimers, true>(algorithmName, placeCount, os, patternOutput);
+		}
+		else {
+			runParallel<needTimers, false>(algorithmName, placeCount, os, patternOutput);
+		}
+	}
+
+	// gathers the events of the processes and writes them on rank 0.
+	void writeTrace(const std::string& tracePath) {
+		int myID, processCount;
+		MPI_Comm_rank(MPI_COMM_WORLD, &myID);
+		MPI_Comm_size(MPI_COMM_WORLD, &processCount);
+
+		auto events = mylib::ChromeTraceWriter::gather(traceEvents, 0);
+		if (myID != 0) {
+			return;
+		}
 
+		std::ofstream fout(tracePath);
+		mylib::ChromeTraceWriter::write(fout, events, processCount);
+		std::cout << "trace: " << events.size() << " events to " << tracePath << std::endl;
 	}
 
+
+	// every process should call this since the peak RSS is the max of the processes.
+	void writeReport(const std::string& reportPath, const std::string& algorithmName, const u_int placeCount,
+		const double seconds, const unsigned long long patternCount) {
+
+		if (reportPath.empty()) {
+			return;
+		}
+
+		unsigned long long peakRSS = mylib::peakResidentKiloBytes();
+		unsigned long long maxPeakRSS = 0ULL;
+		MPI_Reduce(&peakRSS, &maxPeakRSS, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+
+		int myID, processCount;
+		MPI_Comm_rank(MPI_COMM_WORLD, &myID);
+		MPI_Comm_size(MPI_COMM_WORLD, &processCount);
+		if (myID != 0) {
+			return;
+		}
+
+		report.algorithm = algorithmName;
+		report.placeCount = placeCount;
+		report.processCount = processCount;
+		report.seconds = seconds;
+		report.patternCount = patternCount;
+		report.peakRSSKiloBytes = maxPeakRSS;
+		mylib::ScalingReport::append(reportPath, report);
+	}
+
+	// merge archive patternFile...
+	int runMerge(int argc, char *argv[]) {
+		if (argc < 4) {
+			printParameterHelp();
+			return 1;
+		}
+
+		const std::string archivePath(argv[2]);
+		std::vector<std::string> inputs(argv + 3, argv + argc);
+
+		const double startTime = MPI_Wtime();
+
+		try {
+			// the archive replaces archivePath only if every write succeeds.
+			enumeration::origami::CPArchiveFileWriter file(archivePath);
+			enumeration::origami::CPArchiveWriter& archive = file.archive();
+			enumeration::origami::CPArchiveMerger merger(archivePath);
+			merger.merge(inputs, archive);
+			file.commit();
+
+			const double endTime = MPI_Wtime();
+
+			std::cout << "#input file = " << inputs.size() << std::endl;
+			std::cout << "#pattern = " << archive.patternCount() << std::endl;
+			std::cout << "#block = " << archive.blockCount() << std::endl;
+			std::cout << "#run = " << merger.runCount() << std::endl;
+			std::cout << "time: " << endTime - startTime << "[sec]" << std::endl;
+		}
+		catch (const std::exception& e) {
+			// the temporary files are removed on the way out.
+			std::cerr << "merge failed: " << e.what() << std::endl;
+			return 1;
+		}
+
+		return 0;
+	}
+
+	// writes the rest of the output before the time is measured.
+	void closeFileOutput() {
+		if (fileOut != nullptr) {
+			fileOut->close();
+		}
+	}
+
+	std::shared_ptr<FileOutStream> fileOut;
+
+	// stats of the serial algorithms for writeReport().
+	mylib::ScalingRecord report;
+
+	// of this process if the "phases" option is given.
+	enumeration::origami::PhaseTimes phaseTimes;
+
+	// of this process if the "trace" option is given.
+	std::vector<mylib::TraceEvent> traceEvents;
+
 public:
 	const int ARG_INDEX_SIZE = 1;
 	const int ARG_INDEX_ALGORITHM = ARG_INDEX_SIZE + 1;
 	const int ARG_INDEX_OUTPUT = ARG_INDEX_ALGORITHM + 1;
-	const int ARG_COUNT = ARG_INDEX_OUTPUT + 1;
+	const int ARG_INDEX_OUTPUT_FORMAT = ARG_INDEX_OUTPUT + 1;
+	const int ARG_COUNT = ARG_INDEX_OUTPUT_FORMAT + 1;
 
 	int runMain(int argc, char *argv[])
 	{
@@ -91,6 +537,12 @@ public:
 		MPI_Comm_rank(MPI_COMM_WORLD, &myID);
 
 		//std::cout << "ID " << myID << " start." << std::endl;
+
+		// "report=file" appends a record of the run to file (.csv or .json).
+		const std::string reportPath = takeValueOption(argc, argv, "report=");
+		// "trace=file" writes the timeline of the parallel algorithms in the chrome trace format.
+		const std::string tracePath = takeValueOption(argc, argv, "trace=");
+		const bool needTimers = takeFlagOption(argc, argv, "phases");
 	
 		if (argc < ARG_INDEX_OUTPUT) {
 			if (myID == 0)
@@ -99,6 +551,14 @@ public:
 			return 1;
 		}
 
+		if (std::string(argv[1]) == "merge") {
+			return (myID == 0) ? runMerge(argc, argv) : 0;
+		}
+
+		if (std::string(argv[1]) == "compare") {
+			return (myID == 0) ? runCompare(argc, argv) : 0;
+		}
+
 		using namespace enumeration::origami;
 		
 		const u_int placeCount = atoi(argv[ARG_INDEX_SIZE]);
@@ -112,36 +572,84 @@ public:
 
 		const std::string algorithmName(argv[ARG_INDEX_ALGORITHM]);
 
+		// placeCount is used as the max line count.
+		if (algorithmName == "bench_foldability") {
+			if (myID == 0) {
+				FoldabilityBenchmark benchmark;
+				auto timingsList = benchmark.measureRange(4, placeCount);
+
+				std::cout << "lines,quadratic[ns],linear[ns]" << std::endl;
+				for (const auto& timings : timingsList) {
+					std::cout << timings.lineCount << "," << timings.quadraticNanoSec << "," << timings.linearNanoSec << std::endl;
+				}
+				std::cout << "crossover " << FoldabilityBenchmark::findCrossover(timingsList) << std::endl;
+			}
+			return 0;
+		}
+
+		// microbenchmarks on the kawasaki flaps of placeCount.
+		if (algorithmName == "bench_kernels") {
+			if (myID == 0) {
+				KernelBenchmark benchmark(placeCount);
+				auto timings = benchmark.measureAll();
+
+				KernelBenchmark::writeCSV(std::cout, timings);
+				std::cout << "checksum " << benchmark.checksum() << std::endl;
+			}
+			return 0;
+		}
+
 		//std::cout << "start " << algorithmName << " ID=" << myID << std::endl;
 
-		bool fileOutputIsNeeded = (argc >= ARG_INDEX_OUTPUT + 1);
-		if (fileOutputIsNeeded) {
+		PatternOutput patternOutput = PatternOutput::NONE;
+		const bool isAsync = argc >= ARG_INDEX_OUTPUT + 1 && hasOption(argc, argv, "async");
+		if (isAsync) {
+			std::cout << "enables asynchronous file writing." << std::endl;
+		}
+
+		if (hasOption(argc, argv, "binary")) {
+			std::cout << "enables binary file output." << std::endl;
+			patternOutput = PatternOutput::BINARY;
+			enableBinaryFileOutput(os, formatDirectoryText(argv[ARG_INDEX_OUTPUT]), algorithmName, placeCount, myID, patternOutput, isAsync);
+		}
+		else if (hasOption(argc, argv, "indexed")) {
+			std::cout << "enables indexed file output." << std::endl;
+			patternOutput = PatternOutput::INDEXED;
+			enableBinaryFileOutput(os, formatDirectoryText(argv[ARG_INDEX_OUTPUT]), algorithmName, placeCount, myID, patternOutput, isAsync);
+		}
+		else if (hasOption(argc, argv, "succinct")) {
+			std::cout << "enables succinct file output." << std::endl;
+			patternOutput = PatternOutput::SUCCINCT;
+			enableBinaryFileOutput(os, formatDirectoryText(argv[ARG_INDEX_OUTPUT]), algorithmName, placeCount, myID, patternOutput, isAsync);
+		}
+		else if (argc >= ARG_INDEX_OUTPUT + 1) {
 			std::cout << "enables file output." << std::endl;
+			patternOutput = PatternOutput::TEXT;
 			// split file by ID
 			std::stringstream ss;
 			ss << myID;
-			enableFileOutput(os, formatDirectoryText(argv[ARG_INDEX_OUTPUT]), algorithmName + "_ID_" + ss.str(), placeCount);
+			enableFileOutput(os, formatDirectoryText(argv[ARG_INDEX_OUTPUT]), algorithmName + "_ID_" + ss.str(), placeCount, isAsync);
 		}
 
 
 
 
-		if (algorithmName == "cp_parallel" || algorithmName == "cp_exLSLparallel" || algorithmName == "maekawa_parallel") {
+		if (algorithmName == "cp_parallel" || algorithmName == "cp_exLSLparallel" || algorithmName == "cp_crimpParallel" ||
+			algorithmName == "maekawa_parallel") {
 			double startTime, endTime;
 
 			MPI_Barrier(MPI_COMM_WORLD);
 			startTime = MPI_Wtime();
 
 			unsigned long long int answerCount = 0ULL;
-			if (algorithmName == "cp_parallel") {
-				auto enumerator = run<FoldableFlapCPParallelEnumeration<> >(placeCount, os, fileOutputIsNeeded);
-			}
-			else if (algorithmName == "cp_exLSLparallel") {
-				auto enumerator = run<ExLSLFoldableFlapCPParallelEnumeration<> >(placeCount, os, fileOutputIsNeeded);
+			const bool needTrace = !tracePath.empty();
+			if (needTimers) {
+				runParallel<true>(algorithmName, placeCount, os, patternOutput, needTrace);
 			}
-			else{
-				auto enumerator = run<MaekawaFlapCPParallelEnumeration<> >(placeCount, os, fileOutputIsNeeded);
+			else {
+				runParallel<false>(algorithmName, placeCount, os, patternOutput, needTrace);
 			}
+			closeFileOutput();
 
 			MPI_Barrier(MPI_COMM_WORLD);
 			endTime = MPI_Wtime();
@@ -153,10 +661,24 @@ public:
 			unsigned long long int totalAll = 0;
 			MPI_Reduce(&total, &totalAll, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
 
+			double stall = (fileOut != nullptr) ? fileOut->stallSeconds() : 0.0;
+			double maxStall = 0.0;
+			MPI_Reduce(&stall, &maxStall, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
 			if (myID == 0) {
 				std::cout << " #total_pattern = " << totalAll << std::endl;
 				std::cout << "time: " << endTime - startTime << "[sec]" << std::endl;
+				if (isAsync) {
+					std::cout << "output stall (max of workers): " << maxStall << "[sec]" << std::endl;
+				}
 			}
+			if (needTimers) {
+				printPhaseTimes("phases (sum of workers):");
+			}
+			if (needTrace) {
+				writeTrace(tracePath);
+			}
+			writeReport(reportPath, algorithmName, placeCount, endTime - startTime, totalAll);
 		}
 		else {
 			double startTime, endTime;
@@ -166,54 +688,31 @@ public:
 
 			if (myID == 0) { //  serial algorithms
 
-				if (algorithmName == "kawasaki") {
-					auto enumerator = run<KawasakiFlapEnumeration<true> >(placeCount, os, fileOutputIsNeeded);
-					std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
-				}
-				else if (algorithmName == "maekawa") {
-					auto enumerator = run<MaekawaFlapCPEnumeration<true> >(placeCount, os, fileOutputIsNeeded);
-					std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
-					std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
-					std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
-				}
-				else if (algorithmName == "cp") {
-					auto enumerator = run<FoldableFlapCPEnumeration<true> >(placeCount, os, fileOutputIsNeeded);
-					std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
-					std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
-					std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
-				}
-				else if (algorithmName == "cp_linearMV") {
-					auto enumerator = run<LinearMVFoldableFlapCPEnumeration<true> >(placeCount, os, fileOutputIsNeeded);
-					std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
-					std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
-					std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
-				}
-				else if (algorithmName == "cp_MVLSL") {
-					auto enumerator = run<MVLSLFoldableFlapCPEnumeration<true> >(placeCount, os, fileOutputIsNeeded);
-					std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
-					std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
-					std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
-				}
-				else if (algorithmName == "cp_ExMVLSL") {
-					auto enumerator = run<ExMVLSLFoldableFlapCPEnumeration<true> >(placeCount, os, fileOutputIsNeeded);
-					std::cout << "kawasaki efficiency " << enumerator.kawasakiStats().searchEfficiency() << std::endl;
-					std::cout << "mv efficiency       " << enumerator.mvStats().searchEfficiency() << std::endl;
-					std::cout << "#pattern/#(k&m)     " << enumerator.sufficientRate() << std::endl;
-				}
-				else {
+				const bool found = needTimers ? runSerial<true>(algorithmName, placeCount, os, patternOutput) :
+					runSerial<false>(algorithmName, placeCount, os, patternOutput);
+				if (!found) {
 					std::cerr << "No such algorithm: " << algorithmName << std::endl;
 					printParameterHelp();
 					MPI_Barrier(MPI_COMM_WORLD);
 					return 1;
 				}
 			}
+			closeFileOutput();
+
 			MPI_Barrier(MPI_COMM_WORLD);
 			endTime = MPI_Wtime();
 
 			if (myID == 0) {
 				std::cout << " #pattern = " << os.toString() << std::endl;
 				std::cout << "time: " << endTime - startTime << "[sec]" << std::endl;
+				if (isAsync) {
+					std::cout << "output stall: " << fileOut->stallSeconds() << "[sec]" << std::endl;
+				}
+			}
+			if (needTimers) {
+				printPhaseTimes("phases:");
 			}
+			writeReport(reportPath, algorithmName, placeCount, endTime - startTime, os.total());
 		}
 
 		return 0;
@@ -0,0 +1,263 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace mylib {
+
+	// Bounded lock-free byte queue for exactly one producer thread and one consumer thread.
+	// The capacity must be a power of two.
+	class SPSCByteRing {
+		std::vector<char> buffer;
+		const size_t mask;
+
+		// written by the producer only.
+		std::atomic<size_t> tail;
+		// keeps head and tail on different cache lines.
+		char padding[64];
+		// written by the consumer only.
+		std::atomic<size_t> head;
+
+	public:
+		explicit SPSCByteRing(const size_t capacity) : buffer(capacity), mask(capacity - 1), tail(0), head(0) {
+			if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+				throw std::invalid_argument("SPSCByteRing: capacity should be a power of two.");
+			}
+		}
+
+		SPSCByteRing(const SPSCByteRing&) = delete;
+		SPSCByteRing& operator=(const SPSCByteRing&) = delete;
+
+		size_t capacity() const {
+			return buffer.size();
+		}
+
+		// producer: copies as many bytes as fit and returns the count.
+		size_t tryWrite(const char* data, const size_t size) {
+			const size_t t = tail.load(std::memory_order_relaxed);
+			const size_t h = head.load(std::memory_order_acquire);
+
+			const size_t n = std::min(size, capacity() - (t - h));
+			const size_t first = std::min(n, capacity() - (t & mask));
+			std::memcpy(&buffer[t & mask], data, first);
+			std::memcpy(&buffer[0], data + first, n - first);
+
+			tail.store(t + n, std::memory_order_release);
+			return n;
+		}
+
+		// producer: the number of writable bytes.
+		size_t space() const {
+			return capacity() - (tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire));
+		}
+
+		// consumer: the number of readable bytes.
+		size_t size() const {
+			return tail.load(std::memory_order_acquire) - head.load(std::memory_order_relaxed);
+		}
+
+		// consumer: the readable bytes which are contiguous in the buffer.
+		size_t peek(const char*& data) const {
+			const size_t h = head.load(std::memory_order_relaxed);
+			const size_t t = tail.load(std::memory_order_acquire);
+
+			data = &buffer[h & mask];
+			return std::min(t - h, capacity() - (h & mask));
+		}
+
+		// consumer: releases n bytes returned by peek().
+		void consume(const size_t n) {
+			head.store(head.load(std::memory_order_relaxed) + n, std::memory_order_release);
+		}
+	};
+
+
+	// Writes bytes to a stream on a dedicated thread.
+	// write() copies into an SPSCByteRing and returns;
+	// when the ring is full it waits for the writer thread (backpressure) and the wait is added to stallSeconds().
+	// write() and close() should be called from one thread.
+	//
+	// The bytes go through the lock-free ring. The mutex only guards the waits:
+	// the writer thread sleeps until minWriteSize bytes are queued and write() until the ring has space.
+	class AsyncWriter {
+		std::ostream& os;
+		SPSCByteRing ring;
+		const size_t minWriteSize;
+
+		std::atomic<bool> closing;
+		std::atomic<bool> failed;
+		bool closed;
+
+		std::mutex mutex;
+		std::condition_variable dataAvailable;
+		std::condition_variable spaceAvailable;
+
+		double stallSeconds_;
+		unsigned long long stallCount_;
+
+		std::thread writer;
+
+		// the state is changed before the lock, so the waiting thread cannot miss it.
+		void notify(std::condition_variable& condition) {
+			std::lock_guard<std::mutex> lock(mutex);
+			condition.notify_one();
+		}
+
+		void notifyIfEnoughData() {
+			if (ring.capacity() - ring.space() >= minWriteSize) {
+				notify(dataAvailable);
+			}
+		}
+
+		// the writer thread. waits until minWriteSize bytes are queued so that writes are large and sequential.
+		void drain() {
+			while (true) {
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					dataAvailable.wait(lock, [this]() {
+						return closing.load(std::memory_order_acquire) || ring.size() >= minWriteSize;
+					});
+				}
+
+				if (ring.size() == 0) {
+					// closing.
+					break;
+				}
+
+				const char* data;
+				const size_t n = ring.peek(data);
+				if (!failed.load(std::memory_order_relaxed)) {
+					os.write(data, n);
+					if (!os) {
+						failed.store(true, std::memory_order_release);
+					}
+				}
+				ring.consume(n);
+				notify(spaceAvailable);
+			}
+		}
+
+	public:
+		static const size_t DEFAULT_CAPACITY = (size_t)16 << 20;
+
+		AsyncWriter(std::ostream& os, const size_t capacity = DEFAULT_CAPACITY) :
+			os(os), ring(capacity), minWriteSize(std::max<size_t>(capacity / 4, 1)),
+			closing(false), failed(false), closed(false), stallSeconds_(0), stallCount_(0ULL),
+			writer(&AsyncWriter::drain, this) {
+		}
+
+		AsyncWriter(const AsyncWriter&) = delete;
+		AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+		~AsyncWriter() {
+			try {
+				close();
+			}
+			catch (...) {
+			}
+		}
+
+		void write(const char* data, const size_t size) {
+			size_t written = ring.tryWrite(data, size);
+			notifyIfEnoughData();
+			if (written == size) {
+				return;
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			while (written < size) {
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					spaceAvailable.wait(lock, [this]() {
+						return ring.space() > 0 || failed.load(std::memory_order_acquire);
+					});
+				}
+				if (failed.load(std::memory_order_acquire)) {
+					throw std::runtime_error("AsyncWriter: failed to write the stream.");
+				}
+				written += ring.tryWrite(data + written, size - written);
+				notifyIfEnoughData();
+			}
+			stallSeconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			stallCount_++;
+		}
+
+		// writes every queued byte and stops the writer thread.
+		void close() {
+			if (closed) {
+				return;
+			}
+			closed = true;
+
+			closing.store(true, std::memory_order_release);
+			notify(dataAvailable);
+			writer.join();
+			os.flush();
+
+			if (failed.load(std::memory_order_acquire) || !os) {
+				throw std::runtime_error("AsyncWriter: failed to write the stream.");
+			}
+		}
+
+		// time write() waited for free space.
+		double stallSeconds() const {
+			return stallSeconds_;
+		}
+
+		unsigned long long stallCount() const {
+			return stallCount_;
+		}
+	};
+
+
+	// std::streambuf passing characters to an AsyncWriter in chunks of bufferSize bytes.
+	class AsyncWriterBuffer : public std::streambuf {
+		AsyncWriter& writer;
+		std::vector<char> buffer;
+
+	protected:
+		virtual int_type overflow(int_type ch) {
+			sync();
+			if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+				*pptr() = traits_type::to_char_type(ch);
+				pbump(1);
+			}
+			return traits_type::not_eof(ch);
+		}
+
+		virtual std::streamsize xsputn(const char* s, std::streamsize n) {
+			if (n > epptr() - pptr()) {
+				sync();
+				writer.write(s, (size_t)n);
+			}
+			else {
+				std::memcpy(pptr(), s, (size_t)n);
+				pbump((int)n);
+			}
+			return n;
+		}
+
+		virtual int sync() {
+			writer.write(pbase(), pptr() - pbase());
+			setp(buffer.data(), buffer.data() + buffer.size());
+			return 0;
+		}
+
+	public:
+		static const size_t DEFAULT_BUFFER_SIZE = (size_t)64 << 10;
+
+		AsyncWriterBuffer(AsyncWriter& writer, const size_t bufferSize = DEFAULT_BUFFER_SIZE) :
+			writer(writer), buffer(std::max<size_t>(bufferSize, 1)) {
+			setp(buffer.data(), buffer.data() + buffer.size());
+		}
+	};
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include "MVEnumeration.hpp"
+#include "BitSlicedFoldability.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		/**
+		 * Enumerates maekawa-valid assignments by RevolvingDoorMVEnumeration
+		 * and tests their foldability in batches of BitSlicedFoldabilityTester::LANE_COUNT.
+		 *
+		 * ansDetecter should be a maekawa condition (e.g. StatsMaekawaTheorem),
+		 * since this class tests foldability by itself.
+		 */
+		template<typename TOStream, typename TSet_Assignment, bool needStats = true>
+		class BatchFoldableMVEnumeration : public IMVEnumeration<TOStream, TSet_Assignment, needStats> {
+			typedef BatchFoldabilityStream<TOStream, TSet_Assignment> TBatchStream;
+
+			mylib::EnumerationStats stats;
+
+		public:
+			BatchFoldableMVEnumeration() {}
+
+			virtual const mylib::EnumerationStats& mvStats() {
+				return stats;
+			}
+
+			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning = MaekawaPruning<TSet_Assignment>()) {
+
+				FlapContext context(flap);
+				return enumerateInContext(context, os, ansDetecter, pruning);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning) {
+
+				BitSlicedFoldabilityTester tester(context);
+				TBatchStream batch(tester, os);
+
+				RevolvingDoorMVEnumeration<TBatchStream, TSet_Assignment, needStats> maekawaValid;
+				stats = maekawaValid.enumerateInContext(context, batch, ansDetecter, pruning);
+
+				batch.flush();
+
+				if (needStats)
+					stats.answerCount = batch.foldableCount();
+
+				return stats;
+			}
+
+			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os) {
+				MaekawaTheorem<TSet_Assignment> ansDetecter;
+
+				return this->enumerate(flap, os, ansDetecter);
+			}
+		};
+	}
+}
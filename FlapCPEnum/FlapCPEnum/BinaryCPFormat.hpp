@@ -0,0 +1,258 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include "abbreviation.h"
+#include "FlapPattern.hpp"
+#include "ItemCountingStream.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		// a record made by EncodablePatternBase::encodeBinary(). the bytes are not owned.
+		struct BinaryCPRecord {
+			const unsigned char* bytes;
+			u_int size;
+
+			BinaryCPRecord(const unsigned char* bytes, const u_int size) : bytes(bytes), size(size) {}
+		};
+
+		/**
+		 * File layout (integers are little endian):
+		 *   "FCPB", version (u32), placeCount (u32), rank (u32), algorithm length (u32), algorithm,
+		 *   then records of (2 * placeCount + 7) / 8 bytes each.
+		 */
+		struct BinaryCPHeader {
+			static const uint32_t VERSION = 1;
+
+			u_int placeCount;
+			u_int rank;
+			std::string algorithm;
+
+			BinaryCPHeader() : placeCount(0), rank(0) {}
+
+			BinaryCPHeader(const u_int placeCount, const std::string& algorithm, const u_int rank) :
+				placeCount(placeCount), rank(rank), algorithm(algorithm) {}
+
+			u_int recordSize() const {
+				return (2 * placeCount + 7) / 8;
+			}
+
+			// bytes of write().
+			size_t size() const {
+				return 20 + algorithm.size();
+			}
+
+			// other formats with the same header pass their own 4 byte magic.
+			void write(std::ostream& os, const char* magic = "FCPB") const {
+				os.write(magic, 4);
+				writeUInt(os, VERSION);
+				writeUInt(os, placeCount);
+				writeUInt(os, rank);
+				writeUInt(os, algorithm.size());
+				os.write(algorithm.data(), algorithm.size());
+			}
+
+			void read(std::istream& is, const char* expectedMagic = "FCPB") {
+				char magic[4];
+				is.read(magic, 4);
+				if (!is || std::memcmp(magic, expectedMagic, 4) != 0) {
+					throw std::invalid_argument("BinaryCPHeader: not a binary CP file.");
+				}
+				if (readUInt(is) != VERSION) {
+					throw std::invalid_argument("BinaryCPHeader: unknown version.");
+				}
+				placeCount = readUInt(is);
+				rank = readUInt(is);
+
+				algorithm.resize(readUInt(is));
+				is.read(&algorithm[0], algorithm.size());
+				if (!is) {
+					throw std::invalid_argument("BinaryCPHeader: truncated header.");
+				}
+			}
+
+		private:
+			static void writeUInt(std::ostream& os, const uint32_t value) {
+				unsigned char bytes[4];
+				for (int i = 0; i < 4; i++) {
+					bytes[i] = (value >> (8 * i)) & 0xFF;
+				}
+				os.write((const char*)bytes, 4);
+			}
+
+			static uint32_t readUInt(std::istream& is) {
+				unsigned char bytes[4] = { 0, 0, 0, 0 };
+				is.read((char*)bytes, 4);
+				if (!is) {
+					throw std::invalid_argument("BinaryCPHeader: truncated header.");
+				}
+
+				uint32_t value = 0;
+				for (int i = 0; i < 4; i++) {
+					value |= (uint32_t)bytes[i] << (8 * i);
+				}
+				return value;
+			}
+		};
+
+		/**
+		* TOStream << enumeration::Countable(#line, BinaryCPRecord);
+		* the record is valid until the next call.
+		*/
+		template<typename TOStream>
+		class BinaryCPEncoder {
+			TOStream& outStream;
+			std::vector<unsigned char> bytes;
+
+		public:
+			BinaryCPEncoder(TOStream& os) : outStream(os) {
+			}
+
+			void operator()(const EncodablePatternBase& flap) {
+				bytes.resize(flap.binarySize());
+				flap.encodeBinary(bytes.data());
+				outStream << createCountable(flap.count() / 2 - 1, BinaryCPRecord(bytes.data(), bytes.size()));
+			}
+
+			BinaryCPEncoder& operator<<(const EncodablePatternBase& flap) {
+				(*this)(flap);
+				return *this;
+			}
+
+			template <typename TBitSet>
+			void operator()(const EncodablePatternBase& flap, const TBitSet& minors) {
+				bytes.resize(flap.binarySize());
+				flap.encodeBinary(minors, bytes.data());
+				outStream << createCountable(flap.count() / 2 - 1, BinaryCPRecord(bytes.data(), bytes.size()));
+			}
+		};
+
+		// writes the header and records through a buffer of bufferSize bytes.
+		class BinaryCPWriter {
+			std::ostream& os;
+			std::vector<char> buffer;
+			size_t used;
+			unsigned long long recordCount_;
+
+		public:
+			static const size_t DEFAULT_BUFFER_SIZE = (size_t)4 << 20;
+
+			BinaryCPWriter(std::ostream& os, const BinaryCPHeader& header, const size_t bufferSize = DEFAULT_BUFFER_SIZE) :
+				os(os), buffer(bufferSize), used(0), recordCount_(0ULL) {
+				header.write(os);
+			}
+
+			BinaryCPWriter(const BinaryCPWriter&) = delete;
+			BinaryCPWriter& operator=(const BinaryCPWriter&) = delete;
+
+			~BinaryCPWriter() {
+				flush();
+			}
+
+			BinaryCPWriter& operator<<(const BinaryCPRecord& record) {
+				if (used + record.size > buffer.size()) {
+					flush();
+				}
+				if (record.size > buffer.size()) {
+					os.write((const char*)record.bytes, record.size);
+				}
+				else {
+					std::memcpy(buffer.data() + used, record.bytes, record.size);
+					used += record.size;
+				}
+				recordCount_++;
+				return *this;
+			}
+
+			void flush() {
+				os.write(buffer.data(), used);
+				used = 0;
+				os.flush();
+			}
+
+			const unsigned long long& recordCount() const {
+				return recordCount_;
+			}
+		};
+
+		// reads a file written by BinaryCPWriter.
+		class BinaryCPReader {
+			std::istream& is;
+			BinaryCPHeader header_;
+			std::vector<unsigned char> bytes;
+
+		public:
+			BinaryCPReader(std::istream& is) : is(is) {
+				header_.read(is);
+				bytes.resize(header_.recordSize());
+			}
+
+			const BinaryCPHeader& header() const {
+				return header_;
+			}
+
+			// false at the end of the file.
+			bool next(std::string& cpString) {
+				if (!nextRecord()) {
+					return false;
+				}
+				cpString = decode(bytes.data(), header_.placeCount);
+				return true;
+			}
+
+			// the raw record is in record() if true.
+			bool nextRecord() {
+				if (is.peek() == std::istream::traits_type::eof()) {
+					return false;
+				}
+				is.read((char*)bytes.data(), bytes.size());
+				if (!is) {
+					throw std::invalid_argument("BinaryCPReader: truncated record.");
+				}
+				return true;
+			}
+
+			BinaryCPRecord record() const {
+				return BinaryCPRecord(bytes.data(), bytes.size());
+			}
+
+			// the CP string of EncodablePatternBase::encode().
+			static std::string decode(const unsigned char* bytes, const u_int placeCount) {
+				std::string cpString;
+				u_int emptyCount = 0;
+
+				for (u_int i = 0; i < placeCount; i++) {
+					const unsigned char code = (bytes[i / 4] >> (2 * (i % 4))) & 3;
+					if (code == EncodablePatternBase::BINARY_EMPTY) {
+						emptyCount++;
+						continue;
+					}
+					if (emptyCount > 0) {
+						cpString += std::to_string(emptyCount);
+						emptyCount = 0;
+					}
+					if (code == EncodablePatternBase::BINARY_MAJOR) {
+						cpString += '+';
+					}
+					else if (code == EncodablePatternBase::BINARY_MINOR) {
+						cpString += '-';
+					}
+					else {
+						throw std::invalid_argument("BinaryCPReader: broken record.");
+					}
+				}
+				if (emptyCount > 0) {
+					cpString += std::to_string(emptyCount);
+				}
+
+				return cpString;
+			}
+		};
+	}
+}
@@ -1,5 +1,6 @@
 ﻿#include "BitArray.hpp"
 
-const mylib::BitArray::BitBlock mylib::BitArray::ALL_ONE_BITS = ~0;
+const mylib::BitArray::BitBlock mylib::BitArray::ALL_ONE_BITS = ~0ULL;
 const mylib::BitArray::BitBlock mylib::BitArray::ZERO_BITS = 0;
 const mylib::BitArray::BitBlock mylib::BitArray::ONE_BITS = 1;
+const u_int mylib::BitArray::OneBlockBitLength;
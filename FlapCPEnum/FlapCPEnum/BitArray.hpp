@@ -13,24 +13,35 @@
 
 #include <mpi.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 
 namespace mylib {
 
+	/**
+	 * Fixed-length bit array with 64-bit blocks.
+	 * Up to INLINE_BLOCK_COUNT blocks are stored in the instance itself; longer arrays use the heap.
+	 * Bits at bitLength() or higher are always 0.
+	 */
 	class BitArray {
 	public:
-		typedef u_int BitBlock;
+		typedef unsigned long long BitBlock;
 
 	private:
 		static const BitBlock ALL_ONE_BITS;
 		static const BitBlock ZERO_BITS;
 		static const BitBlock ONE_BITS;
 
-		BitBlock *blocks = NULL;
+		static const u_int OneBlockBitLength = 8 * sizeof(BitBlock);
+		static const u_int INLINE_BLOCK_COUNT = 2;
+
+		BitBlock inlineBlocks[INLINE_BLOCK_COUNT];
+		BitBlock *blocks = inlineBlocks;
 		u_int blockLength_ = 0;
 		u_int bitLength_ = 0;
 
-		static const u_int OneBlockBitLength = 8 * sizeof(BitBlock);
-
 		inline u_int blockIndex(u_int bitIndex) const {
 			return bitIndex / OneBlockBitLength;
 		}
@@ -39,37 +50,140 @@ namespace mylib {
 			return bitIndex % OneBlockBitLength;
 		}
 
+		bool usesHeap() const {
+			return blocks != inlineBlocks;
+		}
+
+		void release() {
+			if (usesHeap()) {
+				delete[] blocks;
+			}
+			blocks = inlineBlocks;
+			blockLength_ = 0;
+			bitLength_ = 0;
+		}
+
+		// 00...011...1 for the bits of the last block.
+		BitBlock lastBlockMask() const {
+			const u_int rest = localBitIndex(bitLength_);
+			return (rest == 0) ? ALL_ONE_BITS : ~(ALL_ONE_BITS << rest);
+		}
+
 		void substitute(const BitArray& right) {
 			// adjust blocks
-			if (blockLength() == right.blockLength()) {
-				clear();
-				bitLength_ = right.bitLength();
-			}
-			else {
-				delete[] blocks; // note: ""delete NULL" does nothing.
+			if (blockLength() != right.blockLength()) {
 				allocate(right.bitLength());
 			}
+			bitLength_ = right.bitLength();
 
 			std::copy(right.blocks, right.blocks + right.blockLength(), blocks);
 		}
 
+		// takes the storage of right. right becomes empty.
+		void steal(BitArray& right) {
+			if (right.usesHeap()) {
+				blocks = right.blocks;
+			}
+			else {
+				blocks = inlineBlocks;
+				std::copy(right.inlineBlocks, right.inlineBlocks + INLINE_BLOCK_COUNT, inlineBlocks);
+			}
+			blockLength_ = right.blockLength_;
+			bitLength_ = right.bitLength_;
+
+			right.blocks = right.inlineBlocks;
+			right.blockLength_ = 0;
+			right.bitLength_ = 0;
+		}
+
+		// existing values will be deleted.
 		void allocate(u_int bitLength) {
+			release();
+
 			bitLength_ = bitLength;
 
 			blockLength_ = blockIndex(bitLength);
 			if (localBitIndex(bitLength) != 0) blockLength_++;
 
-			blocks = new BitBlock[blockLength()];
-			//std::fill(blocks, blocks + blockLength(), ZERO_BITS);
+			if (blockLength_ > INLINE_BLOCK_COUNT) {
+				blocks = new BitBlock[blockLength()];
+			}
 
 			clear();
 		}
 
+		// block must not be 0.
+		static inline u_int countTrailingZeros(BitBlock block) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, block);
+			return (u_int)index;
+#else
+			return (u_int)__builtin_ctzll(block);
+#endif
+		}
+
+		static inline u_int countOnesOf(BitBlock block) {
+#ifdef _MSC_VER
+			return (u_int)__popcnt64(block);
+#else
+			return (u_int)__builtin_popcountll(block);
+#endif
+		}
+
+		static inline BitBlock reverseBits(BitBlock block) {
+			block = ((block >> 1) & 0x5555555555555555ULL) | ((block & 0x5555555555555555ULL) << 1);
+			block = ((block >> 2) & 0x3333333333333333ULL) | ((block & 0x3333333333333333ULL) << 2);
+			block = ((block >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((block & 0x0F0F0F0F0F0F0F0FULL) << 4);
+			block = ((block >> 8) & 0x00FF00FF00FF00FFULL) | ((block & 0x00FF00FF00FF00FFULL) << 8);
+			block = ((block >> 16) & 0x0000FFFF0000FFFFULL) | ((block & 0x0000FFFF0000FFFFULL) << 16);
+			return (block >> 32) | (block << 32);
+		}
+
+		// bits [from, from + count), count <= 64 and from + count <= blockLength() * 64.
+		BitBlock readBits(const u_int from, const u_int count) const {
+			const u_int index = blockIndex(from);
+			const u_int local = localBitIndex(from);
+
+			BitBlock bits = blocks[index] >> local;
+			if (local != 0 && local + count > OneBlockBitLength) {
+				bits |= blocks[index + 1] << (OneBlockBitLength - local);
+			}
+
+			return (count == OneBlockBitLength) ? bits : bits & ~(ALL_ONE_BITS << count);
+		}
+
+		// overwrites bits [from, from + count) with the low count bits of bits, count <= 64.
+		void writeBits(const u_int from, const u_int count, const BitBlock bits) {
+			const u_int index = blockIndex(from);
+			const u_int local = localBitIndex(from);
+			const BitBlock mask = (count == OneBlockBitLength) ? ALL_ONE_BITS : ~(ALL_ONE_BITS << count);
+
+			blocks[index] = (blocks[index] & ~(mask << local)) | (bits << local);
+			if (local != 0 && local + count > OneBlockBitLength) {
+				const u_int lowCount = OneBlockBitLength - local;
+				blocks[index + 1] = (blocks[index + 1] & ~(mask >> lowCount)) | (bits >> lowCount);
+			}
+		}
+
+		// bits [from, end) = bits [from + shift, end + shift) in increasing order.
+		// the source may reach the unused bits of the last block.
+		void moveToLower(const u_int from, const u_int shift, const u_int end) {
+			for (u_int i = from; i < end; i += OneBlockBitLength) {
+				const u_int count = std::min(OneBlockBitLength, end - i);
+				writeBits(i, count, readBits(i + shift, count));
+			}
+		}
+
 	public:
 		BitArray(const BitArray& bits) {
 			substitute(bits);
 		}
 
+		BitArray(BitArray&& bits) noexcept {
+			steal(bits);
+		}
+
 		BitArray() {
 		}
 
@@ -80,7 +194,7 @@ namespace mylib {
 
 
 		~BitArray() {
-			delete[] blocks;
+			release();
 		}
 
 		//============================================================================
@@ -103,10 +217,7 @@ namespace mylib {
 			// 11...100...0
 			const BitBlock lowCutMask = (ALL_ONE_BITS << localIndexFrom);
 
-			// << (localIndexTail+1) fails because
-			// recent CPU doesn't seem to interpret
-			// int x >> 32 (or << 32) as 0. ughhh!!!
-
+			// (x << 64) is undefined, so shift twice.
 			// 00...011...1
 			const BitBlock highCutMask = ~((ALL_ONE_BITS << localIndexTail) << 1);
 
@@ -115,18 +226,13 @@ namespace mylib {
 				return (blocks[blockIndexFrom] & mask) == mask;
 			}
 
-			if ((blocks[blockIndexFrom] & lowCutMask) != lowCutMask) {
-				return false;
-			}
-
-
+			// no early exit: the loop is a reduction the compiler can vectorize.
+			BitBlock all = (blocks[blockIndexFrom] | ~lowCutMask) & (blocks[blockIndexTail] | ~highCutMask);
 			for (u_int i = blockIndexFrom + 1; i < blockIndexTail; i++) {
-				if (blocks[i] != ALL_ONE_BITS) {
-					return false;
-				}
+				all &= blocks[i];
 			}
 
-			return (blocks[blockIndex(bitIndexTail)] & highCutMask) == highCutMask;
+			return all == ALL_ONE_BITS;
 		}
 
 		bool areAllZero(u_int bitIndexFrom, u_int bitIndexEnd) const {
@@ -140,10 +246,6 @@ namespace mylib {
 			// 11...100...0
 			const BitBlock lowCutMask = (ALL_ONE_BITS << localIndexFrom);
 
-			// << (localIndexTail+1) fails because
-			// recent CPU doesn't seem to interpret
-			// int x >> 32 (or << 32) as 0. ughhh!!!
-
 			// 00...011...1
 			const BitBlock highCutMask = ~((ALL_ONE_BITS << localIndexTail) << 1);
 
@@ -152,18 +254,53 @@ namespace mylib {
 				return (blocks[blockIndexFrom] & mask) == ZERO_BITS;
 			}
 
-			if ((blocks[blockIndexFrom] & lowCutMask) != ZERO_BITS) {
-				return false;
+			BitBlock any = (blocks[blockIndexFrom] & lowCutMask) | (blocks[blockIndexTail] & highCutMask);
+			for (u_int i = blockIndexFrom + 1; i < blockIndexTail; i++) {
+				any |= blocks[i];
 			}
 
+			return any == ZERO_BITS;
+		}
 
-			for (u_int i = blockIndexFrom + 1; i < blockIndexTail; i++) {
-				if (blocks[i] != ZERO_BITS) {
-					return false;
+		// count of 1s.
+		u_int countOnes() const {
+			u_int count = 0;
+			for (u_int i = 0; i < blockLength(); i++) {
+				count += countOnesOf(blocks[i]);
+			}
+			return count;
+		}
+
+		// the smallest index of 1 which is bitIndexFrom or higher. bitLength() if no such bit.
+		u_int findNext(u_int bitIndexFrom) const {
+			if (bitIndexFrom >= bitLength()) {
+				return bitLength();
+			}
+
+			u_int index = blockIndex(bitIndexFrom);
+			BitBlock block = blocks[index] & (ALL_ONE_BITS << localBitIndex(bitIndexFrom));
+
+			while (block == ZERO_BITS) {
+				index++;
+				if (index >= blockLength()) {
+					return bitLength();
 				}
+				block = blocks[index];
 			}
 
-			return (blocks[blockIndex(bitIndexTail)] & highCutMask) == ZERO_BITS;
+			return index * OneBlockBitLength + countTrailingZeros(block);
+		}
+
+		// calls func(index) for each 1 in increasing order.
+		template<typename TFunc>
+		void forEachSetBit(TFunc func) const {
+			for (u_int i = 0; i < blockLength(); i++) {
+				BitBlock block = blocks[i];
+				while (block != ZERO_BITS) {
+					func(i * OneBlockBitLength + countTrailingZeros(block));
+					block &= block - 1;
+				}
+			}
 		}
 
 		//============================================================================
@@ -174,7 +311,7 @@ namespace mylib {
 			std::cout << blockIndex(bitIndex) << " "
 				<< localBitIndex(bitIndex) << " "
 				<< "mask:" << std::hex
-				<< (1 << localBitIndex(bitIndex)) << std::dec << std::endl;
+				<< (ONE_BITS << localBitIndex(bitIndex)) << std::dec << std::endl;
 #endif
 			blocks[blockIndex(bitIndex)] |= (ONE_BITS << localBitIndex(bitIndex));
 
@@ -199,10 +336,6 @@ namespace mylib {
 			// 11...100...0
 			const BitBlock lowCutMask = (ALL_ONE_BITS << localIndexFrom);
 
-			// some strange 1-bit shift is needed because
-			// recent CPU doesn't seem to interpret
-			// int x >> 32 (or << 32) as 0. ughhh!!!
-
 			// 00...011...1
 			const BitBlock highCutMask = ~((ALL_ONE_BITS << localIndexTail) << 1);
 
@@ -213,10 +346,9 @@ namespace mylib {
 
 			blocks[blockIndexFrom] |= lowCutMask;
 
-			std::fill_n(blocks + blockIndexFrom + 1,
-				blockIndexTail - blockIndexFrom - 1, ALL_ONE_BITS);
+			std::fill(blocks + blockIndexFrom + 1, blocks + blockIndexTail, ALL_ONE_BITS);
 
-			blocks[blockIndex(bitIndexTail)] |= highCutMask;
+			blocks[blockIndexTail] |= highCutMask;
 
 		}
 
@@ -238,62 +370,75 @@ namespace mylib {
 				return;
 			}
 
-#ifdef DEBUG_BitMap
-			std::cout << "from:" << bitIndexFrom << " length:" << length << std::endl;
-			std::cout << "blk_from:" << blockIndexFrom << " local_from:"
-				<< localIndexFrom << std::endl;
-#endif
 			blocks[blockIndexFrom] &= lowPassMask;
 
-#ifdef DEBUG_BitMap
-			std::cout << toString() << std::endl;
-#endif
-
-			std::fill_n(blocks + blockIndexFrom + 1,
-				blockIndexTail - blockIndexFrom - 1, ZERO_BITS);
+			std::fill(blocks + blockIndexFrom + 1, blocks + blockIndexTail, ZERO_BITS);
 
 			blocks[blockIndexTail] &= highPassMask;
 
 		}
 
+		// bit i moves to (i - amount) mod bitLength().
 		void rotateToLower(const u_int amount) {
-			u_int amount_ = amount % bitLength();
-
-			u_int rotatedBlockLength = blockIndex(amount_);
-			u_int rotatedBitLength = localBitIndex(amount_);
-
+			const u_int amount_ = amount % bitLength();
+			if (amount_ == 0) {
+				return;
+			}
 
 			if (blockLength() == 1) {
-				BitBlock exceeding = blocks[0] << (bitLength() - rotatedBitLength);
-				blocks[0] >>= rotatedBitLength;
-				blocks[0] |= exceeding;
+				blocks[0] = ((blocks[0] >> amount_) | (blocks[0] << (bitLength() - amount_))) & lastBlockMask();
 				return;
 			}
 
+			const u_int length = bitLength();
 
-			// shift blocks (= size * n bits)
-			if (rotatedBlockLength > 0) {
-				std::reverse(blocks, blocks + blockLength());
-				std::reverse(blocks + blockLength() - rotatedBlockLength, blocks + blockLength());
-				std::reverse(blocks, blocks + blockLength() - rotatedBlockLength);
+			// whole blocks first. the unused bits of the last block move to the middle, so close the gap.
+			const u_int blockShift = blockIndex(amount_);
+			if (blockShift != 0) {
+				std::rotate(blocks, blocks + blockShift, blocks + blockLength());
+
+				const u_int gap = blockLength() * OneBlockBitLength - length;
+				if (gap != 0) {
+					moveToLower(length - blockShift * OneBlockBitLength, gap, length);
+				}
 			}
 
-			// shift bits
-			BitBlock firstExceeding = blocks[0] << (OneBlockBitLength - rotatedBitLength);
-			for (u_int i = 0; i < blockLength() - 1; i++) {
-				BitBlock exceeding = blocks[i + 1] << (OneBlockBitLength - rotatedBitLength);
-				blocks[i] >>= rotatedBitLength;
-				blocks[i] |= exceeding;
+			// then the rest, carrying the lowest bits over to the top.
+			const u_int rest = localBitIndex(amount_);
+			if (rest != 0) {
+				const BitBlock carried = readBits(0, rest);
+				moveToLower(0, rest, length - rest);
+				writeBits(length - rest, rest, carried);
 			}
-			blocks[blockLength() - 1] >>= rotatedBitLength;
-			blocks[blockLength() - 1] |= firstExceeding;
+
+			blocks[blockLength() - 1] &= lastBlockMask();
 		}
 
 
+		// bit i moves to bitLength() - 1 - i.
+		void reverse() {
+			if (blockLength() == 0) {
+				return;
+			}
+
+			std::reverse(blocks, blocks + blockLength());
+			for (u_int i = 0; i < blockLength(); i++) {
+				blocks[i] = reverseBits(blocks[i]);
+			}
+
+			// the unused bits of the last block are now at the bottom.
+			const u_int gap = blockLength() * OneBlockBitLength - bitLength();
+			if (gap != 0) {
+				moveToLower(0, gap, bitLength());
+				blocks[blockLength() - 1] &= lastBlockMask();
+			}
+		}
+
 		void clear() {
-			std::fill(blocks, blocks + blockLength(), 0);
+			std::fill(blocks, blocks + blockLength(), ZERO_BITS);
 		}
 
+		// keeps the bits [0, bitIndexFrom] and clears the higher ones.
 		void cutHigherBits(u_int bitIndexFrom) {
 			u_int blockIndexFrom = blockIndex(bitIndexFrom);
 			u_int localIndexFrom = localBitIndex(bitIndexFrom);
@@ -301,9 +446,7 @@ namespace mylib {
 			const BitBlock highCutMask = ~((ALL_ONE_BITS << localIndexFrom) << 1);
 			blocks[blockIndexFrom] &= highCutMask;
 
-			for (u_int blockIndex = blockIndexFrom + 1; blockIndex < blockLength(); blockIndex++) {
-				blocks[blockIndex] = ZERO_BITS;
-			}
+			std::fill(blocks + blockIndexFrom + 1, blocks + blockLength(), ZERO_BITS);
 		}
 
 		//============================================================================
@@ -349,18 +492,22 @@ namespace mylib {
 			return stream.str();
 		}
 
+		// bytes sent by MPISend().
+		size_t MPIMessageSize() const {
+			return sizeof(bitLength_) + blockLength_ * sizeof(BitBlock);
+		}
+
 		void MPISend(int destID, int tag) const {
-			MPI_Send(&bitLength_, 1, MPI_UNSIGNED_LONG, destID, tag, MPI_COMM_WORLD);
-			MPI_Send(&blockLength_, 1, MPI_UNSIGNED_LONG, destID, tag, MPI_COMM_WORLD);
+			MPI_Send(&bitLength_, 1, MPI_UNSIGNED, destID, tag, MPI_COMM_WORLD);
 			MPI_Send(blocks, blockLength_ * sizeof(BitBlock), MPI_BYTE, destID, tag, MPI_COMM_WORLD);
 
 		}
 
 		void MPIReceive(int sourceID, int tag) {
 			MPI_Status status;
-			MPI_Recv(&bitLength_, 1, MPI_UNSIGNED_LONG, sourceID, tag, MPI_COMM_WORLD, &status);
-			MPI_Recv(&blockLength_, 1, MPI_UNSIGNED_LONG, sourceID, tag, MPI_COMM_WORLD, &status);
-			allocate(bitLength_);
+			u_int bitLength;
+			MPI_Recv(&bitLength, 1, MPI_UNSIGNED, sourceID, tag, MPI_COMM_WORLD, &status);
+			allocate(bitLength);
 			MPI_Recv(blocks, blockLength_ * sizeof(BitBlock), MPI_BYTE, sourceID, tag, MPI_COMM_WORLD, &status);
 		}
 
@@ -369,18 +516,18 @@ namespace mylib {
 
 
 		BitArray& operator=(const BitArray& right) {
-			substitute(right);
+			if (this != &right) {
+				substitute(right);
+			}
 			return *this;
 		}
 
-		BitArray operator&(const BitArray& right) const {
-			BitArray result(bitLength());
-
-			for (u_int i = 0; i < blockLength(); i++) {
-				result.blocks[i] = blocks[i] & right.blocks[i];
+		BitArray& operator=(BitArray&& right) noexcept {
+			if (this != &right) {
+				release();
+				steal(right);
 			}
-
-			return result;
+			return *this;
 		}
 
 		BitArray& operator&=(const BitArray& right) {
@@ -391,13 +538,40 @@ namespace mylib {
 			return *this;
 		}
 
-		BitArray operator^(const BitArray& right) const {
-			BitArray result(bitLength());
+		BitArray& operator|=(const BitArray& right) {
+			for (u_int i = 0; i < blockLength(); i++) {
+				blocks[i] |= right.blocks[i];
+			}
+
+			return *this;
+		}
 
+		BitArray& operator^=(const BitArray& right) {
 			for (u_int i = 0; i < blockLength(); i++) {
-				result.blocks[i] = blocks[i] ^ right.blocks[i];
+				blocks[i] ^= right.blocks[i];
 			}
 
+			return *this;
+		}
+
+		BitArray operator&(const BitArray& right) const {
+			BitArray result(*this);
+			result &= right;
+
+			return result;
+		}
+
+		BitArray operator|(const BitArray& right) const {
+			BitArray result(*this);
+			result |= right;
+
+			return result;
+		}
+
+		BitArray operator^(const BitArray& right) const {
+			BitArray result(*this);
+			result ^= right;
+
 			return result;
 		}
 
@@ -414,4 +588,4 @@ namespace mylib {
 	};
 
 
-}
\ No newline at end of file
+}
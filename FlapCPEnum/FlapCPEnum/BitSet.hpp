@@ -4,6 +4,7 @@
 #include "BitArray.hpp"
 #include <stdexcept>
 #include <sstream>
+#include <utility>
 
 namespace mylib {
 	/**
@@ -25,6 +26,10 @@ namespace mylib {
 			substitute(source);
 		}
 
+		BitSet(BitSet&& source) noexcept : bits(std::move(source.bits)), count_(source.count_) {
+			source.count_ = 0;
+		}
+
 		virtual~BitSet() {}
 
 		virtual bool contains(const u_int& item) const {
@@ -61,19 +66,82 @@ namespace mylib {
 			return count_;
 		}
 
+		virtual u_int findNext(const u_int& from) const {
+			return bits.findNext(from);
+		}
+
+		// calls func(item) for each item in increasing order.
+		template<typename TFunc>
+		void forEachItem(TFunc func) const {
+			bits.forEachSetBit(func);
+		}
+
+		// item i moves to (i - count) mod capacity().
 		void rotateToLower(const u_int& count) {
 			bits.rotateToLower(count);
 		}
 
+		// item i moves to capacity() - 1 - i.
+		void reverse() {
+			bits.reverse();
+		}
+
+		/**
+		 * forward iterator over items in increasing order.
+		 */
+		class const_iterator {
+			const BitSet *set;
+			u_int item;
+		public:
+			const_iterator(const BitSet *set, u_int item) : set(set), item(item) {}
+
+			u_int operator*() const {
+				return item;
+			}
+
+			const_iterator& operator++() {
+				item = set->findNext(item + 1);
+				return *this;
+			}
+
+			bool operator==(const const_iterator& right) const {
+				return item == right.item;
+			}
+
+			bool operator!=(const const_iterator& right) const {
+				return item != right.item;
+			}
+		};
+
+		const_iterator begin() const {
+			return const_iterator(this, findNext(0));
+		}
+
+		const_iterator end() const {
+			return const_iterator(this, capacity());
+		}
+
 		BitSet& operator=(const BitSet& right) {
 			substitute(right);
 			return *this;
 		}
 
-		BitSet operator&(const BitSet& right) const {
-			BitSet result(bits.bitLength());
+		BitSet& operator=(BitSet&& right) noexcept {
+			bits = std::move(right.bits);
+			count_ = right.count_;
+			right.count_ = 0;
+			return *this;
+		}
 
-			result.bits = bits & right.bits;
+		BitSet& operator&=(const BitSet& right) {
+			bits &= right.bits;
+			count_ = bits.countOnes();
+			return *this;
+		}
+
+		BitSet operator&(const BitSet& right) const {
+			BitSet result(*this);
+			result &= right;
 
 			return result;
 		}
@@ -83,9 +151,10 @@ namespace mylib {
 		}
 
 		BitSet exclusiveOr(const BitSet& right) const {
-			BitSet result(bits.bitLength());
+			BitSet result(*this);
 
-			result.bits = bits ^ right.bits;
+			result.bits ^= right.bits;
+			result.count_ = result.bits.countOnes();
 
 			return result;
 		}
@@ -94,6 +163,7 @@ namespace mylib {
 			BitSet result(*this);
 
 			result.bits.cutHigherBits(value);
+			result.count_ = result.bits.countOnes();
 
 			return result;
 		}
@@ -104,11 +174,9 @@ namespace mylib {
 
 		std::string toString() const {
 			std::stringstream ss;
-			for (u_int i = 0; i < capacity(); i++) {
-				if (contains(i)) {
-					ss << i << " ";
-				}
-			}
+			forEachItem([&ss](u_int i) {
+				ss << i << " ";
+			});
 
 			return ss.str();
 		}
@@ -122,14 +190,19 @@ namespace mylib {
 			return ss.str();
 		}
 
+		// bytes sent by MPISend().
+		size_t MPIMessageSize() const {
+			return sizeof(count_) + bits.MPIMessageSize();
+		}
+
 		void MPISend(int destID, int tag)  const {
-			MPI_Send(&count_, 1, MPI_UNSIGNED_LONG, destID, tag, MPI_COMM_WORLD);
+			MPI_Send(&count_, 1, MPI_UNSIGNED, destID, tag, MPI_COMM_WORLD);
 			bits.MPISend(destID, tag);
 		}
 
 		void MPIReceive(int sourceID, int tag) {
 			MPI_Status status;
-			MPI_Recv(&count_, 1, MPI_UNSIGNED_LONG, sourceID, tag, MPI_COMM_WORLD, &status);
+			MPI_Recv(&count_, 1, MPI_UNSIGNED, sourceID, tag, MPI_COMM_WORLD, &status);
 			bits.MPIReceive(sourceID, tag);
 		}
 	};
@@ -0,0 +1,327 @@
+﻿#pragma once
+
+#include <vector>
+#include <stdexcept>
+#include "abbreviation.h"
+#include "MVEnumeration.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		/**
+		 * Tests foldability of up to 64 assignments of the same flap at once.
+		 * The assignments are packed bit-sliced: lines[i] has the bit of lane l
+		 * if the l-th assignment contains line i.
+		 *
+		 * Crimps of the minimal angles are decided by angles only, so the reduction is scheduled
+		 * once per flap: a maximal run of the globally minimal angle is crimped at a time.
+		 * A run of k angles bounded by larger angles has k+1 creases, and it can be folded iff
+		 * #contained = #not contained (k+1: even) or they differ by one (k+1: odd).
+		 * In the latter case a crease of the majority type remains.
+		 * Each step is a bit-sliced count of the creases for all lanes.
+		 */
+		class BitSlicedFoldabilityTester {
+		public:
+			typedef unsigned long long LaneMask;
+			static const u_int LANE_COUNT = 8 * sizeof(LaneMask);
+
+		private:
+			// enough for counting 255 creases.
+			static const int PLANE_COUNT = 8;
+
+			struct Step {
+				std::vector<int> creases;
+				// the line remaining after the crimps, or -1.
+				int survivor;
+			};
+
+			enum Terminal {
+				TERMINAL_EMPTY, TERMINAL_PAIR, TERMINAL_ALL_EQUAL, TERMINAL_NEVER
+			};
+
+			std::vector<Step> steps;
+			Terminal terminal;
+			std::vector<int> terminalCreases;
+
+			u_int lineCount_;
+
+			// scratch. survivors are overwritten.
+			mutable std::vector<LaneMask> words;
+
+			void countLanes(const std::vector<int>& creases, LaneMask planes[PLANE_COUNT]) const {
+				std::fill(planes, planes + PLANE_COUNT, 0ULL);
+
+				for (const auto& crease : creases) {
+					LaneMask carry = words[crease];
+					for (int j = 0; j < PLANE_COUNT && carry != 0ULL; j++) {
+						const LaneMask next = planes[j] & carry;
+						planes[j] ^= carry;
+						carry = next;
+					}
+				}
+			}
+
+			static LaneMask lanesCounting(const LaneMask planes[PLANE_COUNT], const u_int& value) {
+				LaneMask lanes = ~0ULL;
+				for (int j = 0; j < PLANE_COUNT; j++) {
+					lanes &= ((value >> j) & 1) ? planes[j] : ~planes[j];
+				}
+				return lanes;
+			}
+
+			template<typename TAngles>
+			void buildSchedule(const TAngles& angleToNext) {
+				const int size = angleToNext.size();
+
+				std::vector<u_int> angles(angleToNext.begin(), angleToNext.end());
+				std::vector<int> nextIndex(size), prevIndex(size);
+				for (int i = 0; i < size; i++) {
+					nextIndex[i] = (i + 1) % size;
+					prevIndex[i] = (i + size - 1) % size;
+				}
+				int headIndex = 0;
+				int count = size;
+
+				auto remove = [&](const int& index) {
+					nextIndex[prevIndex[index]] = nextIndex[index];
+					prevIndex[nextIndex[index]] = prevIndex[index];
+					if (headIndex == index) {
+						headIndex = nextIndex[index];
+					}
+					count--;
+				};
+
+				while (count > 2) {
+					// the globally minimal angle
+					int minIndex = headIndex;
+					for (int i = 0, index = headIndex; i < count; i++, index = nextIndex[index]) {
+						if (angles[index] < angles[minIndex]) {
+							minIndex = index;
+						}
+					}
+					const u_int minAngle = angles[minIndex];
+
+					// extend to the maximal run
+					int begin = minIndex;
+					int runLength = 1;
+					while (runLength < count && angles[prevIndex[begin]] == minAngle) {
+						begin = prevIndex[begin];
+						runLength++;
+					}
+
+					if (runLength == count) {
+						if (count % 2 == 0) {
+							terminal = TERMINAL_ALL_EQUAL;
+							for (int i = 0, index = headIndex; i < count; i++, index = nextIndex[index]) {
+								terminalCreases.push_back(index);
+							}
+						}
+						else {
+							terminal = TERMINAL_NEVER;
+						}
+						return;
+					}
+
+					int end = minIndex;
+					while (angles[nextIndex[end]] == minAngle) {
+						end = nextIndex[end];
+						runLength++;
+					}
+
+					const int prev = prevIndex[begin];
+					const int next = nextIndex[end];
+
+					if (prev == next) {
+						// the last angle cannot be equal to the others.
+						terminal = TERMINAL_NEVER;
+						return;
+					}
+
+					Step step;
+					for (int index = begin; index != next; index = nextIndex[index]) {
+						step.creases.push_back(index);
+					}
+					step.creases.push_back(next);
+
+					for (int index = begin; index != next;) {
+						const int toBeRemoved = index;
+						index = nextIndex[index];
+						remove(toBeRemoved);
+					}
+
+					if (step.creases.size() % 2 == 0) {
+						angles[prev] += angles[next] - minAngle;
+						remove(next);
+						step.survivor = -1;
+					}
+					else {
+						step.survivor = next;
+					}
+
+					steps.push_back(step);
+				}
+
+				if (count == 0) {
+					terminal = TERMINAL_EMPTY;
+				}
+				else if (count == 2 && angles[headIndex] == angles[nextIndex[headIndex]]) {
+					terminal = TERMINAL_PAIR;
+					terminalCreases.push_back(headIndex);
+					terminalCreases.push_back(nextIndex[headIndex]);
+				}
+				else {
+					terminal = TERMINAL_NEVER;
+				}
+			}
+
+			void checkLineCount() const {
+				if (lineCount_ >= (1u << PLANE_COUNT)) {
+					throw std::invalid_argument("BitSlicedFoldabilityTester: too many lines.");
+				}
+			}
+
+			// angles[i]: gap between line i and line i + 1.
+			static std::vector<u_int> createAngles(const EncodablePatternBase& flap) {
+				const u_int lineCount = flap.count();
+				const u_int placeCount = flap.capacity();
+
+				LineIndexMapFactory mapFactory;
+				auto map = mapFactory.create(flap);
+
+				std::vector<u_int> angles(lineCount);
+				for (u_int i = 0; i < lineCount; i++) {
+					angles[i] = (placeCount + map[(i + 1) % lineCount] - map[i]) % placeCount;
+				}
+
+				return angles;
+			}
+
+		public:
+			BitSlicedFoldabilityTester(const EncodablePatternBase& flap) : lineCount_(flap.count()), words(flap.count()) {
+				checkLineCount();
+				buildSchedule(createAngles(flap));
+			}
+
+			BitSlicedFoldabilityTester(const FlapContext& context) : lineCount_(context.lineCount()), words(context.lineCount()) {
+				checkLineCount();
+				buildSchedule(context.angles());
+			}
+
+			/**
+			 * lines: bit-sliced assignments. the size should be lineCount().
+			 * return: lanes of flat-foldable assignments among activeLanes.
+			 */
+			LaneMask test(const LaneMask* lines, LaneMask activeLanes) const {
+				std::copy(lines, lines + lineCount_, words.begin());
+
+				LaneMask planes[PLANE_COUNT];
+
+				for (const auto& step : steps) {
+					countLanes(step.creases, planes);
+
+					const u_int half = step.creases.size() / 2;
+					if (step.survivor < 0) {
+						activeLanes &= lanesCounting(planes, half);
+					}
+					else {
+						const auto majority = lanesCounting(planes, half + 1);
+						activeLanes &= lanesCounting(planes, half) | majority;
+						words[step.survivor] = majority;
+					}
+
+					if (activeLanes == 0ULL) {
+						return 0ULL;
+					}
+				}
+
+				switch (terminal) {
+				case TERMINAL_EMPTY:
+					return activeLanes;
+				case TERMINAL_PAIR:
+					return activeLanes & ~(words[terminalCreases[0]] ^ words[terminalCreases[1]]);
+				case TERMINAL_ALL_EQUAL: {
+					// crimped until two creases of the same type remain.
+					countLanes(terminalCreases, planes);
+					const u_int half = terminalCreases.size() / 2;
+					return activeLanes & (lanesCounting(planes, half + 1) | lanesCounting(planes, half - 1));
+				}
+				default:
+					return 0ULL;
+				}
+			}
+
+			const u_int& lineCount() const {
+				return lineCount_;
+			}
+		};
+
+		/**
+		 * Buffers assignments of one flap, tests them by BitSlicedFoldabilityTester
+		 * and passes the foldable ones to os in the given order.
+		 * Call flush() after the last assignment of the flap.
+		 */
+		template<typename TOStream, typename TSet_Assignment>
+		class BatchFoldabilityStream {
+			typedef BitSlicedFoldabilityTester::LaneMask LaneMask;
+
+			const BitSlicedFoldabilityTester& tester;
+			TOStream& os;
+
+			std::vector<TSet_Assignment> buffer;
+			std::vector<LaneMask> lines;
+			u_int usedLaneCount;
+
+			unsigned long long foldableCount_;
+
+		public:
+			BatchFoldabilityStream(const BitSlicedFoldabilityTester& tester, TOStream& os) :
+				tester(tester), os(os),
+				buffer(BitSlicedFoldabilityTester::LANE_COUNT, TSet_Assignment(tester.lineCount())),
+				lines(tester.lineCount(), 0ULL), usedLaneCount(0), foldableCount_(0ULL) {
+			}
+
+			BatchFoldabilityStream& operator<<(const TSet_Assignment& assignments) {
+				const LaneMask lane = 1ULL << usedLaneCount;
+
+				buffer[usedLaneCount] = assignments;
+				for (u_int i = 0; i < lines.size(); i++) {
+					if (assignments.contains(i)) {
+						lines[i] |= lane;
+					}
+				}
+
+				usedLaneCount++;
+				if (usedLaneCount == BitSlicedFoldabilityTester::LANE_COUNT) {
+					flush();
+				}
+
+				return *this;
+			}
+
+			void flush() {
+				if (usedLaneCount == 0) {
+					return;
+				}
+
+				const LaneMask activeLanes = (usedLaneCount == BitSlicedFoldabilityTester::LANE_COUNT) ?
+					~0ULL : (1ULL << usedLaneCount) - 1;
+
+				const LaneMask foldables = tester.test(lines.data(), activeLanes);
+
+				for (u_int lane = 0; lane < usedLaneCount; lane++) {
+					if (foldables & (1ULL << lane)) {
+						os << buffer[lane];
+						foldableCount_++;
+					}
+				}
+
+				std::fill(lines.begin(), lines.end(), 0ULL);
+				usedLaneCount = 0;
+			}
+
+			const unsigned long long& foldableCount() const {
+				return foldableCount_;
+			}
+		};
+	}
+}
@@ -0,0 +1,407 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "abbreviation.h"
+#include "MappedFile.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		/**
+		* Archive of sorted CP strings.
+		*
+		* File layout (integers are little endian):
+		*   "FCPA", version (u32), block size (u32),
+		*   blocks,
+		*   index: (offset (u64), #pattern (u64), bytes (u64), first key (FIRST_KEY_SIZE bytes)) for each block,
+		*   footer: offset of the index (u64), #block (u64), #pattern (u64), "FCPA".
+		*
+		* A block holds up to block size patterns with front coding:
+		* each pattern is (length of the prefix shared with the previous pattern (varint), length of the rest (varint), the rest).
+		* The first pattern of a block shares nothing, so that every block can be decoded alone (e.g. in parallel).
+		*
+		* The first key of a block is the prefix of its first pattern, padded with NUL (CP strings have no NUL).
+		* The keys are sorted, so that a reader can binary-search the index for the blocks of a pattern.
+		*/
+		struct CPArchiveFormat {
+			static const uint32_t VERSION = 2;
+			static const size_t HEADER_SIZE = 12;
+			static const size_t FIRST_KEY_SIZE = 24;
+			static const size_t INDEX_ENTRY_SIZE = 24 + FIRST_KEY_SIZE;
+			static const size_t FOOTER_SIZE = 28;
+
+			static const char* magic() {
+				return "FCPA";
+			}
+
+			static void writeVarint(std::string& out, uint64_t value) {
+				while (value >= 0x80) {
+					out += (char)((value & 0x7F) | 0x80);
+					value >>= 7;
+				}
+				out += (char)value;
+			}
+
+			// reads a varint at p and moves p. throws if it passes end.
+			static uint64_t readVarint(const unsigned char*& p, const unsigned char* end) {
+				uint64_t value = 0;
+				for (int shift = 0; shift < 64; shift += 7) {
+					if (p == end) {
+						break;
+					}
+					const unsigned char byte = *p++;
+					value |= (uint64_t)(byte & 0x7F) << shift;
+					if ((byte & 0x80) == 0) {
+						return value;
+					}
+				}
+				throw std::invalid_argument("CPArchive: broken varint.");
+			}
+
+			static void writeUInt(std::ostream& os, const uint64_t value, const int byteCount) {
+				unsigned char bytes[8];
+				for (int i = 0; i < byteCount; i++) {
+					bytes[i] = (value >> (8 * i)) & 0xFF;
+				}
+				os.write((const char*)bytes, byteCount);
+			}
+
+			static uint64_t readUInt(const unsigned char* bytes, const int byteCount) {
+				uint64_t value = 0;
+				for (int i = 0; i < byteCount; i++) {
+					value |= (uint64_t)bytes[i] << (8 * i);
+				}
+				return value;
+			}
+		};
+
+		// patterns should be added in ascending (std::string) order.
+		// throws std::runtime_error if the stream fails.
+		class CPArchiveWriter {
+			struct Block {
+				uint64_t offset;
+				uint64_t count;
+				uint64_t size;
+				std::string firstKey;
+			};
+
+			std::ostream& os;
+			const u_int blockSize;
+
+			std::string block;
+			uint64_t blockPatternCount;
+			std::string blockFirstKey;
+			std::string previous;
+
+			uint64_t offset;
+			uint64_t patternCount_;
+			std::vector<Block> blocks;
+			bool closed;
+
+			void checkStream() const {
+				if (!os) {
+					throw std::runtime_error("CPArchiveWriter: failed to write the stream.");
+				}
+			}
+
+			void flushBlock() {
+				if (blockPatternCount == 0) {
+					return;
+				}
+				blocks.push_back(Block{ offset, blockPatternCount, block.size(), blockFirstKey });
+				os.write(block.data(), block.size());
+				checkStream();
+				offset += block.size();
+
+				block.clear();
+				blockPatternCount = 0;
+			}
+
+		public:
+			static const u_int DEFAULT_BLOCK_SIZE = 4096;
+
+			CPArchiveWriter(std::ostream& os, const u_int blockSize = DEFAULT_BLOCK_SIZE) :
+				os(os), blockSize(blockSize), blockPatternCount(0), offset(CPArchiveFormat::HEADER_SIZE), patternCount_(0), closed(false) {
+				if (blockSize == 0) {
+					throw std::invalid_argument("CPArchiveWriter: block size should be positive.");
+				}
+				os.write(CPArchiveFormat::magic(), 4);
+				CPArchiveFormat::writeUInt(os, CPArchiveFormat::VERSION, 4);
+				CPArchiveFormat::writeUInt(os, blockSize, 4);
+				checkStream();
+			}
+
+			CPArchiveWriter(const CPArchiveWriter&) = delete;
+			CPArchiveWriter& operator=(const CPArchiveWriter&) = delete;
+
+			~CPArchiveWriter() {
+				try {
+					close();
+				}
+				catch (...) {
+				}
+			}
+
+			CPArchiveWriter& operator<<(const std::string& cpString) {
+				if (patternCount_ > 0 && cpString < previous) {
+					throw std::invalid_argument("CPArchiveWriter: patterns are not sorted.");
+				}
+				if (blockPatternCount == blockSize) {
+					flushBlock();
+				}
+
+				size_t prefix = 0;
+				if (blockPatternCount == 0) {
+					blockFirstKey.assign(cpString, 0, CPArchiveFormat::FIRST_KEY_SIZE);
+				}
+				else {
+					const size_t maxPrefix = std::min(previous.size(), cpString.size());
+					while (prefix < maxPrefix && previous[prefix] == cpString[prefix]) {
+						prefix++;
+					}
+				}
+				CPArchiveFormat::writeVarint(block, prefix);
+				CPArchiveFormat::writeVarint(block, cpString.size() - prefix);
+				block.append(cpString, prefix, std::string::npos);
+
+				previous = cpString;
+				blockPatternCount++;
+				patternCount_++;
+				return *this;
+			}
+
+			// writes the last block, the index and the footer.
+			void close() {
+				if (closed) {
+					return;
+				}
+				closed = true;
+
+				flushBlock();
+				const uint64_t indexOffset = offset;
+				for (const auto& entry : blocks) {
+					CPArchiveFormat::writeUInt(os, entry.offset, 8);
+					CPArchiveFormat::writeUInt(os, entry.count, 8);
+					CPArchiveFormat::writeUInt(os, entry.size, 8);
+					std::string key(entry.firstKey);
+					key.resize(CPArchiveFormat::FIRST_KEY_SIZE, '\0');
+					os.write(key.data(), key.size());
+				}
+				CPArchiveFormat::writeUInt(os, indexOffset, 8);
+				CPArchiveFormat::writeUInt(os, blocks.size(), 8);
+				CPArchiveFormat::writeUInt(os, patternCount_, 8);
+				os.write(CPArchiveFormat::magic(), 4);
+				os.flush();
+				checkStream();
+			}
+
+			const uint64_t& patternCount() const {
+				return patternCount_;
+			}
+
+			size_t blockCount() const {
+				return blocks.size() + (blockPatternCount > 0 ? 1 : 0);
+			}
+		};
+
+		/**
+		* writes an archive to path.tmp and renames it to path on commit(),
+		* so that a failed write does not leave a truncated archive at path.
+		* the temporary file is removed if the writer is destroyed without commit().
+		*/
+		class CPArchiveFileWriter {
+			const std::string path;
+			const std::string temporaryPath;
+			std::ofstream fout;
+			std::unique_ptr<CPArchiveWriter> writer;
+			bool committed;
+
+		public:
+			explicit CPArchiveFileWriter(const std::string& path, const u_int blockSize = CPArchiveWriter::DEFAULT_BLOCK_SIZE) :
+				path(path), temporaryPath(path + ".tmp"), fout(temporaryPath, std::ios::binary), committed(false) {
+				if (!fout) {
+					throw std::runtime_error("CPArchiveFileWriter: cannot open " + temporaryPath);
+				}
+				try {
+					writer.reset(new CPArchiveWriter(fout, blockSize));
+				}
+				catch (...) {
+					fout.close();
+					std::remove(temporaryPath.c_str());
+					throw;
+				}
+			}
+
+			CPArchiveFileWriter(const CPArchiveFileWriter&) = delete;
+			CPArchiveFileWriter& operator=(const CPArchiveFileWriter&) = delete;
+
+			~CPArchiveFileWriter() {
+				if (!committed) {
+					writer.reset();
+					fout.close();
+					std::remove(temporaryPath.c_str());
+				}
+			}
+
+			CPArchiveWriter& archive() {
+				return *writer;
+			}
+
+			// closes the archive and replaces path with it.
+			void commit() {
+				writer->close();
+				fout.close();
+				if (!fout) {
+					throw std::runtime_error("CPArchiveFileWriter: failed to write " + temporaryPath);
+				}
+				if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+					// rename() of some platforms does not replace an existing file.
+					std::remove(path.c_str());
+					if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+						throw std::runtime_error("CPArchiveFileWriter: cannot rename " + temporaryPath + " to " + path);
+					}
+				}
+				committed = true;
+			}
+		};
+
+		// memory maps an archive. blocks are independent and const, so that threads can read different blocks at once.
+		class CPArchiveReader {
+			mylib::MappedFile file;
+			const unsigned char* index;
+			uint64_t blockCount_;
+			uint64_t patternCount_;
+
+			void broken() const {
+				throw std::invalid_argument("CPArchiveReader: broken archive.");
+			}
+
+			// the first block whose first key is not less than key (or greater than key if inclusive).
+			uint64_t searchBlock(const std::string& key, const bool inclusive) const {
+				uint64_t begin = 0;
+				uint64_t end = blockCount_;
+				while (begin < end) {
+					const uint64_t middle = begin + (end - begin) / 2;
+					const std::string middleKey = blockFirstKey(middle);
+					if (middleKey < key || (inclusive && middleKey == key)) {
+						begin = middle + 1;
+					}
+					else {
+						end = middle;
+					}
+				}
+				return begin;
+			}
+
+		public:
+			explicit CPArchiveReader(const std::string& path) : file(path) {
+				const unsigned char* data = file.data();
+				const size_t size = file.size();
+				if (size < CPArchiveFormat::HEADER_SIZE + CPArchiveFormat::FOOTER_SIZE ||
+					std::memcmp(data, CPArchiveFormat::magic(), 4) != 0 ||
+					CPArchiveFormat::readUInt(data + 4, 4) != CPArchiveFormat::VERSION) {
+					broken();
+				}
+
+				const unsigned char* footer = data + size - CPArchiveFormat::FOOTER_SIZE;
+				if (std::memcmp(footer + 24, CPArchiveFormat::magic(), 4) != 0) {
+					broken();
+				}
+				const uint64_t indexOffset = CPArchiveFormat::readUInt(footer, 8);
+				blockCount_ = CPArchiveFormat::readUInt(footer + 8, 8);
+				patternCount_ = CPArchiveFormat::readUInt(footer + 16, 8);
+
+				if (indexOffset < CPArchiveFormat::HEADER_SIZE || indexOffset > size - CPArchiveFormat::FOOTER_SIZE ||
+					blockCount_ != (size - CPArchiveFormat::FOOTER_SIZE - indexOffset) / CPArchiveFormat::INDEX_ENTRY_SIZE) {
+					broken();
+				}
+				index = data + indexOffset;
+			}
+
+			const uint64_t& blockCount() const {
+				return blockCount_;
+			}
+
+			const uint64_t& patternCount() const {
+				return patternCount_;
+			}
+
+			uint64_t blockPatternCount(const uint64_t i) const {
+				return CPArchiveFormat::readUInt(index + i * CPArchiveFormat::INDEX_ENTRY_SIZE + 8, 8);
+			}
+
+			// the first FIRST_KEY_SIZE characters of the first pattern of the i-th block.
+			std::string blockFirstKey(const uint64_t i) const {
+				const char* key = (const char*)index + i * CPArchiveFormat::INDEX_ENTRY_SIZE + 24;
+				return std::string(key, std::find(key, key + CPArchiveFormat::FIRST_KEY_SIZE, '\0'));
+			}
+
+			// [first, last) of the blocks which may hold cpString, found by binary search on the index.
+			// the range has more than one block only if the first keys of the blocks are the same.
+			std::pair<uint64_t, uint64_t> findBlocks(const std::string& cpString) const {
+				const std::string key = cpString.substr(0, CPArchiveFormat::FIRST_KEY_SIZE);
+				// the block before the first equal key begins with a smaller pattern and may hold cpString.
+				const uint64_t first = searchBlock(key, false);
+				return std::make_pair(first == 0 ? 0 : first - 1, searchBlock(key, true));
+			}
+
+			bool contains(const std::string& cpString) const {
+				const auto blocks = findBlocks(cpString);
+				bool found = false;
+				for (uint64_t i = blocks.first; i < blocks.second && !found; i++) {
+					forEachInBlock(i, [&found, &cpString](const std::string& pattern) {
+						found |= pattern == cpString;
+					});
+				}
+				return found;
+			}
+
+			// calls f(const std::string&) for each pattern of the i-th block in order.
+			template <typename F>
+			void forEachInBlock(const uint64_t i, const F& f) const {
+				if (i >= blockCount_) {
+					throw std::invalid_argument("CPArchiveReader: no such block.");
+				}
+				const unsigned char* entry = index + i * CPArchiveFormat::INDEX_ENTRY_SIZE;
+				const uint64_t offset = CPArchiveFormat::readUInt(entry, 8);
+				const uint64_t count = CPArchiveFormat::readUInt(entry + 8, 8);
+				const uint64_t size = CPArchiveFormat::readUInt(entry + 16, 8);
+				if (offset + size > (uint64_t)(index - file.data())) {
+					broken();
+				}
+
+				const unsigned char* p = file.data() + offset;
+				const unsigned char* end = p + size;
+				std::string cpString;
+				for (uint64_t k = 0; k < count; k++) {
+					const uint64_t prefix = CPArchiveFormat::readVarint(p, end);
+					const uint64_t rest = CPArchiveFormat::readVarint(p, end);
+					if (prefix > cpString.size() || rest > (uint64_t)(end - p)) {
+						broken();
+					}
+					cpString.resize(prefix);
+					cpString.append((const char*)p, rest);
+					p += rest;
+					f(cpString);
+				}
+			}
+
+			template <typename F>
+			void forEach(const F& f) const {
+				for (uint64_t i = 0; i < blockCount_; i++) {
+					forEachInBlock(i, f);
+				}
+			}
+		};
+	}
+}
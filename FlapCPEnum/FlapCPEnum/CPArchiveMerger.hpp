@@ -0,0 +1,238 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "abbreviation.h"
+#include "BinaryCPFormat.hpp"
+#include "IndexedCPFormat.hpp"
+#include "CPArchive.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		/**
+		* merges pattern files of ranks (.txt, .cpb or .cpi) into one CPArchive sorted by std::string order.
+		*
+		* external merge sort with bounded memory:
+		* the inputs are cut into sorted runs of about memoryBytes, written to temporary files,
+		* and then the runs are k-way merged, at most fanIn files at once.
+		*/
+		class CPArchiveMerger {
+			const std::string temporaryPrefix;
+			const size_t memoryBytes;
+			const u_int fanIn;
+
+			u_int runSerial;
+			unsigned long long inputPatternCount_;
+
+			// one pattern per line in order.
+			class RunReader {
+				std::ifstream fin;
+				std::string current_;
+			public:
+				RunReader(const std::string& path) : fin(path) {
+					if (!fin) {
+						throw std::invalid_argument("CPArchiveMerger: cannot open " + path);
+					}
+				}
+
+				bool next() {
+					return (bool)std::getline(fin, current_);
+				}
+
+				const std::string& current() const {
+					return current_;
+				}
+			};
+
+			std::string createRunPath() {
+				return temporaryPrefix + ".run" + std::to_string(runSerial++);
+			}
+
+			// the path is added to runs before writing, so a failed run is removed with the others.
+			void writeRun(std::vector<std::string>& patterns, std::vector<std::string>& runs) {
+				std::sort(patterns.begin(), patterns.end());
+
+				runs.push_back(createRunPath());
+				const std::string& path = runs.back();
+				std::ofstream fout(path);
+				for (const auto& pattern : patterns) {
+					fout << pattern << '\n';
+				}
+				fout.close();
+				if (!fout) {
+					throw std::runtime_error("CPArchiveMerger: cannot write " + path);
+				}
+			}
+
+			// output(const std::string&) for each pattern of the runs in order.
+			template <typename Output>
+			static void mergeRuns(const std::vector<std::string>& runs, const Output& output) {
+				std::vector<std::unique_ptr<RunReader> > readers;
+				typedef std::pair<std::string, size_t> Head;
+				std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+
+				for (const auto& run : runs) {
+					readers.emplace_back(new RunReader(run));
+					if (readers.back()->next()) {
+						heads.push(Head(readers.back()->current(), readers.size() - 1));
+					}
+				}
+
+				while (!heads.empty()) {
+					const size_t i = heads.top().second;
+					output(heads.top().first);
+					heads.pop();
+
+					if (readers[i]->next()) {
+						heads.push(Head(readers[i]->current(), i));
+					}
+				}
+			}
+
+			static void removeFiles(const std::vector<std::string>& paths) {
+				for (const auto& path : paths) {
+					std::remove(path.c_str());
+				}
+			}
+
+		public:
+			static const size_t DEFAULT_MEMORY_BYTES = (size_t)256 << 20;
+			static const u_int DEFAULT_FAN_IN = 64;
+
+			// temporary files are temporaryPrefix.run<N>.
+			CPArchiveMerger(const std::string& temporaryPrefix, const size_t memoryBytes = DEFAULT_MEMORY_BYTES, const u_int fanIn = DEFAULT_FAN_IN) :
+				temporaryPrefix(temporaryPrefix), memoryBytes(memoryBytes), fanIn(fanIn), runSerial(0), inputPatternCount_(0ULL) {
+				if (fanIn < 2) {
+					throw std::invalid_argument("CPArchiveMerger: fan-in should be 2 or more.");
+				}
+			}
+
+			// calls f(const std::string&) for each CP string of a file written by the enumeration.
+			template <typename F>
+			static void forEachPattern(const std::string& path, const F& f) {
+				std::ifstream fin(path, std::ios::binary);
+				if (!fin) {
+					throw std::invalid_argument("CPArchiveMerger: cannot open " + path);
+				}
+				char magic[4] = { 0, 0, 0, 0 };
+				fin.read(magic, 4);
+				const bool isBinary = fin && std::memcmp(magic, "FCPB", 4) == 0;
+				const bool isIndexed = fin && std::memcmp(magic, IndexedCPFormat::magic(), 4) == 0;
+				fin.clear();
+				fin.seekg(0);
+
+				std::string cpString;
+				if (isBinary) {
+					BinaryCPReader reader(fin);
+					while (reader.next(cpString)) {
+						f(cpString);
+					}
+				}
+				else if (isIndexed) {
+					fin.close();
+					IndexedCPFile file(path);
+					for (uint64_t i = 0; i < file.flapCount(); i++) {
+						auto records = file.find(file.key(i));
+						for (uint64_t k = 0; k < records.count(); k++) {
+							f(records.cpString(k));
+						}
+					}
+				}
+				else {
+					while (std::getline(fin, cpString)) {
+						if (!cpString.empty() && cpString.back() == '\r') {
+							cpString.pop_back();
+						}
+						if (!cpString.empty()) {
+							f(cpString);
+						}
+					}
+				}
+			}
+
+			void merge(const std::vector<std::string>& inputs, CPArchiveWriter& archive) {
+				std::vector<std::string> runs;
+				// outputs of the current pass.
+				std::vector<std::string> merged;
+
+				try {
+					// sorted runs
+					std::vector<std::string> patterns;
+					size_t usedBytes = 0;
+					for (const auto& input : inputs) {
+						forEachPattern(input, [&](const std::string& cpString) {
+							patterns.push_back(cpString);
+							usedBytes += sizeof(std::string) + cpString.capacity();
+							inputPatternCount_++;
+
+							if (usedBytes >= memoryBytes) {
+								writeRun(patterns, runs);
+								patterns.clear();
+								patterns.shrink_to_fit();
+								usedBytes = 0;
+							}
+						});
+					}
+					if (!patterns.empty()) {
+						writeRun(patterns, runs);
+					}
+					patterns.clear();
+					patterns.shrink_to_fit();
+
+					// passes until the runs can be opened at once.
+					while (runs.size() > fanIn) {
+						for (size_t begin = 0; begin < runs.size(); begin += fanIn) {
+							const std::vector<std::string> group(runs.begin() + begin, runs.begin() + std::min<size_t>(begin + fanIn, runs.size()));
+
+							merged.push_back(createRunPath());
+							const std::string& path = merged.back();
+							{
+								std::ofstream fout(path);
+								mergeRuns(group, [&fout](const std::string& cpString) {
+									fout << cpString << '\n';
+								});
+								fout.close();
+								if (!fout) {
+									throw std::runtime_error("CPArchiveMerger: cannot write " + path);
+								}
+							}
+							removeFiles(group);
+						}
+						runs.swap(merged);
+						merged.clear();
+					}
+
+					mergeRuns(runs, [&archive](const std::string& cpString) {
+						archive << cpString;
+					});
+				}
+				catch (...) {
+					removeFiles(runs);
+					removeFiles(merged);
+					throw;
+				}
+				removeFiles(runs);
+				archive.close();
+			}
+
+			const unsigned long long& inputPatternCount() const {
+				return inputPatternCount_;
+			}
+
+			// #temporary file made so far.
+			const u_int& runCount() const {
+				return runSerial;
+			}
+		};
+	}
+}
@@ -0,0 +1,123 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "abbreviation.h"
+#include "FlapPattern.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		// a CP string written by CPStringWriter. the characters are not owned.
+		struct CPStringView {
+			const char* data;
+			u_int size;
+
+			CPStringView(const char* data, const u_int size) : data(data), size(size) {}
+
+			operator std::string() const {
+				return std::string(data, size);
+			}
+		};
+
+		inline std::ostream& operator<<(std::ostream& os, const CPStringView& cp) {
+			return os.write(cp.data, cp.size);
+		}
+
+		/**
+		* writes the same strings as EncodablePatternBase::encode(minors) into a reusable buffer.
+		*
+		* the run-length text of a flap is built once and cached;
+		* each assignment only rewrites the characters of the lines.
+		* the cache is kept until invalidate(), which should be called before another flap is given.
+		*/
+		class CPStringWriter {
+			std::string text;
+			// offset in text of each line by shrinked index.
+			std::vector<u_int> lineOffsets;
+			bool cached = false;
+
+			// writes n in decimal at out and returns the number of digits.
+			static u_int writeDecimal(u_int n, char* out) {
+				static const char DIGIT_PAIRS[] =
+					"00010203040506070809"
+					"10111213141516171819"
+					"20212223242526272829"
+					"30313233343536373839"
+					"40414243444546474849"
+					"50515253545556575859"
+					"60616263646566676869"
+					"70717273747576777879"
+					"80818283848586878889"
+					"90919293949596979899";
+
+				char reversed[16];
+				u_int length = 0;
+				while (n >= 100) {
+					const u_int pair = 2 * (n % 100);
+					n /= 100;
+					reversed[length++] = DIGIT_PAIRS[pair + 1];
+					reversed[length++] = DIGIT_PAIRS[pair];
+				}
+				if (n >= 10) {
+					reversed[length++] = DIGIT_PAIRS[2 * n + 1];
+					reversed[length++] = DIGIT_PAIRS[2 * n];
+				}
+				else {
+					reversed[length++] = (char)('0' + n);
+				}
+
+				for (u_int i = 0; i < length; i++) {
+					out[i] = reversed[length - 1 - i];
+				}
+				return length;
+			}
+
+			void cache(const EncodablePatternBase& flap) {
+				if (cached) {
+					return;
+				}
+				cached = true;
+
+				text.clear();
+				lineOffsets.clear();
+				char digits[16];
+				flap.scanCP(
+					[this, &digits](const u_int emptyCount) {
+						text.append(digits, writeDecimal(emptyCount, digits));
+					},
+					[this](const u_int, const u_int) {
+						lineOffsets.push_back((u_int)text.size());
+						text += '+';
+					});
+			}
+
+			CPStringView view() const {
+				return CPStringView(text.data(), (u_int)text.size());
+			}
+
+		public:
+			void invalidate() {
+				cached = false;
+			}
+
+			template <typename TBitSet>
+			CPStringView write(const EncodablePatternBase& flap, const TBitSet& minors) {
+				cache(flap);
+				for (u_int k = 0; k < lineOffsets.size(); k++) {
+					text[lineOffsets[k]] = minors.contains(k) ? '-' : '+';
+				}
+				return view();
+			}
+
+			CPStringView write(const EncodablePatternBase& flap) {
+				cache(flap);
+				for (auto offset : lineOffsets) {
+					text[offset] = '+';
+				}
+				return view();
+			}
+		};
+	}
+}
@@ -38,6 +38,10 @@ namespace enumeration {
 				return bits.capacity();
 			}
 
+			virtual u_int findNext(const u_int& from) const {
+				return bits.findNext(from);
+			}
+
 			mylib::BitSet createBitRotationToLower(const u_int& amount) const {
 				auto rotated = bits;
 				rotated.rotateToLower(amount);
@@ -0,0 +1,210 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <sstream>
+#include "abbreviation.h"
+
+namespace enumeration {
+	namespace origami {
+
+		/**
+		 * Struct-of-arrays ring of line gaps (angle to the next line and line type)
+		 * for at most MAX_SIZE lines. This is a compact counterpart of RingArrayList<LineGap>.
+		 *
+		 * Angles (uint16_t), next/prev links (uint8_t) and line types are kept in separate arrays
+		 * of MAX_SIZE entries, so the user should choose MAX_SIZE to the largest flap it handles:
+		 * a ring of 32 lines is 180 bytes in all.
+		 * Copying a ring copies only the first size() entries of each array.
+		 */
+		template<u_int MAX_SIZE>
+		class CompactLineGapRing {
+			static_assert(MAX_SIZE <= 255, "links are uint8_t.");
+
+			typedef unsigned long long MaskBlock;
+			static const u_int MASK_BLOCK_BIT_LENGTH = 8 * sizeof(MaskBlock);
+			static const u_int MASK_BLOCK_COUNT = (MAX_SIZE + MASK_BLOCK_BIT_LENGTH - 1) / MASK_BLOCK_BIT_LENGTH;
+
+			u_int size_ = 0;
+			u_int count_ = 0;
+			int headIndex = -1;
+
+			// 1 for an empty slot.
+			MaskBlock emptyMask[MASK_BLOCK_COUNT];
+
+			uint16_t angles[MAX_SIZE];
+			uint8_t nexts[MAX_SIZE];
+			uint8_t prevs[MAX_SIZE];
+			char lineTypes[MAX_SIZE];
+
+			void connect(const int prevIndex, const int nextIndex) {
+				nexts[prevIndex] = (uint8_t)nextIndex;
+				prevs[nextIndex] = (uint8_t)prevIndex;
+			}
+
+			void setEmpty(const int index) {
+				emptyMask[index / MASK_BLOCK_BIT_LENGTH] |= 1ULL << (index % MASK_BLOCK_BIT_LENGTH);
+			}
+
+			void setFilled(const int index) {
+				emptyMask[index / MASK_BLOCK_BIT_LENGTH] &= ~(1ULL << (index % MASK_BLOCK_BIT_LENGTH));
+			}
+
+			u_int maskBlockLength() const {
+				return (size_ + MASK_BLOCK_BIT_LENGTH - 1) / MASK_BLOCK_BIT_LENGTH;
+			}
+
+			void substitute(const CompactLineGapRing& source) {
+				size_ = source.size_;
+				count_ = source.count_;
+				headIndex = source.headIndex;
+
+				std::memcpy(emptyMask, source.emptyMask, maskBlockLength() * sizeof(MaskBlock));
+				std::memcpy(angles, source.angles, size_ * sizeof(uint16_t));
+				std::memcpy(nexts, source.nexts, size_);
+				std::memcpy(prevs, source.prevs, size_);
+				std::memcpy(lineTypes, source.lineTypes, size_);
+			}
+
+		public:
+			CompactLineGapRing() {
+			}
+
+			CompactLineGapRing(const u_int size) {
+				resize(size);
+			}
+
+			CompactLineGapRing(const CompactLineGapRing& source) {
+				substitute(source);
+			}
+
+			static bool canHold(const u_int size) {
+				return size <= MAX_SIZE;
+			}
+
+			// existing values will be deleted.
+			void resize(const u_int size) {
+				if (!canHold(size)) {
+					std::ostringstream ss;
+					ss << "CompactLineGapRing: size " << size << " exceeds " << MAX_SIZE << ".";
+					throw std::length_error(ss.str());
+				}
+				size_ = size;
+				clear();
+			}
+
+			void clear() {
+				std::memset(emptyMask, 0xff, sizeof(emptyMask));
+				count_ = 0;
+				headIndex = -1;
+			}
+
+			void set(const int index, const u_int angleToNext, const char lineType) {
+				angles[index] = (uint16_t)angleToNext;
+				lineTypes[index] = lineType;
+				setFilled(index);
+			}
+
+			bool exists(const int index) const {
+				return 0 <= index && (u_int)index < size_
+					&& (emptyMask[index / MASK_BLOCK_BIT_LENGTH] & (1ULL << (index % MASK_BLOCK_BIT_LENGTH))) == 0;
+			}
+
+			void makeLinks() {
+				int lastIndex = -1;
+
+				count_ = 0;
+				for (u_int i = 0; i < size_; i++) {
+					if (exists(i)) {
+						if (lastIndex == -1) {
+							headIndex = i;
+						}
+						else {
+							connect(lastIndex, i);
+						}
+						lastIndex = i;
+
+						count_++;
+					}
+				}
+				if (lastIndex != -1) {
+					connect(lastIndex, headIndex);
+				}
+			}
+
+			void remove(const int index) {
+				if (count_ == 0) {
+					throw std::out_of_range("no item");
+				}
+
+				if (count_ == 1) {
+					headIndex = -1;
+				}
+				else {
+					if (headIndex == index) {
+						headIndex = nextIndexOf(index);
+					}
+					connect(prevIndexOf(index), nextIndexOf(index));
+				}
+				setEmpty(index);
+				count_--;
+			}
+
+			int nextIndexOf(const int index) const {
+				return nexts[index];
+			}
+
+			int prevIndexOf(const int index) const {
+				return prevs[index];
+			}
+
+			uint16_t& angleToNext(const int index) {
+				return angles[index];
+			}
+			const uint16_t& angleToNext(const int index) const {
+				return angles[index];
+			}
+
+			char& lineType(const int index) {
+				return lineTypes[index];
+			}
+			const char& lineType(const int index) const {
+				return lineTypes[index];
+			}
+
+			int peekHeadIndex() const {
+				return headIndex;
+			}
+
+			int peekTailIndex() const {
+				return prevIndexOf(headIndex);
+			}
+
+			const u_int& count() const {
+				return count_;
+			}
+
+			const u_int& size() const {
+				return size_;
+			}
+
+			CompactLineGapRing& operator=(const CompactLineGapRing& right) {
+				if (this != &right) {
+					substitute(right);
+				}
+				return *this;
+			}
+
+			std::string toString() const {
+				std::stringstream ss;
+
+				auto index = headIndex;
+				for (u_int i = 0; i < count(); i++) {
+					ss << "[" << index << "] " << lineType(index) << angleToNext(index) << ", ";
+					index = nextIndexOf(index);
+				}
+				return ss.str();
+			}
+		};
+	}
+}
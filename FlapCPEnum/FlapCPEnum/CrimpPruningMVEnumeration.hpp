@@ -0,0 +1,319 @@
+﻿#pragma once
+
+#include <vector>
+#include "abbreviation.h"
+#include "MVEnumeration.hpp"
+#include "searchtool.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		/**
+		 * A ring of angles reduced by crimps while creases are fixed one by one.
+		 *
+		 * angleToNext[i] is the angle between line i and the next line in the ring.
+		 * A crimp is applied as soon as a minimal angle has two fixed creases of different type,
+		 * which keeps foldability of any completion of the assignment.
+		 * The ring is unfoldable if a strictly minimal angle has two fixed creases of the same type.
+		 *
+		 * All arrays are allocated at construction; copy between rings of the same size never allocates.
+		 */
+		class PartiallyCrimpedRing {
+		public:
+			static const char UNDEF = 0;
+			static const char MAJOR = 1;
+			static const char MINOR = 2;
+
+		private:
+			std::vector<u_int> angleToNext;
+			std::vector<char> lineType;
+			std::vector<int> nextIndex;
+			std::vector<int> prevIndex;
+			std::vector<bool> alive;
+			int headIndex;
+			u_int count_;
+
+			// indices whose minimality has to be tested.
+			std::vector<int> dirty;
+
+			bool isFixed(const int& index) const {
+				return lineType[index] != UNDEF;
+			}
+
+			void remove(const int& index) {
+				nextIndex[prevIndex[index]] = nextIndex[index];
+				prevIndex[nextIndex[index]] = prevIndex[index];
+				if (headIndex == index) {
+					headIndex = nextIndex[index];
+				}
+				alive[index] = false;
+				count_--;
+			}
+
+			// same as FoldabilityRingArrayHelper::foldPartially().
+			int crimp(const int& index) {
+				const auto next = nextIndex[index];
+				const auto prev = prevIndex[index];
+
+				angleToNext[prev] += angleToNext[next] - angleToNext[index];
+				remove(next);
+				remove(index);
+
+				return prev;
+			}
+
+			void markDirty(const int& index) {
+				dirty.push_back(index);
+			}
+
+		public:
+			PartiallyCrimpedRing() : headIndex(-1), count_(0) {}
+
+			// TAngles: a vector of u_int.
+			template<typename TAngles>
+			PartiallyCrimpedRing(const TAngles& angles) :
+				angleToNext(angles.begin(), angles.end()), lineType(angles.size(), char(UNDEF)),
+				nextIndex(angles.size()), prevIndex(angles.size()), alive(angles.size(), true),
+				headIndex(0), count_(angles.size()) {
+
+				const int size = angles.size();
+				for (int i = 0; i < size; i++) {
+					nextIndex[i] = (i + 1) % size;
+					prevIndex[i] = (i + size - 1) % size;
+				}
+				dirty.reserve(4 * size);
+			}
+
+			// fixes the crease of line index.
+			// the line should be in the ring, that is, it should not be crimped yet.
+			void fix(const int index, const char type) {
+				lineType[index] = type;
+
+				// angles bounded by the line
+				markDirty(index);
+				markDirty(prevIndex[index]);
+			}
+
+			/**
+			 * applies crimps around the lines fixed after the last call.
+			 * return: false if the ring is proved to be unfoldable.
+			 */
+			bool reduce() {
+				while (!dirty.empty()) {
+					const int index = dirty.back();
+					dirty.pop_back();
+
+					if (count_ <= 2 || !alive[index]) {
+						continue;
+					}
+
+					const int next = nextIndex[index];
+					if (!isFixed(index) || !isFixed(next)) {
+						continue;
+					}
+
+					const auto& center = angleToNext[index];
+					const auto& prevAngle = angleToNext[prevIndex[index]];
+					const auto& nextAngle = angleToNext[next];
+
+					if (prevAngle < center || nextAngle < center) {
+						continue;
+					}
+
+					if (lineType[index] == lineType[next]) {
+						// large-small-large with the same crease type
+						if (prevAngle > center && nextAngle > center) {
+							dirty.clear();
+							return false;
+						}
+						continue;
+					}
+
+					const int merged = crimp(index);
+					markDirty(merged);
+					markDirty(prevIndex[merged]);
+					markDirty(nextIndex[merged]);
+				}
+
+				return true;
+			}
+
+			/**
+			 * call after all lines are fixed and reduce() succeeded.
+			 * return: true if the assignment is flat-foldable (same as IsFoldable).
+			 */
+			bool isFoldableCompletely() const {
+				if (count_ == 0) {
+					return true;
+				}
+
+				if (count_ == 2) {
+					const auto& tail = prevIndex[headIndex];
+					return angleToNext[headIndex] == angleToNext[tail] && lineType[headIndex] == lineType[tail];
+				}
+
+				return false;
+			}
+
+			const u_int& count() const {
+				return count_;
+			}
+
+			PartiallyCrimpedRing& operator=(const PartiallyCrimpedRing& right) {
+				angleToNext = right.angleToNext;
+				lineType = right.lineType;
+				nextIndex = right.nextIndex;
+				prevIndex = right.prevIndex;
+				alive = right.alive;
+				headIndex = right.headIndex;
+				count_ = right.count_;
+				dirty = right.dirty;
+
+				return *this;
+			}
+		};
+
+//-----------------------------------------------------------------------------------------------------------------------------
+
+		/**
+		 * MV enumeration with foldability pruning.
+		 * Lines are fixed in increasing order of index as the PPC search goes deeper:
+		 * lines skipped by a child are fixed as MAJOR and the added line as MINOR.
+		 * A child is pruned as soon as its partially crimped ring is proved to be unfoldable,
+		 * and an answer needs only the rest of the crimps.
+		 *
+		 * ansDetecter should be a maekawa condition (e.g. StatsMaekawaTheorem),
+		 * since this class tests foldability by itself.
+		 */
+		template<typename TOStream, typename TSet_Assignment, bool needStats = true>
+		class CrimpPruningMVEnumeration : public IMVEnumeration<TOStream, TSet_Assignment, needStats> {
+			mylib::EnumerationStats stats;
+
+			class Implementation {
+				mylib::EnumerationStats stats_;
+				const ppc::PPCSearchTool<TSet_Assignment>& tool;
+
+				// rings[depth] is the ring of the node at the depth.
+				std::vector<PartiallyCrimpedRing>& rings;
+
+			public:
+				Implementation(
+					const ppc::PPCSearchTool<TSet_Assignment>& tool, std::vector<PartiallyCrimpedRing>& rings)
+					:tool(tool), rings(rings)
+				{}
+
+				void enumerate(TSet_Assignment& assignments,
+					const int candBegin, const int candEnd, int prefixTail, const int depth, TOStream& os) {
+
+					if (tool.hasGenerated(assignments, candBegin, prefixTail))
+						return;
+
+					if (tool.needPruning(assignments, depth))
+						return;
+
+					if (needStats)
+						stats_.validCallCount++;
+
+					auto& ring = rings[depth];
+
+					if (tool.isAnswer(assignments)) {
+						auto& leafRing = rings[depth + 1];
+						leafRing = ring;
+						for (int i = candBegin; i < candEnd; i++) {
+							leafRing.fix(i, PartiallyCrimpedRing::MAJOR);
+						}
+
+						if (leafRing.reduce() && leafRing.isFoldableCompletely()) {
+							if (needStats)
+								stats_.answerCount++;
+
+							os << assignments;
+						}
+						return;
+					}
+
+					auto nextPrefixTail = candBegin - 1;
+
+					for (auto cand = candBegin; cand < candEnd; cand++) {
+						auto& childRing = rings[depth + 1];
+						childRing = ring;
+
+						for (int i = candBegin; i < cand; i++) {
+							childRing.fix(i, PartiallyCrimpedRing::MAJOR);
+						}
+						childRing.fix(cand, PartiallyCrimpedRing::MINOR);
+
+						if (!childRing.reduce()) {
+							continue;
+						}
+
+						assignments.add(cand);
+
+						enumerate(assignments, cand + 1, candEnd,
+							nextPrefixTail, depth + 1, os);
+
+						assignments.remove(cand);
+					}
+				}
+
+				mylib::EnumerationStats stats() {
+					return stats_;
+				}
+			};
+
+		public:
+			CrimpPruningMVEnumeration() {}
+
+			virtual const mylib::EnumerationStats& mvStats() {
+				return stats;
+			}
+
+			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning = MaekawaPruning<TSet_Assignment>()) {
+
+				FlapContext context(flap);
+				return enumerateInContext(context, os, ansDetecter, pruning);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning) {
+
+				MVSymmetryDetecter<TSet_Assignment> symmDetecter(context);
+				return enumerateInContext(context, os, ansDetecter, pruning, symmDetecter);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning,
+				ppc::AbstractDuplicationDetecter<TSet_Assignment>& duplication) {
+
+				ppc::PPCSearchTool<TSet_Assignment> tool;
+
+				tool.setDuplication(duplication);
+				tool.setAnswer(ansDetecter);
+				tool.setPruning(pruning);
+
+				const int lineCount = context.lineCount();
+
+				std::vector<PartiallyCrimpedRing> rings(lineCount + 2, PartiallyCrimpedRing(context.angles()));
+
+				TSet_Assignment seed(lineCount);
+
+				Implementation search(tool, rings);
+				search.enumerate(seed, 0, lineCount, -1, 0, os);
+
+				stats = search.stats();
+
+				return stats;
+			}
+
+			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os) {
+				MaekawaTheorem<TSet_Assignment> ansDetecter;
+
+				return this->enumerate(flap, os, ansDetecter);
+			}
+		};
+	}
+}
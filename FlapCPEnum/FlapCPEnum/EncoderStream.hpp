@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include "FlapPattern.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		// for implementing enumeration.
+		// user doesn't have to care this class.
+		template<typename EncoderFunc>
+		class CPEncoderStream {
+			EncoderFunc& encode;
+			const EncodablePatternBase& flap;
+		public:
+			CPEncoderStream(const EncodablePatternBase& flap, EncoderFunc& encode) :
+				flap(flap), encode(encode) {
+			}
+
+			template<typename TSet_Assignment>
+			CPEncoderStream& operator<<(const TSet_Assignment& mvPattern) {
+				encode(flap, mvPattern);
+				return *this;
+			}
+
+			// called once after the flap is enumerated.
+			void flush() {
+			}
+		};
+
+		// for implementing enumeration.
+		// counts the answers of a flap and passes the total to encode.add(flap, count) on flush().
+		template<typename EncoderFunc>
+		class CountingEncoderStream {
+			EncoderFunc& encode;
+			const EncodablePatternBase& flap;
+			unsigned long long int answerCount;
+		public:
+			CountingEncoderStream(const EncodablePatternBase& flap, EncoderFunc& encode) :
+				encode(encode), flap(flap), answerCount(0ULL) {
+			}
+
+			template<typename TSet_Assignment>
+			CountingEncoderStream& operator<<(const TSet_Assignment&) {
+				answerCount++;
+				return *this;
+			}
+
+			void flush() {
+				encode.add(flap, answerCount);
+				answerCount = 0ULL;
+			}
+		};
+
+		// for implementing enumeration.
+		// passes every answer to encode(flap, mvPattern) and calls encode.endFlap(flap) on flush(),
+		// for encoders which write a flap at once.
+		template<typename EncoderFunc>
+		class FlapGroupingEncoderStream {
+			EncoderFunc& encode;
+			const EncodablePatternBase& flap;
+		public:
+			FlapGroupingEncoderStream(const EncodablePatternBase& flap, EncoderFunc& encode) :
+				encode(encode), flap(flap) {
+			}
+
+			template<typename TSet_Assignment>
+			FlapGroupingEncoderStream& operator<<(const TSet_Assignment& mvPattern) {
+				encode(flap, mvPattern);
+				return *this;
+			}
+
+			void flush() {
+				encode.endFlap(flap);
+			}
+		};
+
+		// the stream given to MV enumerations for EncoderFunc.
+		// encoders which only count answers specialize this to CountingEncoderStream,
+		// and encoders which write a flap at once to FlapGroupingEncoderStream.
+		template<typename EncoderFunc>
+		struct EncoderStreamOf {
+			typedef CPEncoderStream<EncoderFunc> type;
+		};
+	}
+}
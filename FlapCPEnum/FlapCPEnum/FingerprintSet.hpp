@@ -0,0 +1,227 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "abbreviation.h"
+
+namespace mylib {
+
+	// 64-bit mixer from splitmix64.
+	inline unsigned long long mixBits64(unsigned long long x) {
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ULL;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebULL;
+		x ^= x >> 31;
+		return x;
+	}
+
+	// hashes the given bytes 8 at a time.
+	inline unsigned long long hashBytes64(const char *data, const size_t length, const unsigned long long seed) {
+		unsigned long long h = mixBits64(seed ^ length);
+
+		size_t i = 0;
+		for (; i + 8 <= length; i += 8) {
+			unsigned long long word = 0;
+			for (int b = 0; b < 8; b++) {
+				word |= (unsigned long long)(unsigned char)data[i + b] << (8 * b);
+			}
+			h = mixBits64(h ^ word);
+		}
+
+		unsigned long long tail = 0;
+		for (int b = 0; i < length; i++, b++) {
+			tail |= (unsigned long long)(unsigned char)data[i] << (8 * b);
+		}
+		return mixBits64(h ^ tail);
+	}
+
+	struct Fingerprint64 {
+		unsigned long long value;
+
+		Fingerprint64() : value(0ULL) {}
+
+		static Fingerprint64 of(const char *data, const size_t length) {
+			Fingerprint64 fp;
+			fp.value = hashBytes64(data, length, 0x9e3779b97f4a7c15ULL);
+			// 0 is reserved for empty slots.
+			if (fp.value == 0ULL) fp.value = 1ULL;
+			return fp;
+		}
+
+		bool isEmpty() const {
+			return value == 0ULL;
+		}
+
+		unsigned long long slotHash() const {
+			return value;
+		}
+
+		bool operator==(const Fingerprint64& right) const {
+			return value == right.value;
+		}
+	};
+
+	// two independent 64-bit hashes. collisions are negligible even for billions of keys.
+	struct Fingerprint128 {
+		unsigned long long high, low;
+
+		Fingerprint128() : high(0ULL), low(0ULL) {}
+
+		static Fingerprint128 of(const char *data, const size_t length) {
+			Fingerprint128 fp;
+			fp.high = hashBytes64(data, length, 0x9e3779b97f4a7c15ULL);
+			fp.low = hashBytes64(data, length, 0xc2b2ae3d27d4eb4fULL);
+			// (0, 0) is reserved for empty slots.
+			if (fp.isEmpty()) fp.low = 1ULL;
+			return fp;
+		}
+
+		bool isEmpty() const {
+			return high == 0ULL && low == 0ULL;
+		}
+
+		unsigned long long slotHash() const {
+			return high;
+		}
+
+		bool operator==(const Fingerprint128& right) const {
+			return high == right.high && low == right.low;
+		}
+	};
+
+	/**
+	 * Open-addressing (linear probing) hash set of fixed-width fingerprints.
+	 * Keys are never stored; two keys with the same fingerprint are regarded as the same.
+	 *
+	 * The table starts with INITIAL_SLOT_COUNT slots (fewer if byteLimit is smaller) and grows by doubling
+	 * but never beyond byteLimit. clear() keeps the size of the table.
+	 * Use canHold(keyCount) before a search to know whether all keys will fit; the key length does not matter.
+	 * insert() throws std::length_error if the limit is exceeded anyway.
+	 *
+	 * TFingerprint: Fingerprint64 or Fingerprint128.
+	 */
+	template<typename TFingerprint = Fingerprint128>
+	class FingerprintSet {
+		std::vector<TFingerprint> slots;
+		size_t mask = 0;
+		size_t count_ = 0;
+		size_t byteLimit_;
+
+		static const size_t INITIAL_SLOT_COUNT = 1024;
+
+		// max load factor is 1/2.
+		static size_t slotCountFor(const size_t keyCount) {
+			size_t slotCount = 1;
+			while (slotCount < 2 * keyCount) slotCount *= 2;
+			return slotCount;
+		}
+
+		size_t maxSlotCount() const {
+			return byteLimit_ / sizeof(TFingerprint);
+		}
+
+		// a power of two. one slot even if the limit holds none, so that lookups need no check.
+		size_t initialSlotCount() const {
+			const size_t limit = (maxSlotCount() < INITIAL_SLOT_COUNT) ? maxSlotCount() : INITIAL_SLOT_COUNT;
+			size_t slotCount = 1;
+			while (2 * slotCount <= limit) slotCount *= 2;
+			return slotCount;
+		}
+
+		// returns the slot holding fp or the empty slot where fp should be.
+		size_t findSlot(const TFingerprint& fp) const {
+			size_t i = fp.slotHash() & mask;
+			while (!slots[i].isEmpty() && !(slots[i] == fp)) {
+				i = (i + 1) & mask;
+			}
+			return i;
+		}
+
+		void rehash(const size_t slotCount) {
+			std::vector<TFingerprint> old(slotCount);
+			old.swap(slots);
+			mask = slotCount - 1;
+
+			for (const auto& fp : old) {
+				if (!fp.isEmpty()) {
+					slots[findSlot(fp)] = fp;
+				}
+			}
+		}
+
+	public:
+		FingerprintSet(const size_t byteLimit) : byteLimit_(byteLimit) {
+			slots.resize(initialSlotCount());
+			mask = slots.size() - 1;
+		}
+
+		// true if keyCount keys can be stored under the memory limit.
+		bool canHold(const size_t keyCount) const {
+			return slotCountFor(keyCount) <= maxSlotCount();
+		}
+
+		bool contains(const TFingerprint& fp) const {
+			return !slots[findSlot(fp)].isEmpty();
+		}
+
+		// return: false if fp already exists.
+		bool insert(const TFingerprint& fp) {
+			auto i = findSlot(fp);
+			if (!slots[i].isEmpty()) {
+				return false;
+			}
+
+			if (2 * (count_ + 1) > slots.size()) {
+				if (2 * slots.size() > maxSlotCount()) {
+					throw std::length_error("FingerprintSet: memory limit exceeded.");
+				}
+				rehash(2 * slots.size());
+				i = findSlot(fp);
+			}
+
+			slots[i] = fp;
+			count_++;
+			return true;
+		}
+
+		bool contains(const char *data, const size_t length) const {
+			return contains(TFingerprint::of(data, length));
+		}
+
+		bool insert(const char *data, const size_t length) {
+			return insert(TFingerprint::of(data, length));
+		}
+
+		template<typename TString>
+		bool contains(const TString& key) const {
+			return contains(key.data(), key.size());
+		}
+
+		template<typename TString>
+		bool insert(const TString& key) {
+			return insert(key.data(), key.size());
+		}
+
+		// empties the table without reallocating it.
+		void clear() {
+			std::fill(slots.begin(), slots.end(), TFingerprint());
+			count_ = 0;
+		}
+
+		const size_t& count() const {
+			return count_;
+		}
+
+		const size_t& byteLimit() const {
+			return byteLimit_;
+		}
+
+		// bytes used by the table.
+		size_t memoryUsage() const {
+			return slots.size() * sizeof(TFingerprint);
+		}
+	};
+}
@@ -2,11 +2,17 @@
 
 #include <memory>
 #include <map>
+#include <type_traits>
 
 #include "KawasakiFlapEnumeration.hpp"
 #include "MVEnumeration.hpp"
 #include "FoldableMVEnumeration.hpp"
+#include "CrimpPruningMVEnumeration.hpp"
+#include "BatchFoldableMVEnumeration.hpp"
+#include "FoldabilityBenchmark.hpp"
 #include "ItemCountingStream.hpp"
+#include "CPStringWriter.hpp"
+#include "EncoderStream.hpp"
 
 #include "IsFoldable.hpp"
 #include "StatsMaekawaTheorem.hpp"
@@ -18,29 +24,11 @@ namespace enumeration {
 
 		// for implementing enumeration.
 		// user doesn't have to care this class.
-		template<typename EncoderFunc>
-		class CPEncoderStream {
-			EncoderFunc& encode;
-			const EncodablePatternBase& flap;
-		public:
-			CPEncoderStream(const EncodablePatternBase& flap, EncoderFunc& encode) :
-				flap(flap), encode(encode) {
-			}
-
-			template<typename TSet_Assignment>
-			CPEncoderStream& operator<<(const TSet_Assignment& mvPattern) {
-				encode(flap, mvPattern);
-				return *this;
-			}
-		};
-
-
-		// for implementing enumeration.
-		// user doesn't have to care this class.
+		// if needTimers, the time of each phase is accumulated to phaseTimer().
 		template<
 			typename EncoderFunc,
 			template<typename TOStream, typename TSet_Assignment, bool needStats_> class TMVEnumeration,
-			typename TSet_Assignment = mylib::BitSet, bool needStats = true >
+			typename TSet_Assignment = mylib::BitSet, bool needStats = true, bool needTimers = false >
 			class EnumerationPipe {
 			EncoderFunc& encode;
 			mylib::EnumerationStats totalStats_;
@@ -49,29 +37,79 @@ namespace enumeration {
 
 			IFlapCPAnswerDetecterFactory<TSet_Assignment>& factory;
 
+			// scratch of the current flap.
+			mylib::MonotonicArena arena;
+
+			PhaseTimer<needTimers> timer;
+
+			template<typename TStream>
+			mylib::EnumerationStats search(const FlapContext& context, TStream& out,
+				mylib::IAnswerDetecter<TSet_Assignment>& isAnswer, std::false_type) {
+
+				MVSymmetryDetecter<TSet_Assignment> duplication(context);
+
+				TMVEnumeration<TStream, TSet_Assignment, needStats> mv;
+				IMVEnumeration<TStream, TSet_Assignment, needStats>& enumeration = mv;
+				return enumeration.enumerateInContext(context, out, isAnswer, MaekawaPruning<TSet_Assignment>(), duplication);
+			}
+
+			// foldability tests, duplication checks and outputs are timed by the wrappers.
+			template<typename TStream>
+			mylib::EnumerationStats search(const FlapContext& context, TStream& out,
+				mylib::IAnswerDetecter<TSet_Assignment>& isAnswer, std::true_type) {
+
+				TimedStream<TStream> timedOut(out, timer);
+				TimedAnswerDetecter<TSet_Assignment> timedIsAnswer(isAnswer, timer);
+				MVSymmetryDetecter<TSet_Assignment> duplication(context);
+				TimedDuplicationDetecter<TSet_Assignment> timedDuplication(duplication, timer);
+
+				TMVEnumeration<TimedStream<TStream>, TSet_Assignment, needStats> mv;
+				IMVEnumeration<TimedStream<TStream>, TSet_Assignment, needStats>& enumeration = mv;
+				return enumeration.enumerateInContext(context, timedOut, timedIsAnswer, MaekawaPruning<TSet_Assignment>(), timedDuplication);
+			}
+
 			public:
 				EnumerationPipe(EncoderFunc& encode, IFlapCPAnswerDetecterFactory<TSet_Assignment>& factory) : encode(encode), factory(factory) {
 					maekawaValidCount = 0ULL;
 				}
 
 				EnumerationPipe& operator<<(const EncodablePatternBase& flap) {
-					typedef CPEncoderStream<EncoderFunc> EncoderStream;
+					typedef typename EncoderStreamOf<EncoderFunc>::type EncoderStream;
 					EncoderStream out(flap, encode);
 
-					TMVEnumeration<EncoderStream, TSet_Assignment, needStats> mv;
+					{
+						ScopedPhase<needTimers> setupPhase(timer, PhaseTimes::FLAP_SETUP);
+
+						// shared by the mv enumeration and the detecter.
+						const FlapContext context(flap, arena);
 
-					//IsFoldable<TSet> isAnswer(flap);
-					auto isAnswer = factory.create(flap);
+						//IsFoldable<TSet> isAnswer(flap);
+						auto isAnswer = factory.create(context, arena);
 
-					totalStats_ += mv.enumerate(flap, out, *isAnswer);
+						{
+							ScopedPhase<needTimers> searchPhase(timer, PhaseTimes::MV_SEARCH);
+							totalStats_ += search(context, out, *isAnswer, std::integral_constant<bool, needTimers>());
+						}
 
-					maekawaValidCount += isAnswer->maekawaValidCount();
+						maekawaValidCount += isAnswer->maekawaValidCount();
+						totalStats_ += isAnswer->detecterStats();
 
-					delete isAnswer;
+						factory.destroy(isAnswer, arena);
+					}
+
+					{
+						ScopedPhase<needTimers> encodingPhase(timer, PhaseTimes::ENCODING);
+						out.flush();
+					}
+					arena.reset();
 
 					return *this;
 				}
 
+				PhaseTimer<needTimers>& phaseTimer() {
+					return timer;
+				}
+
 				const mylib::EnumerationStats& totalStats() {
 					return totalStats_;
 				}
@@ -89,18 +127,23 @@ namespace enumeration {
 
 		/**
 		* TOStream << enumeration::Countable(#line, crease pattern string);
+		* the string is passed as CPStringView, which is valid until the next call.
+		* the text of a flap is cached until endFlap(flap).
 		*/
 		template<typename TOStream>
 		class CPStringEncoder {
 			TOStream& outStream;
+			CPStringWriter writer;
 
 		public:
 			CPStringEncoder(TOStream& os) : outStream(os) {
 
 			}
 
+			// a flap without assignments is not cached.
 			void operator()(const EncodablePatternBase& flap) {
-				outStream << createCountable(flap.count() / 2 - 1, flap.encode());
+				writer.invalidate();
+				outStream << createCountable(flap.count() / 2 - 1, writer.write(flap));
 			}
 
 			CPStringEncoder& operator<<(const EncodablePatternBase& flap) {
@@ -110,8 +153,18 @@ namespace enumeration {
 
 			template <typename TBitSet>
 			void operator()(const EncodablePatternBase& flap, const TBitSet& minors) {
-				outStream << createCountable(flap.count() / 2 - 1, flap.encode(minors));
+				outStream << createCountable(flap.count() / 2 - 1, writer.write(flap, minors));
 			}
+
+			void endFlap(const EncodablePatternBase&) {
+				writer.invalidate();
+			}
+		};
+
+		// the cache of the writer is invalidated once per flap.
+		template<typename TOStream>
+		struct EncoderStreamOf<CPStringEncoder<TOStream> > {
+			typedef FlapGroupingEncoderStream<CPStringEncoder<TOStream> > type;
 		};
 
 		template<typename TOStream>
@@ -135,6 +188,17 @@ namespace enumeration {
 			void operator()(const EncodablePatternBase& flap, const TBitSet& minors) {
 				outStream << createCountable(flap.count() / 2 - 1, NULL);
 			}
+
+			// count answers of flap at once.
+			void add(const EncodablePatternBase& flap, const unsigned long long int count) {
+				outStream.add(flap.count() / 2 - 1, count);
+			}
+		};
+
+		// answers are counted per flap without calling the encoder for each.
+		template<typename TOStream>
+		struct EncoderStreamOf<CountOnlyEncoder<TOStream> > {
+			typedef CountingEncoderStream<CountOnlyEncoder<TOStream> > type;
 		};
 
 		/**
@@ -153,12 +217,13 @@ namespace enumeration {
 		 */
 		template<
 			template <typename TOStream, typename TSet_Assignment, bool needStats_> class TMVEnumeration,
-			bool needStats = true, typename TSet_Assignment = mylib::BitSet>
+			bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
 
 		class FlapCPEnumeration {
 			mylib::EnumerationStats kawasakiStats_;
 			mylib::EnumerationStats mvStats_;
 			long double sufficientRate_;
+			PhaseTimes phaseTimes_;
 
 			IFlapCPAnswerDetecterFactory<TSet_Assignment>& factory;
 
@@ -182,18 +247,27 @@ namespace enumeration {
 				return sufficientRate_;
 			}
 
+			// zero unless needTimers.
+			const PhaseTimes& phaseTimes() {
+				return phaseTimes_;
+			}
+
 			/**
 				* enumerates and passes every result to encode(flap, minors).
 				*/
 			template<typename EncoderFunc>
 			void enumerate(u_int placeCount, EncoderFunc& encode) {
-				EnumerationPipe<EncoderFunc, TMVEnumeration, TSet_Assignment> pipe(encode, factory);
+				EnumerationPipe<EncoderFunc, TMVEnumeration, TSet_Assignment, true, needTimers> pipe(encode, factory);
 
 				KawasakiFlapEnumeration<needStats> kawasaki;
-				kawasakiStats_ = kawasaki.enumerate(placeCount, pipe);
+				{
+					ScopedPhase<needTimers> kawasakiPhase(pipe.phaseTimer(), PhaseTimes::KAWASAKI);
+					kawasakiStats_ = kawasaki.enumerate(placeCount, pipe);
+				}
 	
 				mvStats_ = pipe.totalStats();
 				sufficientRate_ = pipe.sufficientRate();
+				phaseTimes_ = pipe.phaseTimer().times();
 			}
 
 			/**
@@ -240,49 +314,113 @@ namespace enumeration {
 		};
 
 
-		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet>
-		class FoldableFlapCPEnumeration : public FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment> {
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class FoldableFlapCPEnumeration : public FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment, needTimers> {
 			FoldabilityDetecterFactory<TSet_Assignment> factory;
 		public:
-			FoldableFlapCPEnumeration() : FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment>(factory) {}
+			FoldableFlapCPEnumeration() : FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
 		};
 
-		// not fast due to bad impl of LinearMV
-		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet>
-		class LinearMVFoldableFlapCPEnumeration : public FlapCPEnumeration<LinearMVEnumeration, needStats, TSet_Assignment> {
+		// the tester is chosen per flap by the line count.
+		// the threshold is measured at construction if it is not given.
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class AdaptiveFoldableFlapCPEnumeration : public FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment, needTimers> {
+			AdaptiveFoldabilityDetecterFactory<TSet_Assignment> factory;
+		public:
+			AdaptiveFoldableFlapCPEnumeration() :
+				FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment, needTimers>(factory),
+				factory(FoldabilityBenchmark().measureCrossover()) {}
+
+			AdaptiveFoldableFlapCPEnumeration(const u_int linearThreshold) :
+				FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment, needTimers>(factory), factory(linearThreshold) {}
+
+			const u_int& linearThreshold() const {
+				return factory.linearThreshold();
+			}
+		};
+
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class MemoizedFoldableFlapCPEnumeration : public FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment, needTimers> {
+			MemoizedFoldabilityDetecterFactory<TSet_Assignment> factory;
+		public:
+			MemoizedFoldableFlapCPEnumeration() : FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
+		};
+
+		// not fast due to bad impl of LinearMV.
+		// large flaps are enumerated with PPC since the cache cannot hold all the nodes.
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class LinearMVFoldableFlapCPEnumeration : public FlapCPEnumeration<LinearMVEnumeration, needStats, TSet_Assignment, needTimers> {
 			FoldabilityDetecterFactory<TSet_Assignment> factory;
 		public:
-			LinearMVFoldableFlapCPEnumeration() : FlapCPEnumeration<LinearMVEnumeration, needStats, TSet_Assignment>(factory) {}
+			LinearMVFoldableFlapCPEnumeration() : FlapCPEnumeration<LinearMVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
 		};
 
-		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet>
-		class MVLSLFoldableFlapCPEnumeration : public FlapCPEnumeration<MVLSLEnumeration, needStats, TSet_Assignment> {
+		// LinearMV with exact canonical strings in an arena trie.
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class TrieLinearMVFoldableFlapCPEnumeration : public FlapCPEnumeration<TrieLinearMVEnumeration, needStats, TSet_Assignment, needTimers> {
 			FoldabilityDetecterFactory<TSet_Assignment> factory;
 		public:
-			MVLSLFoldableFlapCPEnumeration() : FlapCPEnumeration<MVLSLEnumeration, needStats, TSet_Assignment>(factory) {}
+			TrieLinearMVFoldableFlapCPEnumeration() : FlapCPEnumeration<TrieLinearMVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
 		};
 
-		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet>
-		class ExMVLSLFoldableFlapCPEnumeration : public FlapCPEnumeration<ExtendedMVLSLEnumeration, needStats, TSet_Assignment> {
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class MVLSLFoldableFlapCPEnumeration : public FlapCPEnumeration<MVLSLEnumeration, needStats, TSet_Assignment, needTimers> {
 			FoldabilityDetecterFactory<TSet_Assignment> factory;
 		public:
-			ExMVLSLFoldableFlapCPEnumeration() : FlapCPEnumeration<ExtendedMVLSLEnumeration, needStats, TSet_Assignment>(factory) {}
+			MVLSLFoldableFlapCPEnumeration() : FlapCPEnumeration<MVLSLEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
+		};
+
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class ExMVLSLFoldableFlapCPEnumeration : public FlapCPEnumeration<ExtendedMVLSLEnumeration, needStats, TSet_Assignment, needTimers> {
+			FoldabilityDetecterFactory<TSet_Assignment> factory;
+		public:
+			ExMVLSLFoldableFlapCPEnumeration() : FlapCPEnumeration<ExtendedMVLSLEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
+		};
+
+		// foldability is tested in the MV search, so the factory only gives maekawa condition.
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class CrimpPruningFoldableFlapCPEnumeration : public FlapCPEnumeration<CrimpPruningMVEnumeration, needStats, TSet_Assignment, needTimers> {
+			MaekawaTheoremFactory<TSet_Assignment> factory;
+		public:
+			CrimpPruningFoldableFlapCPEnumeration() : FlapCPEnumeration<CrimpPruningMVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
+		};
+
+		// foldability is tested in batches, so the factory only gives maekawa condition.
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class BatchFoldableFlapCPEnumeration : public FlapCPEnumeration<BatchFoldableMVEnumeration, needStats, TSet_Assignment, needTimers> {
+			MaekawaTheoremFactory<TSet_Assignment> factory;
+		public:
+			BatchFoldableFlapCPEnumeration() : FlapCPEnumeration<BatchFoldableMVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
 		};
 
 
 		// just an idea
-		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet>
-		class FoldableFlapCPCrimpBasedEnumeration : public FlapCPEnumeration<FoldableMVEnumeration, needStats, TSet_Assignment> {
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class FoldableFlapCPCrimpBasedEnumeration : public FlapCPEnumeration<FoldableMVEnumeration, needStats, TSet_Assignment, needTimers> {
 			DummyDetecterFactory<TSet_Assignment> factory;
 		public:
-			FoldableFlapCPCrimpBasedEnumeration() : FlapCPEnumeration<FoldableMVEnumeration, needStats, TSet_Assignment>(factory) {}
+			FoldableFlapCPCrimpBasedEnumeration() : FlapCPEnumeration<FoldableMVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
+		};
+
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class RevolvingDoorFoldableFlapCPEnumeration : public FlapCPEnumeration<RevolvingDoorMVEnumeration, needStats, TSet_Assignment, needTimers> {
+			FoldabilityDetecterFactory<TSet_Assignment> factory;
+		public:
+			RevolvingDoorFoldableFlapCPEnumeration() : FlapCPEnumeration<RevolvingDoorMVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
+		};
+
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class MaekawaFlapCPEnumeration : public FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment, needTimers> {
+			MaekawaTheoremFactory<TSet_Assignment> factory;
+		public:
+			MaekawaFlapCPEnumeration() : FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
 		};
 
-		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet>
-		class MaekawaFlapCPEnumeration : public FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment> {
+		template<bool needStats = true, typename TSet_Assignment = mylib::BitSet, bool needTimers = false>
+		class RevolvingDoorMaekawaFlapCPEnumeration : public FlapCPEnumeration<RevolvingDoorMVEnumeration, needStats, TSet_Assignment, needTimers> {
 			MaekawaTheoremFactory<TSet_Assignment> factory;
 		public:
-			MaekawaFlapCPEnumeration() : FlapCPEnumeration<MVEnumeration, needStats, TSet_Assignment>(factory) {}
+			RevolvingDoorMaekawaFlapCPEnumeration() : FlapCPEnumeration<RevolvingDoorMVEnumeration, needStats, TSet_Assignment, needTimers>(factory) {}
 		};
 	}
 }
@@ -7,6 +7,7 @@
 #include <cmath>
 #include <string>
 #include <vector>
+#include <algorithm>
 
 namespace enumeration {
 	namespace origami {
@@ -17,32 +18,62 @@ namespace enumeration {
 				return (i + peekBasePoint()) % capacity();
 			}
 
+			// the smallest i which is from or greater such that contains(lineIndex(i)).
+			// capacity() if there is no such i.
+			u_int findNextLine(const u_int& from) const {
+				const u_int base = peekBasePoint();
+				const u_int wrapped = capacity() - base;
+
+				if (from < wrapped) {
+					auto next = findNext(from + base);
+					if (next < capacity()) {
+						return next - base;
+					}
+					next = findNext(0);
+					return (next < base) ? next + wrapped : capacity();
+				}
+
+				if (from >= capacity()) {
+					return capacity();
+				}
+
+				auto next = findNext(from - wrapped);
+				return (next < base) ? next + wrapped : capacity();
+			}
+
 			template <typename GetLineType>
 			std::string encodePrivate(const GetLineType& getType) const {
 				using namespace std;
 				stringstream ss;
-				u_int shrinkedIndex = 0;
-
-				for (u_int i = 0; i < capacity(); ) {
-					if (contains(lineIndex(i))) {
-						ss << getType(lineIndex(i), shrinkedIndex);
-						shrinkedIndex++;
-						i++;
-					}
-					else {
-						int emptyCount = 0;
-						while (!contains(lineIndex(i)) && i < capacity()) {
-							emptyCount++;
-							i++;
-						}
+				scanCP(
+					[&ss](const u_int emptyCount) {
 						//ss << 'E';
 						ss << emptyCount;
-					}
-				}
+					},
+					[&ss, &getType, this](const u_int i, const u_int shrinkedIndex) {
+						ss << getType(lineIndex(i), shrinkedIndex);
+					});
 				return ss.str();
 			}
 
+			template <typename GetLineType>
+			void encodeBinaryPrivate(const GetLineType& getType, unsigned char* bytes) const {
+				std::fill_n(bytes, binarySize(), 0);
+				u_int shrinkedIndex = 0;
+
+				for (u_int i = findNextLine(0); i < capacity(); i = findNextLine(i + 1)) {
+					const unsigned char code = getType(shrinkedIndex);
+					bytes[i / 4] |= code << (2 * (i % 4));
+					shrinkedIndex++;
+				}
+			}
+
 		public:
+			// codes of encodeBinary().
+			static const unsigned char BINARY_EMPTY = 0;
+			static const unsigned char BINARY_MAJOR = 1;
+			static const unsigned char BINARY_MINOR = 2;
+
 			/**
 			* crease pattern string;
 			*
@@ -61,12 +92,52 @@ namespace enumeration {
 				return encodePrivate([](const int i, const int shrinked) {return '+'; });
 			}
 
+			/**
+			* the same pattern as encode(minors) in 2 bits per place, without run-length compression.
+			* place i of the CP string (i-th place from the base point) is bits [2 * (i % 4), 2 * (i % 4) + 2) of bytes[i / 4].
+			* bytes should have binarySize() bytes.
+			*/
+			template <typename TBitSet>
+			void encodeBinary(const TBitSet& minors, unsigned char* bytes) const {
+				encodeBinaryPrivate([&minors](const u_int shrinked) {
+					return (minors.contains(shrinked)) ? BINARY_MINOR : BINARY_MAJOR; }, bytes);
+			}
+
+			void encodeBinary(unsigned char* bytes) const {
+				encodeBinaryPrivate([](const u_int shrinked) {return BINARY_MAJOR; }, bytes);
+			}
+
+			/**
+			* walks the places in the order of encode().
+			* onEmpty(count) is called for each run of empty places and
+			* onLine(i, shrinkedIndex) for each line at the i-th place from the base point.
+			*/
+			template <typename OnEmpty, typename OnLine>
+			void scanCP(const OnEmpty& onEmpty, const OnLine& onLine) const {
+				u_int shrinkedIndex = 0;
+
+				for (u_int i = 0; i < capacity(); ) {
+					auto next = findNextLine(i);
+					if (next > i) {
+						onEmpty(next - i);
+						i = next;
+					}
+					if (i < capacity()) {
+						onLine(i, shrinkedIndex);
+						shrinkedIndex++;
+						i++;
+					}
+				}
+			}
+
+			u_int binarySize() const {
+				return (2 * capacity() + 7) / 8;
+			}
+
 			std::string toString() const {
 				std::stringstream ss;
-				for (u_int i = 0; i < capacity(); i++) {
-					if (contains(i)) {
-						ss << i << " ";
-					}
+				for (u_int i = findNext(0); i < capacity(); i = findNext(i + 1)) {
+					ss << i << " ";
 				}
 
 				return ss.str();
@@ -183,6 +254,10 @@ namespace enumeration {
 				return bits.capacity();
 			}
 
+			virtual u_int findNext(const u_int& from) const {
+				return bits.findNext(from);
+			}
+
 			bool kawasakiCountCanBeZero() const {
 				return (u_int)(abs(prefixKawasakiCount)) <= capacity() - lastItem;
 			}
@@ -304,6 +379,10 @@ namespace enumeration {
 				return bits.capacity();
 			}
 
+			virtual u_int findNext(const u_int& from) const {
+				return bits.findNext(from);
+			}
+
 			bool kawasakiCountCanBeZero() const {
 				auto left = abs(leftKawasakiCount);
 				auto right = abs(rightGap);
@@ -350,6 +429,10 @@ namespace enumeration {
 				bits.MPISend(destID, tag);
 			}
 
+			size_t MPIMessageSizeAsSet() const {
+				return bits.MPIMessageSize();
+			}
+
 			void MPIReceiveAsSet(int sourceID, int tag) {
 				bits.MPIReceive(sourceID, tag);
 			}
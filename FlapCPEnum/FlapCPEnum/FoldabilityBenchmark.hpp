@@ -0,0 +1,147 @@
+﻿#pragma once
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "abbreviation.h"
+#include "BitSet.hpp"
+#include "FlapPattern.hpp"
+#include "IsFoldable.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		struct FoldabilityTimings {
+			u_int lineCount;
+			double quadraticNanoSec;
+			double linearNanoSec;
+		};
+
+		/**
+		 * Microbenchmark of IsFoldable (quadratic) and IsFoldableLinear.
+		 * Each line count is measured on random maekawa-valid assignments of a kawasaki flap.
+		 * The flap has pairwise equal angles (a0 = a1, a2 = a3, ...), so kawasaki theorem holds.
+		 */
+		class FoldabilityBenchmark {
+			std::mt19937 random;
+			u_int sampleCount;
+			u_int repeatCount;
+
+			// avoids the calls to be optimized out.
+			u_int foldableCount = 0;
+
+			template<typename TDetecter>
+			double measure(TDetecter& detecter, const std::vector<mylib::BitSet>& assignmentsList) {
+				auto start = std::chrono::steady_clock::now();
+
+				for (u_int r = 0; r < repeatCount; r++) {
+					for (const auto& assignments : assignmentsList) {
+						if (detecter.isAnswer(assignments))
+							foldableCount++;
+					}
+				}
+
+				auto end = std::chrono::steady_clock::now();
+
+				const double nanoSec = std::chrono::duration<double, std::nano>(end - start).count();
+				return nanoSec / ((double)repeatCount * assignmentsList.size());
+			}
+
+		public:
+			FoldabilityBenchmark(const u_int sampleCount = 256, const u_int repeatCount = 8, const unsigned seed = 1) :
+				random(seed), sampleCount(sampleCount), repeatCount(repeatCount) {}
+
+			FlapPattern createFlap(const u_int& lineCount) {
+				std::uniform_int_distribution<u_int> angleDistribution(1, 3);
+
+				std::vector<u_int> places;
+				u_int place = 0;
+				for (u_int i = 0; i < lineCount; i += 2) {
+					const auto angle = angleDistribution(random);
+					places.push_back(place);
+					place += angle;
+					places.push_back(place);
+					place += angle;
+				}
+
+				FlapPattern flap(place);
+				for (const auto& p : places) {
+					flap.add(p);
+				}
+				return flap;
+			}
+
+			std::vector<mylib::BitSet> createAssignments(const u_int& lineCount) {
+				std::vector<u_int> lines(lineCount);
+				for (u_int i = 0; i < lineCount; i++) {
+					lines[i] = i;
+				}
+
+				std::vector<mylib::BitSet> assignmentsList;
+				for (u_int s = 0; s < sampleCount; s++) {
+					std::shuffle(lines.begin(), lines.end(), random);
+
+					mylib::BitSet assignments(lineCount);
+					for (u_int i = 0; i < lineCount / 2 - 1; i++) {
+						assignments.add(lines[i]);
+					}
+					assignmentsList.push_back(assignments);
+				}
+
+				return assignmentsList;
+			}
+
+			// lineCount should be even.
+			FoldabilityTimings measure(const u_int& lineCount) {
+				auto flap = createFlap(lineCount);
+				auto assignmentsList = createAssignments(lineCount);
+
+				IsFoldable<mylib::BitSet> quadratic(flap);
+				IsFoldableLinear<mylib::BitSet> linear(flap);
+
+				FoldabilityTimings timings;
+				timings.lineCount = lineCount;
+				timings.quadraticNanoSec = measure(quadratic, assignmentsList);
+				timings.linearNanoSec = measure(linear, assignmentsList);
+
+				return timings;
+			}
+
+			std::vector<FoldabilityTimings> measureRange(const u_int& minLineCount = 4, const u_int& maxLineCount = 64) {
+				std::vector<FoldabilityTimings> timingsList;
+
+				for (u_int lineCount = minLineCount; lineCount <= maxLineCount; lineCount += 2) {
+					timingsList.push_back(measure(lineCount));
+				}
+
+				return timingsList;
+			}
+
+			/**
+			 * return: the smallest line count from which the linear tester is faster for all measured counts.
+			 *         (the last line count + 2) if the quadratic tester wins at the last one.
+			 */
+			static u_int findCrossover(const std::vector<FoldabilityTimings>& timingsList) {
+				if (timingsList.empty()) {
+					return 0;
+				}
+
+				u_int crossover = timingsList.back().lineCount + 2;
+				for (auto itr = timingsList.rbegin(); itr != timingsList.rend(); itr++) {
+					if (itr->linearNanoSec >= itr->quadraticNanoSec) {
+						break;
+					}
+					crossover = itr->lineCount;
+				}
+
+				return crossover;
+			}
+
+			u_int measureCrossover(const u_int& minLineCount = 4, const u_int& maxLineCount = 64) {
+				return findCrossover(measureRange(minLineCount, maxLineCount));
+			}
+		};
+	}
+}
@@ -246,17 +246,16 @@ namespace enumeration {
 			~FoldableMVEnumerationImpl() {
 			}
 
-			mylib::EnumerationStats enumerate(const EncodablePatternBase& flap) {
+			mylib::EnumerationStats enumerate(const FlapContext& context) {
 
 				// setup enumeration bases
 
-				const int lineCount = flap.count();
-				const int placeCount = flap.capacity();
+				const int lineCount = context.lineCount();
+				const int placeCount = context.placeCount();
 
-				LineIndexMapFactory mapFactory;
-				map = mapFactory.create(flap);
+				map = context.lineMap();
 
-				MVSymmetryDetecter<TSet_Assignment> symmetryDetecter(flap);
+				MVSymmetryDetecter<TSet_Assignment> symmetryDetecter(context);
 				auto inverters = symmetryDetecter.createInverterReferences();
 
 				// setup foldability test
@@ -280,7 +279,7 @@ namespace enumeration {
 			typename TOStream,
 			typename TSet_Assignment,
 			bool needStats = true>
-			class FoldableMVEnumeration : IMVEnumeration<TOStream, TSet_Assignment, needStats> {
+			class FoldableMVEnumeration : public IMVEnumeration<TOStream, TSet_Assignment, needStats> {
 
 			mylib::EnumerationStats stats;
 			public:
@@ -293,9 +292,17 @@ namespace enumeration {
 					mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
 					const mylib::IPruningSuggester<TSet_Assignment>& pruning = MaekawaPruning<TSet_Assignment>()) {
 
+					FlapContext context(flap);
+					return enumerateInContext(context, os, ansDetecter, pruning);
+				}
+
+				virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+					mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+					const mylib::IPruningSuggester<TSet_Assignment>& pruning) {
+
 					FoldableMVEnumerationImpl<TOStream, TSet_Assignment, needStats> enumeration(os, ansDetecter, pruning);
 
-					stats = enumeration.enumerate(flap);
+					stats = enumeration.enumerate(context);
 					return stats;
 				}
 
@@ -26,6 +26,19 @@ namespace mylib {
 		 */
 		virtual const u_int& capacity() const = 0;
 
+		/**
+		 * the smallest item which is from or greater.
+		 * returns capacity() if there is no such item.
+		 */
+		virtual Value findNext(const Value& from) const {
+			for (Value i = from; i < capacity(); i++) {
+				if (contains(i)) {
+					return i;
+				}
+			}
+			return capacity();
+		}
+
 		virtual std::string toString() const = 0;
 	};
 
@@ -0,0 +1,385 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "abbreviation.h"
+#include "FlapPattern.hpp"
+#include "BinaryCPFormat.hpp"
+#include "ItemCountingStream.hpp"
+#include "MappedFile.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		/**
+		* File layout (integers are little endian):
+		*   BinaryCPHeader with magic "FCPI",
+		*   for each flap: flap key, records of the flap (as BinaryCPWriter),
+		*   index: (flap key, offset of the flap (u64), #record (u64)) sorted by flap key,
+		*   footer: offset of the index (u64), #flap (u64), "FCPI".
+		*
+		* A flap key is the gap sequence from the base point, one byte per gap,
+		* padded with 0 to placeCount bytes. Flaps without records are not written.
+		*/
+		struct IndexedCPFormat {
+			static const size_t FOOTER_SIZE = 20;
+
+			static const char* magic() {
+				return "FCPI";
+			}
+
+			static void checkPlaceCount(const u_int placeCount) {
+				if (placeCount == 0 || placeCount > 255) {
+					throw std::length_error("IndexedCPFormat: gaps should fit in one byte.");
+				}
+			}
+
+			static size_t keySize(const u_int placeCount) {
+				return placeCount;
+			}
+
+			static size_t indexEntrySize(const u_int placeCount) {
+				return keySize(placeCount) + 16;
+			}
+
+			// writes the flap key of flap to key.
+			static void writeKey(const EncodablePatternBase& flap, unsigned char* key) {
+				std::fill_n(key, keySize(flap.capacity()), 0);
+
+				u_int first = flap.capacity();
+				u_int previous = 0;
+				u_int gapIndex = 0;
+				flap.scanCP(
+					[](const u_int) {},
+					[&](const u_int i, const u_int) {
+						if (first == flap.capacity()) {
+							first = i;
+						}
+						else {
+							key[gapIndex++] = (unsigned char)(i - previous);
+						}
+						previous = i;
+					});
+				if (first < flap.capacity()) {
+					key[gapIndex] = (unsigned char)(flap.capacity() - previous + first);
+				}
+			}
+
+			// the flap key of a gap sequence.
+			static std::vector<unsigned char> createKey(const std::vector<u_int>& gaps, const u_int placeCount) {
+				if (gaps.size() > keySize(placeCount)) {
+					throw std::invalid_argument("IndexedCPFormat: too many gaps.");
+				}
+				std::vector<unsigned char> key(keySize(placeCount), 0);
+				for (size_t i = 0; i < gaps.size(); i++) {
+					if (gaps[i] == 0 || gaps[i] > 255) {
+						throw std::invalid_argument("IndexedCPFormat: a gap should be in [1, 255].");
+					}
+					key[i] = (unsigned char)gaps[i];
+				}
+				return key;
+			}
+
+			static void writeUInt64(std::ostream& os, const uint64_t value) {
+				unsigned char bytes[8];
+				for (int i = 0; i < 8; i++) {
+					bytes[i] = (value >> (8 * i)) & 0xFF;
+				}
+				os.write((const char*)bytes, 8);
+			}
+
+			static uint64_t readUInt64(const unsigned char* bytes) {
+				uint64_t value = 0;
+				for (int i = 0; i < 8; i++) {
+					value |= (uint64_t)bytes[i] << (8 * i);
+				}
+				return value;
+			}
+		};
+
+		// a record with the key of its flap. nothing is owned.
+		struct IndexedCPRecord {
+			const unsigned char* key;
+			BinaryCPRecord record;
+
+			IndexedCPRecord(const unsigned char* key, const BinaryCPRecord& record) : key(key), record(record) {}
+		};
+
+		/**
+		* TOStream << enumeration::Countable(#line, IndexedCPRecord);
+		* the record is valid until the next call.
+		*/
+		template<typename TOStream>
+		class IndexedCPEncoder {
+			TOStream& outStream;
+			std::vector<unsigned char> bytes;
+			std::vector<unsigned char> key;
+
+			void prepare(const EncodablePatternBase& flap) {
+				bytes.resize(flap.binarySize());
+				key.resize(IndexedCPFormat::keySize(flap.capacity()));
+				IndexedCPFormat::writeKey(flap, key.data());
+			}
+
+		public:
+			IndexedCPEncoder(TOStream& os) : outStream(os) {
+			}
+
+			void operator()(const EncodablePatternBase& flap) {
+				prepare(flap);
+				flap.encodeBinary(bytes.data());
+				outStream << createCountable(flap.count() / 2 - 1,
+					IndexedCPRecord(key.data(), BinaryCPRecord(bytes.data(), bytes.size())));
+			}
+
+			IndexedCPEncoder& operator<<(const EncodablePatternBase& flap) {
+				(*this)(flap);
+				return *this;
+			}
+
+			template <typename TBitSet>
+			void operator()(const EncodablePatternBase& flap, const TBitSet& minors) {
+				prepare(flap);
+				flap.encodeBinary(minors, bytes.data());
+				outStream << createCountable(flap.count() / 2 - 1,
+					IndexedCPRecord(key.data(), BinaryCPRecord(bytes.data(), bytes.size())));
+			}
+		};
+
+		/**
+		* writes records grouped by flap and the index on close().
+		* records of a flap should be given consecutively and each flap only once.
+		*/
+		class IndexedCPWriter {
+			struct Location {
+				uint64_t offset;
+				uint64_t count;
+			};
+
+			std::ostream& os;
+			const size_t keySize;
+			std::vector<char> buffer;
+			size_t used;
+			// bytes written so far including the buffer.
+			uint64_t offset;
+
+			std::vector<unsigned char> keys;
+			std::vector<Location> locations;
+			bool closed;
+
+			void append(const void* data, const size_t size) {
+				if (used + size > buffer.size()) {
+					flush();
+				}
+				if (size > buffer.size()) {
+					os.write((const char*)data, size);
+				}
+				else {
+					std::memcpy(buffer.data() + used, data, size);
+					used += size;
+				}
+				offset += size;
+			}
+
+			bool isCurrentFlap(const unsigned char* key) const {
+				return !locations.empty() && std::memcmp(&keys[keys.size() - keySize], key, keySize) == 0;
+			}
+
+			void flush() {
+				os.write(buffer.data(), used);
+				used = 0;
+			}
+
+		public:
+			IndexedCPWriter(std::ostream& os, const BinaryCPHeader& header, const size_t bufferSize = BinaryCPWriter::DEFAULT_BUFFER_SIZE) :
+				os(os), keySize(IndexedCPFormat::keySize(header.placeCount)), buffer(bufferSize), used(0), offset(header.size()), closed(false) {
+				IndexedCPFormat::checkPlaceCount(header.placeCount);
+				header.write(os, IndexedCPFormat::magic());
+			}
+
+			IndexedCPWriter(const IndexedCPWriter&) = delete;
+			IndexedCPWriter& operator=(const IndexedCPWriter&) = delete;
+
+			~IndexedCPWriter() {
+				close();
+			}
+
+			IndexedCPWriter& operator<<(const IndexedCPRecord& record) {
+				if (!isCurrentFlap(record.key)) {
+					locations.push_back(Location{ offset + keySize, 0 });
+					keys.insert(keys.end(), record.key, record.key + keySize);
+					append(record.key, keySize);
+				}
+				append(record.record.bytes, record.record.size);
+				locations.back().count++;
+				return *this;
+			}
+
+			// writes the index and the footer.
+			void close() {
+				if (closed) {
+					return;
+				}
+				closed = true;
+
+				std::vector<u_int> order(locations.size());
+				for (u_int i = 0; i < order.size(); i++) {
+					order[i] = i;
+				}
+				std::sort(order.begin(), order.end(), [this](const u_int a, const u_int b) {
+					return std::memcmp(&keys[a * keySize], &keys[b * keySize], keySize) < 0;
+				});
+
+				flush();
+				const uint64_t indexOffset = offset;
+				for (auto i : order) {
+					os.write((const char*)&keys[i * keySize], keySize);
+					IndexedCPFormat::writeUInt64(os, locations[i].offset);
+					IndexedCPFormat::writeUInt64(os, locations[i].count);
+				}
+				IndexedCPFormat::writeUInt64(os, indexOffset);
+				IndexedCPFormat::writeUInt64(os, locations.size());
+				os.write(IndexedCPFormat::magic(), 4);
+				os.flush();
+			}
+
+			size_t flapCount() const {
+				return locations.size();
+			}
+		};
+
+		// records of one flap in an IndexedCPFile.
+		class FlapCPRecords {
+			const unsigned char* bytes;
+			uint64_t count_;
+			u_int placeCount;
+			u_int recordSize;
+
+		public:
+			FlapCPRecords(const unsigned char* bytes, const uint64_t count, const u_int placeCount) :
+				bytes(bytes), count_(count), placeCount(placeCount), recordSize((2 * placeCount + 7) / 8) {}
+
+			const uint64_t& count() const {
+				return count_;
+			}
+
+			bool empty() const {
+				return count_ == 0;
+			}
+
+			BinaryCPRecord record(const uint64_t i) const {
+				return BinaryCPRecord(bytes + i * recordSize, recordSize);
+			}
+
+			// the CP string of EncodablePatternBase::encode().
+			std::string cpString(const uint64_t i) const {
+				return BinaryCPReader::decode(bytes + i * recordSize, placeCount);
+			}
+		};
+
+		/**
+		* random access to a file written by IndexedCPWriter.
+		* the file is memory mapped and find() binary-searches the index,
+		* so that a flap is read without scanning the file.
+		*/
+		class IndexedCPFile {
+			mylib::MappedFile file;
+			BinaryCPHeader header_;
+			const unsigned char* index;
+			uint64_t flapCount_;
+			size_t keySize;
+			size_t entrySize;
+
+			void broken() const {
+				throw std::invalid_argument("IndexedCPFile: broken file.");
+			}
+
+		public:
+			explicit IndexedCPFile(const std::string& path) : file(path) {
+				const unsigned char* data = file.data();
+				const size_t size = file.size();
+				if (size < 4 + IndexedCPFormat::FOOTER_SIZE) {
+					broken();
+				}
+
+				mylib::MemoryStreamBuffer buffer(data, size);
+				std::istream is(&buffer);
+				header_.read(is, IndexedCPFormat::magic());
+				IndexedCPFormat::checkPlaceCount(header_.placeCount);
+
+				const unsigned char* footer = data + size - IndexedCPFormat::FOOTER_SIZE;
+				if (std::memcmp(footer + 16, IndexedCPFormat::magic(), 4) != 0) {
+					broken();
+				}
+				const uint64_t indexOffset = IndexedCPFormat::readUInt64(footer);
+				flapCount_ = IndexedCPFormat::readUInt64(footer + 8);
+
+				keySize = IndexedCPFormat::keySize(header_.placeCount);
+				entrySize = IndexedCPFormat::indexEntrySize(header_.placeCount);
+				if (indexOffset < header_.size() || indexOffset > size - IndexedCPFormat::FOOTER_SIZE ||
+					flapCount_ != (size - IndexedCPFormat::FOOTER_SIZE - indexOffset) / entrySize) {
+					broken();
+				}
+				index = data + indexOffset;
+			}
+
+			const BinaryCPHeader& header() const {
+				return header_;
+			}
+
+			const uint64_t& flapCount() const {
+				return flapCount_;
+			}
+
+			// the key of the i-th flap in the key order.
+			const unsigned char* key(const uint64_t i) const {
+				return index + i * entrySize;
+			}
+
+			// empty if the flap has no record in this file.
+			FlapCPRecords find(const unsigned char* flapKey) const {
+				uint64_t low = 0, high = flapCount_;
+				while (low < high) {
+					const uint64_t middle = low + (high - low) / 2;
+					if (std::memcmp(key(middle), flapKey, keySize) < 0) {
+						low = middle + 1;
+					}
+					else {
+						high = middle;
+					}
+				}
+
+				if (low == flapCount_ || std::memcmp(key(low), flapKey, keySize) != 0) {
+					return FlapCPRecords(nullptr, 0, header_.placeCount);
+				}
+
+				const unsigned char* entry = key(low) + keySize;
+				const uint64_t offset = IndexedCPFormat::readUInt64(entry);
+				const uint64_t count = IndexedCPFormat::readUInt64(entry + 8);
+				if (offset + count * header_.recordSize() > (uint64_t)(index - file.data())) {
+					broken();
+				}
+				return FlapCPRecords(file.data() + offset, count, header_.placeCount);
+			}
+
+			FlapCPRecords find(const EncodablePatternBase& flap) const {
+				if (flap.capacity() != header_.placeCount) {
+					throw std::invalid_argument("IndexedCPFile: the flap has a different #place.");
+				}
+				std::vector<unsigned char> flapKey(keySize);
+				IndexedCPFormat::writeKey(flap, flapKey.data());
+				return find(flapKey.data());
+			}
+
+			// gaps between lines from the base point.
+			FlapCPRecords find(const std::vector<u_int>& gaps) const {
+				return find(IndexedCPFormat::createKey(gaps, header_.placeCount).data());
+			}
+		};
+	}
+}
@@ -3,11 +3,14 @@
 #include "foldabilityhelpers.hpp"
 #include "AbstractFlapCPAnswerDetecter.hpp"
 #include "searchtool.hpp"
+#include "FingerprintSet.hpp"
 
 namespace enumeration {
 	namespace origami {
 
 		// Naive implementation. Answer is: a pattern which can be folded into plane.
+		// Flaps with at most 32 lines use a compact ring; the ring of an assignment is
+		// a memcpy of the flap's ring followed by the line types.
 		template<typename TSet_Assignment>
 		class IsFoldable : public AbstractFlapCPAnswerDetecter<TSet_Assignment> {
 			mylib::SharedArrayPointer<u_int> map;
@@ -17,27 +20,22 @@ namespace enumeration {
 			mylib::RingArrayList<LineGap> ring;
 			FoldabilityRingArrayHelper helper;
 
-			const u_int lineCount;
-			const u_int placeCount;
-
-			inline int findMinimalInRing(int startIndex) {
-				int index = startIndex;
+			// the flaps of feasible runs have fewer lines. larger flaps use the ring above.
+			typedef CompactLineGapRing<32> CompactRing;
 
-				for (u_int i = 0; i < ring.count(); i++) {
-					if (helper.isMinimalToBeFolded(ring, index)) {
-						return index;
-					}
-					index = ring.nextIndexOf(index);
-				}
+			// angles of the flap with UNDEF lines, and its working copy.
+			CompactRing compactPrototype;
+			CompactRing compactRing;
 
-				return -1;
-			}
+			const u_int lineCount;
+			const u_int placeCount;
+			const bool usesCompactRing;
 
 			bool test(const TSet_Assignment& pattern) {
 				auto index = ring.peekHeadIndex();
 
 				while (ring.count() > 2) {
-					index = findMinimalInRing(index);
+					index = helper.findMinimalToBeFolded(ring, index);
 					if (index < 0)
 						return false;
 
@@ -52,13 +50,52 @@ namespace enumeration {
 				return false;
 			}
 
+			bool testCompactRing() {
+				auto index = compactRing.peekHeadIndex();
+
+				while (compactRing.count() > 2) {
+					index = helper.findMinimalToBeFolded(compactRing, index);
+					if (index < 0)
+						return false;
+
+					index = helper.foldPartially(compactRing, index);
+				}
+				if (compactRing.count() == 0)
+					return true;
+
+				if (compactRing.count() == 2) {
+					const auto head = compactRing.peekHeadIndex();
+					const auto tail = compactRing.peekTailIndex();
+					return compactRing.angleToNext(head) == compactRing.angleToNext(tail)
+						&& compactRing.lineType(head) == compactRing.lineType(tail);
+				}
+
+				return false;
+			}
+
 			IsFoldable() {}
+
+			IsFoldable(const mylib::SharedArrayPointer<u_int>& map, const u_int placeCount, const u_int lineCount) :
+				map(map), lineCount(lineCount), placeCount(placeCount),
+				usesCompactRing(CompactRing::canHold(lineCount)) {
+
+				if (usesCompactRing) {
+					helper.resetRingArray(compactPrototype, placeCount, lineCount, map);
+				}
+				else {
+					ring = mylib::RingArrayList<LineGap>(placeCount);
+				}
+			}
+
 		public:
 
-			IsFoldable(const EncodablePatternBase &flap) : lineCount(flap.count()), placeCount(flap.capacity()) {
-				LineIndexMapFactory mapFactory;
-				map = mapFactory.create(flap);
+			IsFoldable(const EncodablePatternBase &flap) :
+				IsFoldable(LineIndexMapFactory().create(flap), flap.capacity(), flap.count()) {
+			}
 
+			// shares the line map of the context.
+			IsFoldable(const FlapContext& context) :
+				IsFoldable(context.lineMap(), context.placeCount(), context.lineCount()) {
 			}
 
 			virtual ~IsFoldable() {
@@ -70,7 +107,15 @@ namespace enumeration {
 					return false;
 				}
 
-				ring = helper.createRingArray(placeCount, lineCount, assignments, map);
+				if (usesCompactRing) {
+					compactRing = compactPrototype;
+					for (u_int i = 0; i < lineCount; i++) {
+						compactRing.lineType(i) = (assignments.contains(i)) ? Crease::MAJOR : Crease::MINOR;
+					}
+					return testCompactRing();
+				}
+
+				helper.resetRingArray(ring, placeCount, lineCount, assignments, map);
 
 				return test(assignments);
 			}
@@ -78,17 +123,167 @@ namespace enumeration {
 		};
 
 
+		/**
+		 * IsFoldable with a per-flap memo of reduced rings.
+		 * Angles of a reduced ring are determined by its remaining lines
+		 * (each is an alternating sum of the original angles), so the ring is identified
+		 * exactly by the remaining lines and their types. Lines should be at most 64.
+		 *
+		 * Every ring visited by the crimp loop is stored with the result while the memo
+		 * is within memoByteLimit; later assignments reaching a stored ring stop there.
+		 */
+		template<typename TSet_Assignment>
+		class MemoizedIsFoldable : public AbstractFlapCPAnswerDetecter<TSet_Assignment> {
+			typedef unsigned long long LineBits;
+
+			mylib::SharedArrayPointer<u_int> map;
+
+			mylib::RingArrayList<LineGap> ring;
+			FoldabilityRingArrayHelper helper;
+
+			const u_int lineCount;
+			const u_int placeCount;
+
+			mylib::FingerprintSet<> foldableRings;
+			mylib::FingerprintSet<> unfoldableRings;
+			std::vector<mylib::Fingerprint128> visitedRings;
+
+			mylib::EnumerationStats stats;
+
+			static LineBits bitOf(const int& index) {
+				return 1ULL << index;
+			}
+
+			// exact: mixBits64() is a bijection and only 0 maps to 0,
+			// so remainingLines is restored from high and low.
+			static mylib::Fingerprint128 keyOf(const LineBits& remainingLines, const LineBits& majorLines) {
+				mylib::Fingerprint128 key;
+				key.low = majorLines & remainingLines;
+				key.high = mylib::mixBits64(remainingLines ^ mylib::mixBits64(key.low));
+				return key;
+			}
+
+			void memorize(const bool& foldable) {
+				auto& rings = foldable ? foldableRings : unfoldableRings;
+
+				for (const auto& key : visitedRings) {
+					if (!rings.canHold(rings.count() + 1)) {
+						return;
+					}
+					rings.insert(key);
+				}
+			}
+
+			bool test(LineBits majorLines) {
+				auto index = ring.peekHeadIndex();
+				LineBits remainingLines = (lineCount == 64) ? ~0ULL : bitOf(lineCount) - 1;
+
+				visitedRings.clear();
+
+				while (ring.count() > 2) {
+					// the whole ring is never shared by assignments.
+					if (ring.count() < lineCount) {
+						const auto key = keyOf(remainingLines, majorLines);
+
+						if (foldableRings.contains(key)) {
+							stats.memoHitCount++;
+							memorize(true);
+							return true;
+						}
+						if (unfoldableRings.contains(key)) {
+							stats.memoHitCount++;
+							memorize(false);
+							return false;
+						}
+						visitedRings.push_back(key);
+					}
+
+					index = helper.findMinimalToBeFolded(ring, index);
+					if (index < 0) {
+						stats.memoMissCount++;
+						memorize(false);
+						return false;
+					}
+
+					remainingLines &= ~(bitOf(index) | bitOf(ring.nextIndexOf(index)));
+					index = helper.foldPartially(ring, index);
+				}
+
+				const bool foldable = ring.count() == 0 || (ring.count() == 2 && (ring.head() == ring.tail()));
+
+				stats.memoMissCount++;
+				memorize(foldable);
+
+				return foldable;
+			}
+
+			MemoizedIsFoldable(const mylib::SharedArrayPointer<u_int>& map, const u_int placeCount, const u_int lineCount,
+				const size_t memoByteLimit) :
+				map(map), ring(placeCount), lineCount(lineCount), placeCount(placeCount),
+				foldableRings(memoByteLimit / 2), unfoldableRings(memoByteLimit / 2) {
+
+				if (lineCount > 8 * sizeof(LineBits)) {
+					throw std::invalid_argument("MemoizedIsFoldable: too many lines.");
+				}
+
+				visitedRings.reserve(lineCount);
+			}
+
+		public:
+			static const size_t DEFAULT_MEMO_BYTE_LIMIT = 64ULL << 20;
+
+			MemoizedIsFoldable(const EncodablePatternBase &flap, const size_t memoByteLimit = DEFAULT_MEMO_BYTE_LIMIT) :
+				MemoizedIsFoldable(LineIndexMapFactory().create(flap), flap.capacity(), flap.count(), memoByteLimit) {
+			}
+
+			MemoizedIsFoldable(const FlapContext& context, const size_t memoByteLimit = DEFAULT_MEMO_BYTE_LIMIT) :
+				MemoizedIsFoldable(context.lineMap(), context.placeCount(), context.lineCount(), memoByteLimit) {
+			}
+
+			virtual ~MemoizedIsFoldable() {
+			}
+
+			virtual bool isAnswer(const TSet_Assignment& assignments) {
+
+				if (!this->maekawaTheoremHolds(assignments)) {
+					return false;
+				}
+
+				helper.resetRingArray(ring, placeCount, lineCount, assignments, map);
+
+				LineBits majorLines = 0ULL;
+				for (u_int i = 0; i < lineCount; i++) {
+					if (assignments.contains(i)) {
+						majorLines |= bitOf(i);
+					}
+				}
+
+				return test(majorLines);
+			}
+
+			virtual mylib::EnumerationStats detecterStats() const {
+				return stats;
+			}
+		};
+
+
 		// Answer is: a pattern which can be folded into a flat plane.
 		class FoldabiiltyTesterLinear {
+			// reused over calls in order to reduce memory allocation.
+			MinimalAngleIndexManager minimals;
 
 		public:
 			FoldabiiltyTesterLinear() {}
 
+			FoldabiiltyTesterLinear(const u_int ringSize) {
+				minimals.reserve(ringSize);
+			}
+
 			// an implemntation according to erik demeine's book
 			// "Geometric Folding Algorithms - Linkages, Origami, Polyhedra".
 			// really linear???
 			bool isFoldable(mylib::RingArrayList<LineGap>& ring) {
-				MinimalAngleIndexManager minimals(ring);
+				minimals.reset(ring);
 
 				while (ring.count() > 2) {
 					FoldabilityRingArrayHelper helper;
@@ -152,17 +347,23 @@ namespace enumeration {
 			const u_int lineCount;
 			const u_int placeCount;
 			FoldabilityRingArrayHelper helper;
+			FoldabiiltyTesterLinear tester;
 
 			IsFoldableLinear() {}
 
+			IsFoldableLinear(const mylib::SharedArrayPointer<u_int>& map, const u_int placeCount, const u_int lineCount) :
+				map(map), ring(placeCount), lineCount(lineCount), placeCount(placeCount), tester(placeCount) {
+			}
+
 		public:
 
 			IsFoldableLinear(const EncodablePatternBase &flap) :
-				ring(flap.capacity()), lineCount(flap.count()), placeCount(flap.capacity()) {
-
-				LineIndexMapFactory mapFactory;
-				map = mapFactory.create(flap);
+				IsFoldableLinear(LineIndexMapFactory().create(flap), flap.capacity(), flap.count()) {
+			}
 
+			// shares the line map of the context.
+			IsFoldableLinear(const FlapContext& context) :
+				IsFoldableLinear(context.lineMap(), context.placeCount(), context.lineCount()) {
 			}
 
 			virtual ~IsFoldableLinear() {
@@ -174,9 +375,7 @@ namespace enumeration {
 					return false;
 				}
 
-				ring = helper.createRingArray(placeCount, lineCount, assignments, map);
-
-				FoldabiiltyTesterLinear tester;
+				helper.resetRingArray(ring, placeCount, lineCount, assignments, map);
 
 				auto l = tester.isFoldable(ring);
 
@@ -220,6 +419,64 @@ namespace enumeration {
 			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const EncodablePatternBase& flap) const {
 				return new IsFoldable<TSet_Assignment>(flap);
 			}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context) const {
+				return new IsFoldable<TSet_Assignment>(context);
+			}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context, mylib::MonotonicArena& arena) const {
+				return arena.create<IsFoldable<TSet_Assignment> >(context);
+			}
+		};
+
+		// flaps with linearThreshold lines or more are tested by IsFoldableLinear, the others by IsFoldable.
+		// the threshold can be measured by FoldabilityBenchmark::measureCrossover().
+		template<typename TSet_Assignment>
+		class AdaptiveFoldabilityDetecterFactory : public IFlapCPAnswerDetecterFactory<TSet_Assignment> {
+			u_int linearThreshold_;
+		public:
+			AdaptiveFoldabilityDetecterFactory(const u_int linearThreshold) : linearThreshold_(linearThreshold) {}
+
+			virtual ~AdaptiveFoldabilityDetecterFactory() {}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const EncodablePatternBase& flap) const {
+				if (flap.count() >= linearThreshold_) {
+					return new IsFoldableLinear<TSet_Assignment>(flap);
+				}
+				return new IsFoldable<TSet_Assignment>(flap);
+			}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context) const {
+				if (context.lineCount() >= linearThreshold_) {
+					return new IsFoldableLinear<TSet_Assignment>(context);
+				}
+				return new IsFoldable<TSet_Assignment>(context);
+			}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context, mylib::MonotonicArena& arena) const {
+				if (context.lineCount() >= linearThreshold_) {
+					return arena.create<IsFoldableLinear<TSet_Assignment> >(context);
+				}
+				return arena.create<IsFoldable<TSet_Assignment> >(context);
+			}
+
+			const u_int& linearThreshold() const {
+				return linearThreshold_;
+			}
+		};
+
+		template<typename TSet_Assignment>
+		class MemoizedFoldabilityDetecterFactory : public IFlapCPAnswerDetecterFactory<TSet_Assignment> {
+			size_t memoByteLimit;
+		public:
+			MemoizedFoldabilityDetecterFactory(
+				const size_t memoByteLimit = MemoizedIsFoldable<TSet_Assignment>::DEFAULT_MEMO_BYTE_LIMIT) : memoByteLimit(memoByteLimit) {}
+
+			virtual ~MemoizedFoldabilityDetecterFactory() {}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const EncodablePatternBase& flap) const {
+				return new MemoizedIsFoldable<TSet_Assignment>(flap, memoByteLimit);
+			}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context) const {
+				return new MemoizedIsFoldable<TSet_Assignment>(context, memoByteLimit);
+			}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context, mylib::MonotonicArena& arena) const {
+				return arena.create<MemoizedIsFoldable<TSet_Assignment> >(context, memoByteLimit);
+			}
 		};
 
 		template<typename TSet_Assignment>
@@ -229,6 +486,12 @@ namespace enumeration {
 			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const EncodablePatternBase& flap) const {
 				return new IsFoldableLinear<TSet_Assignment>(flap);
 			}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context) const {
+				return new IsFoldableLinear<TSet_Assignment>(context);
+			}
+			virtual AbstractFlapCPAnswerDetecter<TSet_Assignment>* create(const FlapContext& context, mylib::MonotonicArena& arena) const {
+				return arena.create<IsFoldableLinear<TSet_Assignment> >(context);
+			}
 		};
 
 	}
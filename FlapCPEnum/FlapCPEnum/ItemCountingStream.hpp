@@ -18,6 +18,10 @@ namespace enumeration {
 		}
 
 		Countable(const Countable<TKey, Value>& source) : counterKey(source.counterKey), value(source.value) {}
+
+		// e.g. Countable<TKey, std::string> from Countable<TKey, CPStringView>.
+		template <typename SourceValue>
+		Countable(const Countable<TKey, SourceValue>& source) : counterKey(source.counterKey), value(source.value) {}
 	};
 
 	template <typename TKey, typename Value>
@@ -75,6 +79,22 @@ namespace enumeration {
 			return *this;
 		}
 
+		// counts n items at once. nothing is passed to the stream.
+		ItemCountingStream<TOStream>& add(const int index, const Count n) {
+			counts[index] += n;
+			return *this;
+		}
+
+		// counts n items at once and passes obj, which stands for them, to the stream.
+		template<typename TObject>
+		ItemCountingStream<TOStream>& add(const int index, const Count n, const TObject& obj) {
+			counts[index] += n;
+			if (out != nullptr)
+				(*out) << obj;
+
+			return *this;
+		}
+
 		const Count& count(const int index = 0) {
 			return counts[index];
 		}
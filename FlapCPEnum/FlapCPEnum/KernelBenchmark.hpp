@@ -0,0 +1,442 @@
+﻿#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "abbreviation.h"
+#include "BitArray.hpp"
+#include "BitSet.hpp"
+#include "CircularAlgorithm.hpp"
+#include "RingList.hpp"
+#include "FlapPattern.hpp"
+#include "IsFoldable.hpp"
+#include "StatsMaekawaTheorem.hpp"
+#include "FoldabilityBenchmark.hpp"
+#include "KawasakiFlapEnumeration.hpp"
+#include "FlapCPEnumeration.hpp"
+#include "ItemCountingStream.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		// one row of KernelBenchmark::writeCSV().
+		struct KernelTiming {
+			std::string benchmark;
+			std::string parameter;
+			unsigned long long operationCount;
+			double nanoSecPerOperation;
+		};
+
+		/**
+		 * Microbenchmarks of the enumeration kernels.
+		 * The inputs are the kawasaki flaps of placeCount places (sampled down to maxCorpusSize)
+		 * and random maekawa-valid assignments of them, with a fixed seed.
+		 * Each benchmark runs once for warm-up and then repeatCount times.
+		 */
+		class KernelBenchmark {
+			const u_int placeCount;
+			const u_int repeatCount;
+			const u_int sampleCount;
+			const unsigned seed;
+
+			std::vector<FlapPatternForBraceletEnum> corpus_;
+			// assignments of corpus_[i].
+			std::vector<std::vector<mylib::BitSet> > assignmentsList;
+
+			// avoids the calls to be optimized out.
+			unsigned long long checksum_ = 0;
+
+			struct FlapCollector {
+				std::vector<FlapPatternForBraceletEnum>& flaps;
+
+				FlapCollector(std::vector<FlapPatternForBraceletEnum>& flaps) : flaps(flaps) {}
+
+				FlapCollector& operator<<(const FlapPatternForBraceletEnum& flap) {
+					// the copy has the base point 0 as flaps sent to workers.
+					flaps.push_back(flap);
+					return *this;
+				}
+			};
+
+			// func() returns a value for the checksum.
+			template<typename TFunc>
+			KernelTiming measure(const std::string& benchmark, const std::string& parameter,
+				const unsigned long long operationCount, TFunc func) {
+				checksum_ += func();
+
+				auto start = std::chrono::steady_clock::now();
+				for (u_int r = 0; r < repeatCount; r++) {
+					checksum_ += func();
+				}
+				auto end = std::chrono::steady_clock::now();
+
+				KernelTiming timing;
+				timing.benchmark = benchmark;
+				timing.parameter = parameter;
+				timing.operationCount = operationCount * repeatCount;
+				const double nanoSec = std::chrono::duration<double, std::nano>(end - start).count();
+				timing.nanoSecPerOperation = (timing.operationCount == 0) ? 0.0 : nanoSec / timing.operationCount;
+				return timing;
+			}
+
+			std::string placeParameter() const {
+				return "n=" + std::to_string(placeCount);
+			}
+
+			unsigned long long assignmentCount() const {
+				unsigned long long count = 0;
+				for (const auto& assignments : assignmentsList) {
+					count += assignments.size();
+				}
+				return count;
+			}
+
+			template<typename TDetecter>
+			KernelTiming measureFoldability(const std::string& benchmark) {
+				std::vector<std::unique_ptr<TDetecter> > detecters;
+				for (const auto& flap : corpus_) {
+					detecters.emplace_back(new TDetecter(flap));
+				}
+
+				return measure(benchmark, placeParameter(), assignmentCount(), [&]() {
+					unsigned long long foldableCount = 0;
+					for (size_t i = 0; i < corpus_.size(); i++) {
+						for (const auto& assignments : assignmentsList[i]) {
+							foldableCount += detecters[i]->isAnswer(assignments) ? 1 : 0;
+						}
+					}
+					return foldableCount;
+				});
+			}
+
+			// the same path as EnumerationPipe in the count only mode.
+			template<template<typename TOStream, typename TSet_Assignment, bool needStats_> class TMVEnumeration, typename TFactory>
+			KernelTiming measureMVEnumeration(const std::string& name) {
+				typedef ItemCountingStream<> Counter;
+				typedef CountOnlyEncoder<Counter> Encoder;
+				TFactory factory;
+
+				return measure("mv_enumeration", name + "," + placeParameter(), corpus_.size(), [&]() {
+					Counter counter(placeCount / 2);
+					Encoder encoder(counter);
+					EnumerationPipe<Encoder, TMVEnumeration, mylib::BitSet, false> pipe(encoder, factory);
+					for (const auto& flap : corpus_) {
+						pipe << flap;
+					}
+					return counter.total();
+				});
+			}
+
+		public:
+			static const u_int DEFAULT_MAX_CORPUS_SIZE = 1000;
+
+			KernelBenchmark(const u_int placeCount, const u_int repeatCount = 8, const u_int sampleCount = 16,
+				const u_int maxCorpusSize = DEFAULT_MAX_CORPUS_SIZE, const unsigned seed = 1) :
+				placeCount(placeCount), repeatCount(repeatCount), sampleCount(sampleCount), seed(seed) {
+
+				std::vector<FlapPatternForBraceletEnum> flaps;
+				FlapCollector collector(flaps);
+				KawasakiFlapEnumeration<false> kawasaki;
+				kawasaki.enumerate(placeCount, collector);
+
+				const size_t stride = (flaps.size() + maxCorpusSize - 1) / std::max<u_int>(maxCorpusSize, 1);
+				for (size_t i = 0; i < flaps.size(); i += std::max<size_t>(stride, 1)) {
+					corpus_.push_back(flaps[i]);
+				}
+
+				FoldabilityBenchmark assignmentFactory(sampleCount, 1, seed);
+				for (const auto& flap : corpus_) {
+					assignmentsList.push_back(assignmentFactory.createAssignments(flap.count()));
+				}
+			}
+
+			const std::vector<FlapPatternForBraceletEnum>& corpus() const {
+				return corpus_;
+			}
+
+			const unsigned long long& checksum() const {
+				return checksum_;
+			}
+
+			// range operations, rotateToLower(), copies and operator& on arrays of placeCount, 128 and 512 bits.
+			// the ranges are not empty as BitArray requires.
+			std::vector<KernelTiming> measureBitArray() {
+				const u_int OPERATION_COUNT = 4096;
+				std::vector<KernelTiming> timings;
+
+				for (u_int length : { placeCount, 128u, 512u }) {
+					const std::string parameter = "bits=" + std::to_string(length);
+					mylib::BitArray bits(length);
+
+					std::mt19937 random(seed);
+					std::vector<std::pair<u_int, u_int> > ranges;
+					for (u_int i = 0; i < OPERATION_COUNT; i++) {
+						u_int from = random() % length, end = random() % length;
+						if (from > end) {
+							std::swap(from, end);
+						}
+						ranges.push_back(std::make_pair(from, end + 1));
+					}
+
+					timings.push_back(measure("bitarray_fill", parameter, 2 * OPERATION_COUNT, [&]() {
+						for (const auto& range : ranges) {
+							bits.fillOne(range.first, range.second);
+							bits.fillZero(range.first, range.first + (range.second - range.first + 1) / 2);
+						}
+						return (unsigned long long)bits.countOnes();
+					}));
+
+					timings.push_back(measure("bitarray_are_all", parameter, 2 * OPERATION_COUNT, [&]() {
+						unsigned long long count = 0;
+						for (const auto& range : ranges) {
+							count += bits.areAllOne(range.first, range.second) ? 1 : 0;
+							count += bits.areAllZero(range.first, range.second) ? 1 : 0;
+						}
+						return count;
+					}));
+
+					timings.push_back(measure("bitarray_rotate_to_lower", parameter, OPERATION_COUNT, [&]() {
+						for (const auto& range : ranges) {
+							bits.rotateToLower(range.first);
+						}
+						return (unsigned long long)bits.isOne(0);
+					}));
+
+					mylib::BitArray right(length);
+					bits.fillOne(0, length);
+					right.fillOne(length / 2, length);
+
+					timings.push_back(measure("bitarray_copy", parameter, OPERATION_COUNT, [&]() {
+						unsigned long long count = 0;
+						for (u_int i = 0; i < OPERATION_COUNT; i++) {
+							mylib::BitArray copied(bits);
+							count += copied.isOne(length - 1) ? 1 : 0;
+						}
+						return count;
+					}));
+
+					timings.push_back(measure("bitarray_copy_and_move", parameter, OPERATION_COUNT, [&]() {
+						unsigned long long count = 0;
+						for (u_int i = 0; i < OPERATION_COUNT; i++) {
+							mylib::BitArray copied(bits);
+							mylib::BitArray moved(std::move(copied));
+							count += moved.isOne(length - 1) ? 1 : 0;
+						}
+						return count;
+					}));
+
+					timings.push_back(measure("bitarray_and", parameter, OPERATION_COUNT, [&]() {
+						unsigned long long count = 0;
+						for (u_int i = 0; i < OPERATION_COUNT; i++) {
+							auto result = bits & right;
+							count += result.isOne(length - 1) ? 1 : 0;
+						}
+						return count;
+					}));
+
+					timings.push_back(measure("bitarray_and_assign", parameter, OPERATION_COUNT, [&]() {
+						mylib::BitArray accumulated(bits);
+						unsigned long long count = 0;
+						for (u_int i = 0; i < OPERATION_COUNT; i++) {
+							accumulated &= right;
+							count += accumulated.isOne(length - 1) ? 1 : 0;
+						}
+						return count;
+					}));
+
+					mylib::BitSet leftSet(length);
+					mylib::BitSet rightSet(length);
+					for (u_int i = 0; i < length; i += 2) {
+						leftSet.add(i);
+					}
+					for (u_int i = 0; i < length; i += 4) {
+						rightSet.add(i);
+					}
+
+					timings.push_back(measure("bitset_and", parameter, OPERATION_COUNT, [&]() {
+						unsigned long long count = 0;
+						for (u_int i = 0; i < OPERATION_COUNT; i++) {
+							auto result = leftSet & rightSet;
+							count += result.count();
+						}
+						return count;
+					}));
+				}
+
+				return timings;
+			}
+
+			// RingList against std::list, whose nodes are allocated one by one, on rings of 4, 32 and 128 items:
+			// fill, traverse 8 times and remove every other item. one operation is one ring.
+			std::vector<KernelTiming> measureRingList() {
+				const u_int RING_COUNT = 256;
+				const u_int TRAVERSE_COUNT = 8;
+				std::vector<KernelTiming> timings;
+
+				for (int size : { 4, 32, 128 }) {
+					const std::string parameter = "size=" + std::to_string(size);
+					mylib::RingList<int> ring(size);
+
+					timings.push_back(measure("ring_list", parameter, RING_COUNT, [&]() {
+						unsigned long long sum = 0;
+						for (u_int r = 0; r < RING_COUNT; r++) {
+							ring.clear();
+							for (int i = 0; i < size; i++) {
+								ring.add(i);
+							}
+							for (u_int t = 0; t < TRAVERSE_COUNT; t++) {
+								auto itr = ring.head();
+								for (u_int i = 0; i < ring.count(); i++, itr++) {
+									sum += *itr;
+								}
+							}
+							auto itr = ring.head();
+							for (int i = 0; i < size / 2; i++) {
+								itr.remove();
+								itr++;
+							}
+							sum += ring.count();
+						}
+						return sum;
+					}));
+
+					std::list<int> list;
+
+					timings.push_back(measure("std_list", parameter, RING_COUNT, [&]() {
+						unsigned long long sum = 0;
+						for (u_int r = 0; r < RING_COUNT; r++) {
+							list.clear();
+							for (int i = 0; i < size; i++) {
+								list.push_back(i);
+							}
+							for (u_int t = 0; t < TRAVERSE_COUNT; t++) {
+								for (auto item : list) {
+									sum += item;
+								}
+							}
+							auto itr = list.begin();
+							for (int i = 0; i < size / 2; i++) {
+								itr = list.erase(itr);
+								itr++;
+							}
+							sum += list.size();
+						}
+						return sum;
+					}));
+				}
+
+				return timings;
+			}
+
+			// knownModificationExists() with the rotation and mirror inverters of each flap.
+			std::vector<KernelTiming> measureDuplication() {
+				std::vector<std::unique_ptr<FlapContext> > contexts;
+				std::vector<std::unique_ptr<MVSymmetryDetecter<mylib::BitSet> > > detecters;
+				for (const auto& flap : corpus_) {
+					contexts.emplace_back(new FlapContext(flap));
+					detecters.emplace_back(new MVSymmetryDetecter<mylib::BitSet>(*contexts.back()));
+				}
+
+				return { measure("duplication_has_generated", placeParameter(), assignmentCount(), [&]() {
+					unsigned long long duplicationCount = 0;
+					for (size_t i = 0; i < corpus_.size(); i++) {
+						const int lineCount = corpus_[i].count();
+						for (const auto& assignments : assignmentsList[i]) {
+							duplicationCount += detecters[i]->hasGenerated(assignments, lineCount, lineCount / 2) ? 1 : 0;
+						}
+					}
+					return duplicationCount;
+				}) };
+			}
+
+			std::vector<KernelTiming> measureFoldability() {
+				return {
+					measureFoldability<IsFoldable<mylib::BitSet> >("is_foldable"),
+					measureFoldability<IsFoldableLinear<mylib::BitSet> >("is_foldable_linear")
+				};
+			}
+
+			// on the gap sequences of the flaps.
+			std::vector<KernelTiming> measureCircular() {
+				std::vector<std::vector<int> > gapsList;
+				for (const auto& flap : corpus_) {
+					std::vector<int> gaps;
+					u_int previous = flap.findNext(0);
+					for (u_int i = flap.findNext(previous + 1); i < placeCount; i = flap.findNext(i + 1)) {
+						gaps.push_back(i - previous);
+						previous = i;
+					}
+					gaps.push_back(placeCount - previous + flap.findNext(0));
+					gapsList.push_back(gaps);
+				}
+
+				mylib::CircularAlgorithm<int> circular;
+				return { measure("least_circular", placeParameter(), gapsList.size(), [&]() {
+					unsigned long long indexSum = 0;
+					for (const auto& gaps : gapsList) {
+						indexSum += circular.findFirstIndexOfLeastCircular(gaps);
+					}
+					return indexSum;
+				}) };
+			}
+
+			// BinaryBraceletEnumeration with kawasaki pruning. one operation is one flap.
+			std::vector<KernelTiming> measureBracelet() {
+				struct FlapCounter {
+					unsigned long long count = 0;
+
+					FlapCounter& operator<<(const FlapPatternForBraceletEnum&) {
+						count++;
+						return *this;
+					}
+				};
+
+				FlapCounter expected;
+				KawasakiFlapEnumeration<false>().enumerate(placeCount, expected);
+
+				return { measure("kawasaki_bracelet", placeParameter(), expected.count, [&]() {
+					FlapCounter counter;
+					KawasakiFlapEnumeration<false>().enumerate(placeCount, counter);
+					return counter.count;
+				}) };
+			}
+
+			// one operation is one flap of the corpus.
+			std::vector<KernelTiming> measureMVEnumerations() {
+				return {
+					measureMVEnumeration<MVEnumeration, FoldabilityDetecterFactory<mylib::BitSet> >("MVEnumeration"),
+					measureMVEnumeration<MVLSLEnumeration, FoldabilityDetecterFactory<mylib::BitSet> >("MVLSLEnumeration"),
+					measureMVEnumeration<ExtendedMVLSLEnumeration, FoldabilityDetecterFactory<mylib::BitSet> >("ExtendedMVLSLEnumeration"),
+					measureMVEnumeration<RevolvingDoorMVEnumeration, FoldabilityDetecterFactory<mylib::BitSet> >("RevolvingDoorMVEnumeration"),
+					measureMVEnumeration<LinearMVEnumeration, FoldabilityDetecterFactory<mylib::BitSet> >("LinearMVEnumeration"),
+					measureMVEnumeration<TrieLinearMVEnumeration, FoldabilityDetecterFactory<mylib::BitSet> >("TrieLinearMVEnumeration"),
+					measureMVEnumeration<CrimpPruningMVEnumeration, MaekawaTheoremFactory<mylib::BitSet> >("CrimpPruningMVEnumeration"),
+					measureMVEnumeration<BatchFoldableMVEnumeration, MaekawaTheoremFactory<mylib::BitSet> >("BatchFoldableMVEnumeration")
+				};
+			}
+
+			std::vector<KernelTiming> measureAll() {
+				std::vector<KernelTiming> timings;
+				for (const auto& group : { measureBitArray(), measureRingList(), measureDuplication(), measureFoldability(),
+					measureCircular(), measureBracelet(), measureMVEnumerations() }) {
+					timings.insert(timings.end(), group.begin(), group.end());
+				}
+				return timings;
+			}
+
+			// the header and the column order are kept for scripts.
+			static void writeCSV(std::ostream& os, const std::vector<KernelTiming>& timings) {
+				os << "benchmark,parameter,operations,ns_per_op" << std::endl;
+				for (const auto& timing : timings) {
+					os << timing.benchmark << ",\"" << timing.parameter << "\"," << timing.operationCount << ","
+						<< timing.nanoSecPerOperation << std::endl;
+				}
+			}
+		};
+	}
+}
@@ -6,8 +6,12 @@
 #include "FlapPattern.hpp"
 #include "CircularAlgorithm.hpp"
 #include <cstdlib>
-#include <unordered_set>
+#include <limits>
+#include <memory>
+#include "FingerprintSet.hpp"
 #include "Trie.hpp"
+#include "RevolvingDoorCombination.hpp"
+#include "PhaseTimer.hpp"
 
 namespace enumeration {
 	namespace origami {
@@ -143,19 +147,11 @@ namespace enumeration {
 
 				FlapPatternString circularString(lineCount);
 
-				int lastLineIndex = 0;
-				int baseLineIndex = 0;
+				const u_int baseLineIndex = flap.findNext(0);
+				u_int lastLineIndex = baseLineIndex;
 				int shrinkedIndex = 0;
-				while (!flap.contains(baseLineIndex)) baseLineIndex++;
-
-				lastLineIndex = baseLineIndex;
-
-				for (u_int i = 0; i < placeCount; i++) {
-					auto index = (i + baseLineIndex + 1) % placeCount;
-
-					if (!flap.contains(index))
-						continue;
 
+				auto append = [&](const u_int index) {
 					circularString.setLineType(shrinkedIndex, FlapPatternString::MAJOR);
 
 					auto angle = (placeCount + index - lastLineIndex) % placeCount;
@@ -163,7 +159,13 @@ namespace enumeration {
 
 					shrinkedIndex++;
 					lastLineIndex = index;
+				};
+
+				// lines after the base, then the base itself to close the circle.
+				for (u_int index = flap.findNext(baseLineIndex + 1); index < placeCount; index = flap.findNext(index + 1)) {
+					append(index);
 				}
+				append(baseLineIndex);
 
 				using namespace std;
 				//cout << "create circular string: " << circularString.toString() << endl;
@@ -172,24 +174,6 @@ namespace enumeration {
 			}
 		};
 
-		template<typename TOStream, typename TSet_Assignment, bool needStats = true>
-		class IMVEnumeration {
-
-		public:
-
-			virtual const mylib::EnumerationStats& mvStats() = 0;
-
-			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os,
-				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
-				const mylib::IPruningSuggester<TSet_Assignment>& pruning) = 0;
-
-
-			// enumerates patterns satisfying maekawa theorem.
-			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os) = 0;
-		};
-
-
-
 		// key:   {0, 1, 2, ..., k}
 		// value: items in the given set in increasing order.
 		//        if i < j then map[i] < map[j]
@@ -198,20 +182,29 @@ namespace enumeration {
 			// return : a map from shrinked index to original index.
 			template<typename TSet_Assignment>
 			mylib::SharedArrayPointer<u_int> create(const TSet_Assignment& original) {
-				auto placeCount = original.capacity();
-				auto lineCount = original.count();
+				mylib::SharedArrayPointer<u_int> map(original.count());
+				fill(original, map);
+				return map;
+			}
+
+			// the map is on the arena.
+			template<typename TSet_Assignment>
+			mylib::SharedArrayPointer<u_int> create(const TSet_Assignment& original, mylib::MonotonicArena& arena) {
+				mylib::SharedArrayPointer<u_int> map(original.count(), arena);
+				fill(original, map);
+				return map;
+			}
 
-				mylib::SharedArrayPointer<u_int> map(lineCount);
+		private:
+			template<typename TSet_Assignment>
+			void fill(const TSet_Assignment& original, mylib::SharedArrayPointer<u_int>& map) {
+				auto placeCount = original.capacity();
 
 				u_int keyIndex = 0;
-				for (u_int i = 0; i < placeCount; i++) {
-					if (original.contains(i)) {
-						map[keyIndex] = i;
-						keyIndex++;
-					}
+				for (u_int i = original.findNext(0); i < placeCount; i = original.findNext(i + 1)) {
+					map[keyIndex] = i;
+					keyIndex++;
 				}
-
-				return map;
 			}
 		};
 
@@ -236,87 +229,286 @@ namespace enumeration {
 
 			}
 
+			// nodes of lineCount / 2 minor lines are visited but not expanded.
+			virtual int maxDepth(const int lineCount) const {
+				return lineCount / 2;
+			}
+
 		};
 
 
-		template<typename TSet_Assignment>
-		class MVSymmetryDetecter : public ppc::AbstractDuplicationDetecter<TSet_Assignment> {
-			typedef enumeration::circular::RotationInverter RotationInverter;
-			typedef enumeration::circular::MirrorInverter MirrorInverter;
-			typedef enumeration::circular::MiddleMirrorInverter MiddleMirrorInverter;
+		// Per-flap data shared by the MV enumeration, the symmetry detecter and the foldability detecter.
+		// Everything is computed once in the constructor and never modified,
+		// except the inverters: they are built on the first use since only the symmetry detecter needs them.
+		// A context is not shared among threads.
+		// The flap must outlive the context.
+		//
+		// Given an arena, the maps and the vectors are allocated on it;
+		// the context and every copy of its maps should be released before the arena is reset.
+		class FlapContext {
+		public:
+			typedef enumeration::MappedIndexInverter<enumeration::circular::RotationInverter> MappedRotInverter;
+			typedef enumeration::MappedIndexInverter<enumeration::circular::MirrorInverter> MappedMirInverter;
+			typedef enumeration::MappedIndexInverter<enumeration::circular::MiddleMirrorInverter> MappedMidMirInverter;
+
+			typedef std::vector<u_int, mylib::ArenaAllocator<u_int> > AngleVector;
+			typedef std::vector<std::pair<int, int>, mylib::ArenaAllocator<std::pair<int, int> > > IntervalVector;
+			typedef std::vector<MappedRotInverter, mylib::ArenaAllocator<MappedRotInverter> > RotInverterVector;
+			typedef std::vector<MappedMirInverter, mylib::ArenaAllocator<MappedMirInverter> > MirInverterVector;
+			typedef std::vector<MappedMidMirInverter, mylib::ArenaAllocator<MappedMidMirInverter> > MidMirInverterVector;
+
+		private:
+			const EncodablePatternBase& flap_;
+			const u_int placeCount_;
+			const u_int lineCount_;
+
+			mylib::SharedArrayPointer<u_int> lineMap_;
+			mylib::SharedArrayPointer<u_int> reverseMap_;
+
+			FlapPatternString circularString_;
+			AngleVector angles_;
+			IntervalVector equalAngleIntervals_;
+
+			mutable bool invertersBuilt_;
+			mutable RotInverterVector rotInverters_;
+			mutable MirInverterVector mirrorInverters_;
+			mutable MidMirInverterVector midMirrorInverters_;
+
+			void buildReverseMap() {
+				std::fill_n(reverseMap_.getRawArray(), placeCount_, std::numeric_limits<u_int>::max());
+				for (u_int i = 0; i < lineCount_; i++) {
+					reverseMap_[lineMap_[i]] = i;
+				}
+			}
+
+			void buildAngles() {
+				angles_.resize(lineCount_);
+				for (u_int i = 0; i < lineCount_; i++) {
+					angles_[i] = (placeCount_ + lineMap_[(i + 1) % lineCount_] - lineMap_[i]) % placeCount_;
+				}
+			}
 
-			typedef enumeration::MappedIndexInverter<RotationInverter> MappedRotInverter;
-			typedef enumeration::MappedIndexInverter<MirrorInverter> MappedMirInverter;
-			typedef enumeration::MappedIndexInverter<MiddleMirrorInverter> MappedMidMirInverter;
+			// interval[i] = <begin() of equal angle interval, end() of equal angle interval> where i belongs to.
+			void buildEqualAngleIntervals() {
+				const int lineCount = lineCount_;
+				const auto& circularString = circularString_;
 
-			std::vector<MappedRotInverter> rotInverters;
-			std::vector<MappedMirInverter > mirrorInverters;
-			std::vector<MappedMidMirInverter > midMirrorInverters;
+				equalAngleIntervals_.assign(lineCount, std::make_pair(0, -1));
 
-			// map mountains -> flap
-			mylib::SharedArrayPointer<u_int> map;
-			const u_int placeCount;
-			const u_int lineCount;
+				for (int i = 0; i < lineCount; i++) {
+					if (circularString.getAngle(i - 1) <= circularString.getAngle(i)) {
+						continue;
+					}
+					int j = i + 1;
+					for (; j < lineCount; j++) {
+						if (circularString.getAngle(j - 1) != circularString.getAngle(j)) {
+							break;
+						}
+					}
+					if (circularString.getAngle(j) > circularString.getAngle(j - 1)) {
+						// the interval may wrap around to line 0; only the lines up to the last one get it.
+						const auto interval = std::make_pair(i, j + 1);
+						for (int cand = interval.first; cand < std::min(interval.second, lineCount); cand++) {
+							equalAngleIntervals_[cand] = interval;
+						}
+					}
+				}
+			}
 
 			// selects meaningful inverters.
-			void buildInverters(const EncodablePatternBase& flap) {
+			// each kind has at most lineCount inverters since they map line 0 to distinct lines.
+			void buildInverters() const {
+				using namespace enumeration::circular;
 
-				for (u_int i = 1; i < placeCount; i++) {
-					RotationInverter rotInv(i, placeCount);
-					testAndAddMappedInverter(rotInv, rotInverters);
+				if (invertersBuilt_) {
+					return;
 				}
+				invertersBuilt_ = true;
 
-				for (u_int i = 1; i < placeCount / 2 + 1; i++) {
-					MirrorInverter mirrorInv(i, placeCount);
-					testAndAddMappedInverter(mirrorInv, mirrorInverters);
+				rotInverters_.reserve(lineCount_);
+				mirrorInverters_.reserve(lineCount_);
+				midMirrorInverters_.reserve(lineCount_);
+
+				for (u_int i = 1; i < placeCount_; i++) {
+					testAndAddMappedInverter(RotationInverter(i, placeCount_), rotInverters_);
+				}
 
-					MiddleMirrorInverter midMirrorInv(i - 1, placeCount);
-					testAndAddMappedInverter(midMirrorInv, midMirrorInverters);
+				for (u_int i = 1; i < placeCount_ / 2 + 1; i++) {
+					testAndAddMappedInverter(MirrorInverter(i, placeCount_), mirrorInverters_);
+					testAndAddMappedInverter(MiddleMirrorInverter(i - 1, placeCount_), midMirrorInverters_);
 				}
 			}
 
 			template <typename TInverter, typename TVector>
-			inline void testAndAddMappedInverter(const TInverter& inv, TVector& inverters) {
-				enumeration::MappedIndexInverter<TInverter> mappedInv(inv, placeCount, map, lineCount);
+			inline void testAndAddMappedInverter(const TInverter& inv, TVector& inverters) const {
+				enumeration::MappedIndexInverter<TInverter> mappedInv(inv, placeCount_, lineMap_, reverseMap_, lineCount_);
 				if (mappedInv.canInvert()) {
 					inverters.push_back(mappedInv);
 				}
 			}
 
-		public:
-			MVSymmetryDetecter(const EncodablePatternBase& flap) : lineCount(flap.count()), placeCount(flap.capacity()) {
+			FlapContext(const EncodablePatternBase& flap, mylib::MonotonicArena* arena) :
+				flap_(flap), placeCount_(flap.capacity()), lineCount_(flap.count()),
+				circularString_(FlapPatternStringFactory().createCircularString(flap)),
+				angles_(arena), equalAngleIntervals_(arena),
+				invertersBuilt_(false), rotInverters_(arena), mirrorInverters_(arena), midMirrorInverters_(arena) {
+
 				LineIndexMapFactory mapFactory;
-				map = mapFactory.create(flap);
-				buildInverters(flap);
+				if (arena != NULL) {
+					lineMap_ = mapFactory.create(flap, *arena);
+					reverseMap_ = mylib::SharedArrayPointer<u_int>(placeCount_, *arena);
+				}
+				else {
+					lineMap_ = mapFactory.create(flap);
+					reverseMap_ = mylib::SharedArrayPointer<u_int>(placeCount_);
+				}
+
+				buildReverseMap();
+				buildAngles();
+				buildEqualAngleIntervals();
+			}
+
+		public:
+			explicit FlapContext(const EncodablePatternBase& flap) : FlapContext(flap, NULL) {
+			}
+
+			FlapContext(const EncodablePatternBase& flap, mylib::MonotonicArena& arena) : FlapContext(flap, &arena) {
+			}
+
+			FlapContext(const FlapContext&) = delete;
+			FlapContext& operator=(const FlapContext&) = delete;
+
+			const EncodablePatternBase& flap() const {
+				return flap_;
+			}
+
+			const u_int& placeCount() const {
+				return placeCount_;
+			}
+
+			const u_int& lineCount() const {
+				return lineCount_;
+			}
+
+			// line index -> place
+			const mylib::SharedArrayPointer<u_int>& lineMap() const {
+				return lineMap_;
+			}
+
+			// place -> line index, or max of u_int if the place has no line.
+			const mylib::SharedArrayPointer<u_int>& reverseMap() const {
+				return reverseMap_;
+			}
+
+			// line types are MAJOR. copy it to assign lines.
+			const FlapPatternString& circularString() const {
+				return circularString_;
+			}
+
+			// angles()[i]: gap between line i and line i + 1.
+			const AngleVector& angles() const {
+				return angles_;
+			}
+
+			const IntervalVector& equalAngleIntervals() const {
+				return equalAngleIntervals_;
+			}
+
+			// symmetries of the flap as permutations of line indices.
+			const RotInverterVector& rotationInverters() const {
+				buildInverters();
+				return rotInverters_;
+			}
+
+			const MirInverterVector& mirrorInverters() const {
+				buildInverters();
+				return mirrorInverters_;
+			}
+
+			const MidMirInverterVector& middleMirrorInverters() const {
+				buildInverters();
+				return midMirrorInverters_;
+			}
+		};
+
+		template<typename TOStream, typename TSet_Assignment, bool needStats = true>
+		class IMVEnumeration {
+
+		public:
+
+			virtual const mylib::EnumerationStats& mvStats() = 0;
+
+			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning) = 0;
+
+
+			// enumerates patterns satisfying maekawa theorem.
+			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os) = 0;
+
+			// the same as enumerate(context.flap(), ...) but reuses the per-flap data of the context.
+			// the default ignores the context.
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning) {
+				return enumerate(context.flap(), os, ansDetecter, pruning);
+			}
+
+			// the same as above but checks duplication with the given detecter of the context's symmetry,
+			// so that the caller can wrap it. the default ignores the detecter.
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning,
+				ppc::AbstractDuplicationDetecter<TSet_Assignment>&) {
+				return enumerateInContext(context, os, ansDetecter, pruning);
+			}
+		};
+
+
+		template<typename TSet_Assignment>
+		class MVSymmetryDetecter : public ppc::AbstractDuplicationDetecter<TSet_Assignment> {
+			// null if the context is given.
+			std::unique_ptr<const FlapContext> ownedContext;
+			const FlapContext& context;
+
+		public:
+			MVSymmetryDetecter(const EncodablePatternBase& flap) : ownedContext(new FlapContext(flap)), context(*ownedContext) {
+			}
+
+			MVSymmetryDetecter(const FlapContext& context) : context(context) {
 			}
 
 			virtual ~MVSymmetryDetecter() {
 			}
 
 			inline virtual bool hasGenerated(const TSet_Assignment& pattern, const int elemEnd, const int prefixTail) const {
-				if (this->knownModificationExistsFor(pattern, elemEnd, prefixTail, rotInverters)) {
+				if (this->knownModificationExistsFor(pattern, elemEnd, prefixTail, context.rotationInverters())) {
 					return true;
 				}
 
-				if (this->knownModificationExistsFor(pattern, elemEnd, prefixTail, mirrorInverters)) {
+				if (this->knownModificationExistsFor(pattern, elemEnd, prefixTail, context.mirrorInverters())) {
 					return true;
 				}
 
-				if (this->knownModificationExistsFor(pattern, elemEnd, prefixTail, midMirrorInverters)) {
+				if (this->knownModificationExistsFor(pattern, elemEnd, prefixTail, context.middleMirrorInverters())) {
 					return true;
 				}
 
 				return false;
 			}
 
-			std::vector<enumeration::IInverter*> createInverterReferences() {
+			std::vector<const enumeration::IInverter*> createInverterReferences() const {
 				using namespace std;
 
-				vector<enumeration::IInverter*> references;
+				const auto& rotInverters = context.rotationInverters();
+				const auto& mirrorInverters = context.mirrorInverters();
+				const auto& midMirrorInverters = context.middleMirrorInverters();
+
+				vector<const enumeration::IInverter*> references;
 				references.reserve(rotInverters.size() + mirrorInverters.size() + midMirrorInverters.size());
 
-				auto refCopy = [&](auto& inverters) {
-					for (auto& inv : inverters) {
+				auto refCopy = [&](const auto& inverters) {
+					for (const auto& inv : inverters) {
 						references.push_back(&inv);
 					}
 				};
@@ -417,17 +609,31 @@ namespace enumeration {
 				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
 				const mylib::IPruningSuggester<TSet_Assignment>& pruning = MaekawaPruning<TSet_Assignment>()) {
 
-				MVSymmetryDetecter<TSet_Assignment> symmDetecter(flap);
+				FlapContext context(flap);
+				return enumerateInContext(context, os, ansDetecter, pruning);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning) {
+
+				MVSymmetryDetecter<TSet_Assignment> symmDetecter(context);
+				return enumerateInContext(context, os, ansDetecter, pruning, symmDetecter);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning,
+				ppc::AbstractDuplicationDetecter<TSet_Assignment>& duplication) {
+
 				ppc::PPCSearchTool<TSet_Assignment> tool;
 
-				tool.setDuplication(symmDetecter);
+				tool.setDuplication(duplication);
 				tool.setAnswer(ansDetecter);
 				tool.setPruning(pruning);
 
-				const int lineCount = flap.count();
-
-				FlapPatternStringFactory stringFactory;
-				auto circularString = stringFactory.createCircularString(flap);
+				const int lineCount = context.lineCount();
+				auto circularString = context.circularString();
 
 				TSet_Assignment seed(lineCount);
 
@@ -457,11 +663,11 @@ namespace enumeration {
 			class Implementation {
 				mylib::EnumerationStats stats_;
 				const ppc::PPCSearchTool<TSet_Assignment>& tool;
-				const std::vector<std::pair<int, int> >& equalAngleIntervals;
+				const FlapContext::IntervalVector& equalAngleIntervals;
 
 			public:
 				Implementation(
-					const ppc::PPCSearchTool<TSet_Assignment>& tool, const std::vector<std::pair<int, int> >& intervals)
+					const ppc::PPCSearchTool<TSet_Assignment>& tool, const FlapContext::IntervalVector& intervals)
 					:tool(tool), equalAngleIntervals(intervals)
 				{}
 
@@ -535,33 +741,6 @@ namespace enumeration {
 
 			};
 
-			// returnedHash[i] = <begin() of equal angle interval, end() of equal angle interval> where i belongs to. 
-			std::vector<std::pair<int, int> > createEqualAngleIntervalHash(
-				const FlapPatternString& circularString, const int lineCount) {
-
-				std::vector<std::pair<int, int> > intervalHash(lineCount, std::make_pair(0,-1));
-
-				for (int i = 0; i < lineCount; i++) {
-					if (circularString.getAngle(i - 1) <= circularString.getAngle(i)) {
-						continue;
-					}
-					int j = i + 1;
-					for (; j < lineCount; j++) {
-						if (circularString.getAngle(j - 1) != circularString.getAngle(j)) {
-							break;
-						}
-					}
-					if (circularString.getAngle(j) > circularString.getAngle(j - 1)) {
-						const auto interval = std::make_pair(i, j + 1);
-						for (int cand = interval.first; cand < interval.second; cand++) {
-							intervalHash[cand] = interval;
-						}
-					}
-				}
-
-				return intervalHash;
-			}
-
 		public:
 			ExtendedMVLSLEnumeration() {}
 
@@ -573,23 +752,35 @@ namespace enumeration {
 				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
 				const mylib::IPruningSuggester<TSet_Assignment>& pruning = MaekawaPruning<TSet_Assignment>()) {
 
-				MVSymmetryDetecter<TSet_Assignment> symmDetecter(flap);
+				FlapContext context(flap);
+				return enumerateInContext(context, os, ansDetecter, pruning);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning) {
+
+				MVSymmetryDetecter<TSet_Assignment> symmDetecter(context);
+				return enumerateInContext(context, os, ansDetecter, pruning, symmDetecter);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning,
+				ppc::AbstractDuplicationDetecter<TSet_Assignment>& duplication) {
+
 				ppc::PPCSearchTool<TSet_Assignment> tool;
 
-				tool.setDuplication(symmDetecter);
+				tool.setDuplication(duplication);
 				tool.setAnswer(ansDetecter);
 				tool.setPruning(pruning);
 
-				const int lineCount = flap.count();
-
-				FlapPatternStringFactory stringFactory;
-				auto circularString = stringFactory.createCircularString(flap);
-
-				auto eqAngleIntervals = createEqualAngleIntervalHash(circularString, lineCount);
+				const int lineCount = context.lineCount();
+				auto circularString = context.circularString();
 
 				TSet_Assignment seed(lineCount);
 
-				Implementation search(tool, eqAngleIntervals);
+				Implementation search(tool, context.equalAngleIntervals());
 
 				search.enumerate(circularString, seed, 0, lineCount, -1, 0, os);
 
@@ -622,14 +813,30 @@ namespace enumeration {
 				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
 				const mylib::IPruningSuggester<TSet_Assignment>& pruning = MaekawaPruning<TSet_Assignment>()) {
 
-				MVSymmetryDetecter<TSet_Assignment> symmDetecter(flap);
+				FlapContext context(flap);
+				return enumerateInContext(context, os, ansDetecter, pruning);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning) {
+
+				MVSymmetryDetecter<TSet_Assignment> symmDetecter(context);
+				return enumerateInContext(context, os, ansDetecter, pruning, symmDetecter);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning,
+				ppc::AbstractDuplicationDetecter<TSet_Assignment>& duplication) {
+
 				ppc::PPCSearchTool<TSet_Assignment> tool;
 
-				tool.setDuplication(symmDetecter);
+				tool.setDuplication(duplication);
 				tool.setAnswer(ansDetecter);
 				tool.setPruning(pruning);
 
-				const int lineCount = flap.count();
+				const int lineCount = context.lineCount();
 				TSet_Assignment seed(lineCount);
 				ppc::ExtendedPPCSearch<TSet_Assignment, TOStream, needStats> search(os, tool);
 
@@ -649,44 +856,218 @@ namespace enumeration {
 
 //-----------------------------------------------------------------------------------------------------------------------------
 
-		// cache uses too much memory.
+		// Enumerates the same patterns as MVEnumeration without a search tree:
+		// assignments with lineCount/2-1 minors are visited in revolving-door order,
+		// where consecutive assignments differ by one swap.
+		//
+		// Symmetry is tested on the whole assignment by the PPC order (see knownModificationExists()).
+		// The images of the assignment by the inverters are kept as bit masks and updated by each swap,
+		// so the test costs O(#inverters) word operations per assignment.
+		//
+		// Up to 64 lines are supported. pruning is ignored since every assignment satisfies maekawa theorem.
 		template<typename TOStream, typename TSet_Assignment, bool needStats = true>
-		class LinearMVEnumeration : public IMVEnumeration<TOStream, TSet_Assignment, needStats> {
+		class RevolvingDoorMVEnumeration : public IMVEnumeration<TOStream, TSet_Assignment, needStats> {
+			typedef unsigned long long LineBits;
+
 			mylib::EnumerationStats stats;
 
+			// toggledIndices[k][a]: the index toggled in the k-th image when line a is toggled in the assignment.
+			std::vector<std::vector<u_int> > toggledIndices;
+			std::vector<LineBits> images;
+
+			static LineBits bitOf(const u_int& index) {
+				return 1ULL << index;
+			}
+
+			// image = {m | inverter(m) is in the assignment}
+			void buildToggledIndices(const std::vector<const enumeration::IInverter*>& inverters, const u_int& lineCount) {
+				toggledIndices.assign(inverters.size(), std::vector<u_int>(lineCount));
+
+				for (u_int k = 0; k < inverters.size(); k++) {
+					for (u_int m = 0; m < lineCount; m++) {
+						toggledIndices[k][(*inverters[k])(m)] = m;
+					}
+				}
+			}
+
+			inline void toggle(LineBits& assignmentBits, const u_int& index) {
+				assignmentBits ^= bitOf(index);
+				for (u_int k = 0; k < images.size(); k++) {
+					images[k] ^= bitOf(toggledIndices[k][index]);
+				}
+			}
+
+			// the assignment is canonical if it has the first difference from every image.
+			inline bool isCanonical(const LineBits& assignmentBits) const {
+				for (const auto& image : images) {
+					const LineBits diff = assignmentBits ^ image;
+					const LineBits firstDiff = diff & (~diff + 1);
+
+					if ((assignmentBits & firstDiff) != firstDiff) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			inline void visit(const LineBits& assignmentBits, const TSet_Assignment& assignments,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter, TOStream& os) {
+
+				if (needStats)
+					stats.callCount++;
+
+				if (!isCanonical(assignmentBits))
+					return;
+
+				if (needStats)
+					stats.validCallCount++;
+
+				if (ansDetecter.isAnswer(assignments)) {
+					if (needStats)
+						stats.answerCount++;
+
+					os << assignments;
+				}
+			}
+
+		public:
+			RevolvingDoorMVEnumeration() {}
+
+			virtual const mylib::EnumerationStats& mvStats() {
+				return stats;
+			}
+
+			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning = MaekawaPruning<TSet_Assignment>()) {
+
+				FlapContext context(flap);
+				return enumerateInContext(context, os, ansDetecter, pruning);
+			}
+
+			// every combination satisfies maekawa theorem, so no pruning is needed.
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>&) {
+
+				const u_int lineCount = context.lineCount();
+				if (lineCount > 8 * sizeof(LineBits)) {
+					throw std::invalid_argument("RevolvingDoorMVEnumeration: too many lines.");
+				}
+
+				stats.clear();
+
+				MVSymmetryDetecter<TSet_Assignment> symmDetecter(context);
+				buildToggledIndices(symmDetecter.createInverterReferences(), lineCount);
+				images.assign(toggledIndices.size(), 0ULL);
+
+				const int minorCount = lineCount / 2 - 1;
+				mylib::RevolvingDoorCombination combination(lineCount, minorCount);
+
+				TSet_Assignment assignments(lineCount);
+				LineBits assignmentBits = 0ULL;
+
+				for (int i = 0; i < minorCount; i++) {
+					assignments.add(combination.items()[i]);
+					toggle(assignmentBits, combination.items()[i]);
+				}
+
+				visit(assignmentBits, assignments, ansDetecter, os);
+
+				while (combination.next()) {
+					const auto& removed = combination.removedItem();
+					const auto& added = combination.addedItem();
+
+					assignments.remove(removed);
+					assignments.add(added);
+					toggle(assignmentBits, removed);
+					toggle(assignmentBits, added);
+
+					visit(assignmentBits, assignments, ansDetecter, os);
+				}
+
+				return stats;
+			}
+
+			virtual mylib::EnumerationStats enumerate(const EncodablePatternBase& flap, TOStream& os) {
+				MaekawaTheorem<TSet_Assignment> ansDetecter;
+
+				return this->enumerate(flap, os, ansDetecter);
+			}
+		};
+
+//-----------------------------------------------------------------------------------------------------------------------------
+
+		// Detects duplication by a cache of canonical strings of visited nodes.
+		// The cache holds the strings under a memory limit.
+		// If the search tree of a flap may not fit in the limit, the flap falls back to
+		// the PPC duplication check (the same as MVLSLEnumeration).
+		// Evicting strings is not allowed because it yields duplicated answers.
+		//
+		// TCache: FingerprintSet<> or ArenaPatriciaTrie.
+		template<typename TOStream, typename TSet_Assignment, bool needStats, typename TCache>
+		class CachedLinearMVEnumeration : public IMVEnumeration<TOStream, TSet_Assignment, needStats> {
+			mylib::EnumerationStats stats;
+			TCache cache;
+			unsigned long long ppcFallbackCount_ = 0ULL;
+
+			// fingerprints have a fixed width, so only the trie depends on the key length.
+			static bool canHold(const mylib::FingerprintSet<>& cache, const size_t keyCount, const size_t) {
+				return cache.canHold(keyCount);
+			}
+
+			static bool canHold(const mylib::ArenaPatriciaTrie& cache, const size_t keyCount, const size_t keyLength) {
+				return cache.canHold(keyCount, keyLength);
+			}
+
 			class Implementation {
 				mylib::EnumerationStats stats_;
 				mylib::CircularAlgorithm<char> circularAlgorithm;
-				mylib::Trie cache;
-				//mylib::PatriciaTrie cache;
 
 				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter;
 				const mylib::IPruningSuggester<TSet_Assignment>& pruning;
 
 				std::string canonicalTemporary;
+				TCache& cache;
+
+				// NULL if the cache is used.
+				const ppc::AbstractDuplicationDetecter<TSet_Assignment>* ppcDuplication;
+
+				bool hasGenerated(const FlapPatternString& circularString, const TSet_Assignment& assignments,
+					const int& candBegin, const int& prefixTail) {
+
+					if (ppcDuplication != NULL) {
+						return ppcDuplication->hasGenerated(assignments, candBegin, prefixTail);
+					}
+
+					circularAlgorithm.createCanonicalOnSymmetry(
+						circularString, canonicalTemporary, canonicalTemporary.size());
+
+					// false if already exists.
+					return !cache.insert(canonicalTemporary);
+				}
 
 			public:
 				Implementation(
 					mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
 					const mylib::IPruningSuggester<TSet_Assignment>& pruning,
-					const int& length, const int& maxAlphabet)
+					TCache& cache,
+					const ppc::AbstractDuplicationDetecter<TSet_Assignment>* ppcDuplication,
+					const int& length)
 					:ansDetecter(ansDetecter), pruning(pruning), canonicalTemporary(length, 0), 
-					cache(maxAlphabet + 1 + 2, -2)
+					cache(cache), ppcDuplication(ppcDuplication)
 				{}
 
 				void enumerate(FlapPatternString& circularString, TSet_Assignment& assignments,
-					const int& candBegin, const int& candEnd, 
+					const int& candBegin, const int& candEnd, const int& prefixTail,
 					const int& depth, TOStream& os) {
 
 					using namespace std;
 					//cout << "enumerate: " << circularString.toString() << endl;
 
-					circularAlgorithm.createCanonicalOnSymmetry(
-						circularString, canonicalTemporary, canonicalTemporary.size());
-					if (cache.contains(canonicalTemporary)) {
+					if (hasGenerated(circularString, assignments, candBegin, prefixTail)) {
 						return;
 					}
-					cache.insert(canonicalTemporary);
 
 					if (pruning.needPruning(assignments, depth)) {
 						return;
@@ -704,6 +1085,8 @@ namespace enumeration {
 						return;
 					}
 
+					auto nextPrefixTail = candBegin - 1;
+
 					for (int cand = candBegin; cand < candEnd; cand++) {
 						// Large-Small-Large theorem
 						auto prev = cand - 1;
@@ -722,7 +1105,7 @@ namespace enumeration {
 						circularString.setLineType(cand, FlapPatternString::MINOR);
 							
 						enumerate(circularString, assignments, cand + 1, candEnd,
-						depth + 1, os);
+							nextPrefixTail, depth + 1, os);
 
 						assignments.remove(cand);
 						circularString.setLineType(cand, FlapPatternString::MAJOR);
@@ -736,36 +1119,77 @@ namespace enumeration {
 
 			};
 
-
+			// upper bound of #node in the search tree, that is, #subsets of size <= maxDepth.
+			size_t countNodesAtMost(const int& lineCount, const int& maxDepth) const {
+				long double total = 0, combination = 1;
+				for (int k = 0; k <= std::min(maxDepth, lineCount); k++) {
+					total += combination;
+					combination = combination * (lineCount - k) / (k + 1);
+				}
+				if (total >= (long double)std::numeric_limits<size_t>::max() / 4) {
+					return std::numeric_limits<size_t>::max() / 4;
+				}
+				return (size_t)total;
+			}
 
 		public:
-			LinearMVEnumeration() {}
+			static const size_t DEFAULT_CACHE_BYTE_LIMIT = (size_t)512 << 20;
+
+			CachedLinearMVEnumeration(const size_t cacheByteLimit = DEFAULT_CACHE_BYTE_LIMIT) : cache(cacheByteLimit) {}
 
 			virtual const mylib::EnumerationStats& mvStats() {
 				return stats;
 			}
 
+			// count of flaps enumerated with PPC duplication check instead of the cache.
+			const unsigned long long& ppcFallbackCount() const {
+				return ppcFallbackCount_;
+			}
+
 			// run algorithm
 			virtual mylib::EnumerationStats enumerate(
 				const EncodablePatternBase& flap, TOStream& os,
 				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
 				const mylib::IPruningSuggester<TSet_Assignment>& pruning = MaekawaPruning<TSet_Assignment>()) {
 
-				FlapPatternStringFactory stringFactory;
-				auto circularString = stringFactory.createCircularString(flap);
+				FlapContext context(flap);
+				return enumerateInContext(context, os, ansDetecter, pruning);
+			}
+
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning) {
+
+				MVSymmetryDetecter<TSet_Assignment> symmDetecter(context);
+				return enumerateInContext(context, os, ansDetecter, pruning, symmDetecter);
+			}
 
-				TSet_Assignment seed(flap.count());
-				u_int candEnd = seed.capacity();
+			// duplication is used only if the cache may not hold the search tree.
+			virtual mylib::EnumerationStats enumerateInContext(const FlapContext& context, TOStream& os,
+				mylib::IAnswerDetecter<TSet_Assignment>& ansDetecter,
+				const mylib::IPruningSuggester<TSet_Assignment>& pruning,
+				ppc::AbstractDuplicationDetecter<TSet_Assignment>& duplication) {
 
-				char maxAlphabet = -2;
-				//char maxAlphabet = flap.capacity() / 2;
-				for (int i = 0; i < circularString.size(); i++) {
-					maxAlphabet = std::max(maxAlphabet, circularString[i]);
+				auto circularString = context.circularString();
+
+				const int lineCount = context.lineCount();
+				TSet_Assignment seed(lineCount);
+
+				if (canHold(cache, countNodesAtMost(lineCount, pruning.maxDepth(lineCount)), circularString.size())) {
+					Implementation search(ansDetecter, pruning, cache, NULL, circularString.size());
+					search.enumerate(circularString, seed, 0, lineCount, -1, 0, os);
+					stats = search.stats();
 				}
+				else {
+					ppcFallbackCount_++;
+
+					Implementation search(ansDetecter, pruning, cache, &duplication, circularString.size());
+					search.enumerate(circularString, seed, 0, lineCount, -1, 0, os);
+					stats = search.stats();
+				}
+
+				cache.clear();
 
-				Implementation search(ansDetecter, pruning, circularString.size(), maxAlphabet);
-				search.enumerate(circularString, seed, 0, seed.capacity(), 0, os);
-				stats = search.stats();
 				return stats;
 			}
 
@@ -776,6 +1200,22 @@ namespace enumeration {
 			}
 		};
 
+		// fingerprints of canonical strings.
+		template<typename TOStream, typename TSet_Assignment, bool needStats = true>
+		class LinearMVEnumeration : public CachedLinearMVEnumeration<TOStream, TSet_Assignment, needStats, mylib::FingerprintSet<> > {
+			typedef CachedLinearMVEnumeration<TOStream, TSet_Assignment, needStats, mylib::FingerprintSet<> > Base;
+		public:
+			LinearMVEnumeration(const size_t cacheByteLimit = Base::DEFAULT_CACHE_BYTE_LIMIT) : Base(cacheByteLimit) {}
+		};
+
+		// canonical strings themselves in an arena trie; no false positive.
+		template<typename TOStream, typename TSet_Assignment, bool needStats = true>
+		class TrieLinearMVEnumeration : public CachedLinearMVEnumeration<TOStream, TSet_Assignment, needStats, mylib::ArenaPatriciaTrie> {
+			typedef CachedLinearMVEnumeration<TOStream, TSet_Assignment, needStats, mylib::ArenaPatriciaTrie> Base;
+		public:
+			TrieLinearMVEnumeration(const size_t cacheByteLimit = Base::DEFAULT_CACHE_BYTE_LIMIT) : Base(cacheByteLimit) {}
+		};
+
 
 	}
 }
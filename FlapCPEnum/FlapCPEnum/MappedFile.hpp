@@ -0,0 +1,109 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mylib {
+
+	// read-only memory mapping of a whole file.
+	class MappedFile {
+		const unsigned char* data_;
+		size_t size_;
+#ifdef _WIN32
+		HANDLE file;
+		HANDLE mapping;
+#endif
+
+	public:
+		explicit MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+#ifdef _WIN32
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE) {
+				throw std::invalid_argument("MappedFile: cannot open " + path);
+			}
+			LARGE_INTEGER fileSize;
+			GetFileSizeEx(file, &fileSize);
+			size_ = (size_t)fileSize.QuadPart;
+
+			mapping = NULL;
+			if (size_ > 0) {
+				mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+				if (mapping == NULL) {
+					CloseHandle(file);
+					throw std::invalid_argument("MappedFile: cannot map " + path);
+				}
+				data_ = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			}
+#else
+			const int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				throw std::invalid_argument("MappedFile: cannot open " + path);
+			}
+			struct stat status;
+			fstat(fd, &status);
+			size_ = (size_t)status.st_size;
+
+			if (size_ > 0) {
+				void* mapped = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+				if (mapped == MAP_FAILED) {
+					close(fd);
+					throw std::invalid_argument("MappedFile: cannot map " + path);
+				}
+				data_ = (const unsigned char*)mapped;
+			}
+			// the mapping stays valid after close().
+			close(fd);
+#endif
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile() {
+#ifdef _WIN32
+			if (data_ != nullptr) {
+				UnmapViewOfFile(data_);
+			}
+			if (mapping != NULL) {
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+#else
+			if (data_ != nullptr) {
+				munmap((void*)data_, size_);
+			}
+#endif
+		}
+
+		const unsigned char* data() const {
+			return data_;
+		}
+
+		size_t size() const {
+			return size_;
+		}
+	};
+
+	// std::streambuf reading mapped bytes, e.g. to parse a header with std::istream.
+	class MemoryStreamBuffer : public std::streambuf {
+	public:
+		MemoryStreamBuffer(const unsigned char* data, const size_t size) {
+			char* begin = (char*)data;
+			setg(begin, begin, begin + size);
+		}
+	};
+}
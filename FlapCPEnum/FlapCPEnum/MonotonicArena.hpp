@@ -0,0 +1,180 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "abbreviation.h"
+
+namespace mylib {
+
+	// Bump allocator for the scratch data of one flap.
+	// allocate() takes memory from the current chunk and deallocation is a no-op.
+	// reset() rewinds to the first chunk and keeps every chunk for the next flap,
+	// so the arena stops calling malloc once it has grown to the largest flap.
+	//
+	// The arena does not call destructors: objects on it must be destroyed before reset().
+	// Not thread safe; each worker owns its arena.
+	class MonotonicArena {
+		struct Chunk {
+			char* memory;
+			size_t size;
+		};
+
+		std::vector<Chunk> chunks;
+		size_t chunkIndex;
+		size_t offset;
+		size_t bytesAllocated_;
+		const size_t chunkSize;
+
+		static uintptr_t alignUp(const uintptr_t address, const size_t alignment) {
+			return (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		}
+
+		// the first chunk after the current one that can hold the bytes; a new chunk if none.
+		void moveToChunkFor(const size_t bytes, const size_t alignment) {
+			const size_t needed = bytes + alignment;
+
+			for (size_t i = chunkIndex + 1; i < chunks.size(); i++) {
+				if (chunks[i].size >= needed) {
+					std::swap(chunks[chunkIndex + 1], chunks[i]);
+					chunkIndex++;
+					offset = 0;
+					return;
+				}
+			}
+
+			Chunk chunk;
+			chunk.size = std::max(chunkSize, needed);
+			chunk.memory = static_cast<char*>(::operator new(chunk.size));
+			chunks.insert(chunks.begin() + (chunks.empty() ? 0 : chunkIndex + 1), chunk);
+
+			chunkIndex = (chunks.size() == 1) ? 0 : chunkIndex + 1;
+			offset = 0;
+		}
+
+	public:
+		static const size_t DEFAULT_CHUNK_SIZE = (size_t)64 << 10;
+
+		MonotonicArena(const size_t chunkSize = DEFAULT_CHUNK_SIZE) :
+			chunkIndex(0), offset(0), bytesAllocated_(0), chunkSize(chunkSize) {}
+
+		MonotonicArena(const MonotonicArena&) = delete;
+		MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+		~MonotonicArena() {
+			for (auto& chunk : chunks) {
+				::operator delete(chunk.memory);
+			}
+		}
+
+		void* allocate(const size_t bytes, const size_t alignment = alignof(std::max_align_t)) {
+			if (chunks.empty()) {
+				moveToChunkFor(bytes, alignment);
+			}
+
+			auto* chunk = &chunks[chunkIndex];
+			auto address = alignUp((uintptr_t)(chunk->memory + offset), alignment);
+
+			if (address + bytes > (uintptr_t)(chunk->memory + chunk->size)) {
+				moveToChunkFor(bytes, alignment);
+				chunk = &chunks[chunkIndex];
+				address = alignUp((uintptr_t)chunk->memory, alignment);
+			}
+
+			offset = address + bytes - (uintptr_t)chunk->memory;
+			bytesAllocated_ += bytes;
+
+			return (void*)address;
+		}
+
+		// uninitialized array.
+		template<typename T>
+		T* allocateArray(const size_t count) {
+			return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+		}
+
+		// constructs T on the arena. call ~T() before reset().
+		template<typename T, typename... Args>
+		T* create(Args&&... args) {
+			return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		// forgets every allocation and keeps the chunks.
+		void reset() {
+			chunkIndex = 0;
+			offset = 0;
+			bytesAllocated_ = 0;
+		}
+
+		// true if p points into a chunk of the arena.
+		bool owns(const void* p) const {
+			const char* address = static_cast<const char*>(p);
+			for (const auto& chunk : chunks) {
+				if (chunk.memory <= address && address < chunk.memory + chunk.size) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// bytes handed out since the last reset().
+		const size_t& bytesAllocated() const {
+			return bytesAllocated_;
+		}
+
+		// bytes of all chunks.
+		size_t capacity() const {
+			size_t total = 0;
+			for (const auto& chunk : chunks) {
+				total += chunk.size;
+			}
+			return total;
+		}
+
+		size_t chunkCount() const {
+			return chunks.size();
+		}
+	};
+
+	// std allocator on a MonotonicArena. without an arena it uses the heap.
+	template<typename T>
+	class ArenaAllocator {
+	public:
+		typedef T value_type;
+
+		MonotonicArena* arena;
+
+		ArenaAllocator() noexcept : arena(NULL) {}
+
+		ArenaAllocator(MonotonicArena* arena) noexcept : arena(arena) {}
+
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& source) noexcept : arena(source.arena) {}
+
+		T* allocate(const size_t count) {
+			if (arena != NULL) {
+				return arena->allocateArray<T>(count);
+			}
+			return static_cast<T*>(::operator new(count * sizeof(T)));
+		}
+
+		void deallocate(T* p, const size_t) noexcept {
+			if (arena == NULL) {
+				::operator delete(p);
+			}
+		}
+	};
+
+	template<typename T, typename U>
+	bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+		return a.arena == b.arena;
+	}
+
+	template<typename T, typename U>
+	bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+		return a.arena != b.arena;
+	}
+}
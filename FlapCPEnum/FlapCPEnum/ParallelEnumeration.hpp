@@ -3,6 +3,7 @@
 #include "KawasakiFlapEnumeration.hpp"
 #include "MVEnumeration.hpp"
 #include "FlapCPEnumeration.hpp"
+#include "TraceRecorder.hpp"
 
 #include <mpi.h>
 
@@ -12,9 +13,11 @@ namespace enumeration {
 		using namespace mylib;
 
 
+		// if needTimers, the workers measure the phases of their flaps.
+		// if needTrace, every process records the timeline of its messages and jobs.
 		template <typename EncoderFunc,
 			template<typename TOStream, typename TSet_Assignment, bool needStats_> class TMVEnumeration,
-			typename TSet_Assignment = mylib::BitSet >		
+			typename TSet_Assignment = mylib::BitSet, bool needTimers = false, bool needTrace = false >		
 
 			class ParallelEnumeration : public MasterWorkerBase {
 			static const int TAG_JOB = 10;
@@ -22,21 +25,34 @@ namespace enumeration {
 			template<typename TFlapPattern>
 			class ParallelPipe {
 				MasterWorkerBase *comm;
+				TraceRecorder<needTrace>& trace;
+				// the end of the previous flap. the master generates flaps until the next one.
+				typename TraceRecorder<needTrace>::TimePoint generateStart;
 			public:
-				ParallelPipe(MasterWorkerBase *comm) : comm(comm) {}
+				ParallelPipe(MasterWorkerBase *comm, TraceRecorder<needTrace>& trace) :
+					comm(comm), trace(trace), generateStart(trace.now()) {}
 	
 				ParallelPipe& operator<<(const TFlapPattern& flap) {
+					trace.record(TraceEvent::GENERATE, generateStart, -1, 0);
+
 					int workerID;
 					//std::cout << "kawasaki found " << flap.toString() << std::endl;
+					auto waitStart = trace.now();
 					WorkerState state = comm->receiveWorkerStateFromAny(workerID);
+					trace.record(TraceEvent::WAIT_WORKER, waitStart, workerID, sizeof(WorkerState));
 
 					//std::cout << "receive from " << workerID << std::endl;
 
 					if(state == WorkerState::IDLE) {
+						auto sendStart = trace.now();
 						comm->sendWorkerState(WorkerState::JOB_START, workerID);
 						//std::cout << "send flap to " << workerID << std::endl;
 						flap.MPISendAsSet(workerID, TAG_JOB);
+						trace.record(TraceEvent::SEND_JOB, sendStart, workerID,
+							(int)(sizeof(WorkerState) + flap.MPIMessageSizeAsSet()));
 					}
+
+					generateStart = trace.now();
 					return *this;
 				}
 
@@ -44,13 +60,22 @@ namespace enumeration {
 			};
 
 			const int placeCount;
+			TraceRecorder<needTrace> trace;
 			ParallelPipe<FlapPatternForBraceletEnum> pipe;
 			IFlapCPAnswerDetecterFactory<TSet_Assignment>& factory;
 
 			mylib::EnumerationStats mvStats_;
+			PhaseTimes phaseTimes_;
 
 			EncoderFunc encode;
 
+			// myID is not set until run().
+			static int worldRank() {
+				int rank;
+				MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+				return rank;
+			}
+
 		protected:
 			virtual void masterTask() {
 				//std::cout << "ID=" << myID << " run kawasaki enumeration" << std::endl;
@@ -66,40 +91,37 @@ namespace enumeration {
 				//std::cout << "ID=" << myID << " task start" << std::endl;
 				WorkerState state = WorkerState::IDLE;
 
+				// the same per-flap steps as the serial enumerations.
+				EnumerationPipe<EncoderFunc, TMVEnumeration, TSet_Assignment, false, needTimers> workerPipe(encode, factory);
+
 				while (state != WorkerState::FINISH) {
+					auto waitStart = trace.now();
 					sendWorkerState(WorkerState::IDLE, masterID);
 
 					state = receiveWorkerStateFrom(masterID);
+					trace.record(TraceEvent::WAIT_JOB, waitStart, masterID, 2 * sizeof(WorkerState));
 
 					if (state != WorkerState::JOB_START) {
 						continue;
 					}
 
 					FlapPatternForBraceletEnum flap;
+					auto receiveStart = trace.now();
 					flap.MPIReceiveAsSet(masterID, TAG_JOB);
+					trace.record(TraceEvent::RECEIVE_JOB, receiveStart, masterID, (int)flap.MPIMessageSizeAsSet());
 
-					CPEncoderStream<EncoderFunc> out(flap, encode);
-
-					auto isAnswer = factory.create(flap);
-					
-					TMVEnumeration<CPEncoderStream<EncoderFunc>, TSet_Assignment, false> mvEnumeration;
-					mvEnumeration.enumerate(flap, out, *isAnswer);
-
-					// debug: turn on stats
-					//TMVEnumeration<CPEncoderStream<EncoderFunc>, TSet_Assignment, true> mvEnumeration;
-					//mvStats_ += mvEnumeration.enumerate(flap, out, *isAnswer);
-					
-					//std::cout << "ID=" << myID << "enumerated " 
-					//	<< mvStats_.answerCount << " patterns" << std::endl;
-					delete isAnswer;
-
+					auto jobStart = trace.now();
+					workerPipe << flap;
+					trace.record(TraceEvent::JOB, jobStart, masterID, flap.count());
 				}
+
+				phaseTimes_ = workerPipe.phaseTimer().times();
 			}
 
 		public:
 
 			ParallelEnumeration(const int placeCount, IFlapCPAnswerDetecterFactory<TSet_Assignment>& factory, EncoderFunc encode) :
-				placeCount(placeCount), factory(factory), encode(encode), pipe(this) {
+				placeCount(placeCount), trace(worldRank()), pipe(this, trace), factory(factory), encode(encode) {
 
 			}
 
@@ -111,15 +133,27 @@ namespace enumeration {
 				return mvStats_;
 			}
 
+			// of this process. zero on the master.
+			const PhaseTimes& phaseTimes() {
+				return phaseTimes_;
+			}
+
+			// of this process. empty unless needTrace.
+			const std::vector<TraceEvent>& traceEvents() const {
+				return trace.events();
+			}
+
 		};
 
 		template<
 			template <typename TOStream, typename TSet_Assignment, bool needStats_> class TMVEnumeration,
-			typename TSet_Assignment = mylib::BitSet>
+			typename TSet_Assignment = mylib::BitSet, bool needTimers = false, bool needTrace = false>
 		class ParallelEnumerationRunner {
 	
 			IFlapCPAnswerDetecterFactory<TSet_Assignment>& factory;
 			mylib::EnumerationStats mvStats_;
+			PhaseTimes phaseTimes_;
+			std::vector<TraceEvent> traceEvents_;
 		public:
 			ParallelEnumerationRunner(IFlapCPAnswerDetecterFactory<TSet_Assignment>& factory) : factory(factory) {}
 
@@ -127,36 +161,55 @@ namespace enumeration {
 			void enumerate(u_int placeCount, EncoderFunc& encode) {
 				//std::cout << "enter enumerate() of runner" << std::endl;
 
-				ParallelEnumeration<EncoderFunc, TMVEnumeration> parallel(placeCount, factory, encode);
+				ParallelEnumeration<EncoderFunc, TMVEnumeration, TSet_Assignment, needTimers, needTrace> parallel(placeCount, factory, encode);
 				parallel.enumerate();
 				mvStats_ += parallel.mvStats();
+				phaseTimes_ += parallel.phaseTimes();
+				traceEvents_.insert(traceEvents_.end(), parallel.traceEvents().begin(), parallel.traceEvents().end());
 			}
 
 			const mylib::EnumerationStats& mvStats() {
 				return mvStats_;
 			}
 
+			// of this process. reduce them for the total of the workers.
+			const PhaseTimes& phaseTimes() {
+				return phaseTimes_;
+			}
+
+			// of this process. gather them by ChromeTraceWriter::gather().
+			const std::vector<TraceEvent>& traceEvents() const {
+				return traceEvents_;
+			}
+
 		};
 		 
-		template<typename TSet_Assignment = mylib::BitSet>
-		class FoldableFlapCPParallelEnumeration : public ParallelEnumerationRunner<MVLSLEnumeration, TSet_Assignment> {
+		template<typename TSet_Assignment = mylib::BitSet, bool needTimers = false, bool needTrace = false>
+		class FoldableFlapCPParallelEnumeration : public ParallelEnumerationRunner<MVLSLEnumeration, TSet_Assignment, needTimers, needTrace> {
 			FoldabilityDetecterFactory<TSet_Assignment> factory;
 		public:
-			FoldableFlapCPParallelEnumeration() : ParallelEnumerationRunner<MVLSLEnumeration, TSet_Assignment>(factory) {}
+			FoldableFlapCPParallelEnumeration() : ParallelEnumerationRunner<MVLSLEnumeration, TSet_Assignment, needTimers, needTrace>(factory) {}
 		};
 
-		template<typename TSet_Assignment = mylib::BitSet>
-		class ExLSLFoldableFlapCPParallelEnumeration : public ParallelEnumerationRunner<ExtendedMVLSLEnumeration, TSet_Assignment> {
+		template<typename TSet_Assignment = mylib::BitSet, bool needTimers = false, bool needTrace = false>
+		class ExLSLFoldableFlapCPParallelEnumeration : public ParallelEnumerationRunner<ExtendedMVLSLEnumeration, TSet_Assignment, needTimers, needTrace> {
 			FoldabilityDetecterFactory<TSet_Assignment> factory;
 		public:
-			ExLSLFoldableFlapCPParallelEnumeration() : ParallelEnumerationRunner<ExtendedMVLSLEnumeration, TSet_Assignment>(factory) {}
+			ExLSLFoldableFlapCPParallelEnumeration() : ParallelEnumerationRunner<ExtendedMVLSLEnumeration, TSet_Assignment, needTimers, needTrace>(factory) {}
+		};
+
+		template<typename TSet_Assignment = mylib::BitSet, bool needTimers = false, bool needTrace = false>
+		class CrimpPruningFoldableFlapCPParallelEnumeration : public ParallelEnumerationRunner<CrimpPruningMVEnumeration, TSet_Assignment, needTimers, needTrace> {
+			MaekawaTheoremFactory<TSet_Assignment> factory;
+		public:
+			CrimpPruningFoldableFlapCPParallelEnumeration() : ParallelEnumerationRunner<CrimpPruningMVEnumeration, TSet_Assignment, needTimers, needTrace>(factory) {}
 		};
 
-		template<typename TSet_Assignment = mylib::BitSet>
-		class MaekawaFlapCPParallelEnumeration : public ParallelEnumerationRunner<MVEnumeration, TSet_Assignment> {
+		template<typename TSet_Assignment = mylib::BitSet, bool needTimers = false, bool needTrace = false>
+		class MaekawaFlapCPParallelEnumeration : public ParallelEnumerationRunner<MVEnumeration, TSet_Assignment, needTimers, needTrace> {
 			MaekawaTheoremFactory<TSet_Assignment> factory;
 		public:
-			MaekawaFlapCPParallelEnumeration() : ParallelEnumerationRunner<MVEnumeration, TSet_Assignment>(factory) {}
+			MaekawaFlapCPParallelEnumeration() : ParallelEnumerationRunner<MVEnumeration, TSet_Assignment, needTimers, needTrace>(factory) {}
 		};
 	}
 }
@@ -0,0 +1,290 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+
+#include "searchtool.hpp"
+#include "ppcsearch.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		// seconds spent in each phase of an enumeration. phases do not overlap.
+		struct PhaseTimes {
+			// MV_SEARCH is the search itself, including LSL and crimp pruning,
+			// excluding the phases called from it.
+			enum Phase { KAWASAKI, FLAP_SETUP, MV_SEARCH, DUPLICATION, FOLDABILITY, ENCODING, PHASE_COUNT };
+
+			// an array so that it can be reduced as PHASE_COUNT doubles by MPI.
+			double seconds[PHASE_COUNT];
+
+			PhaseTimes() {
+				for (int i = 0; i < PHASE_COUNT; i++) {
+					seconds[i] = 0.0;
+				}
+			}
+
+			static const char* name(const int phase) {
+				static const char* const NAMES[PHASE_COUNT] = {
+					"kawasaki", "flap setup", "mv search", "duplication", "foldability", "encoding"
+				};
+				return NAMES[phase];
+			}
+
+			void operator+=(const PhaseTimes& right) {
+				for (int i = 0; i < PHASE_COUNT; i++) {
+					seconds[i] += right.seconds[i];
+				}
+			}
+
+			double total() const {
+				double sum = 0.0;
+				for (int i = 0; i < PHASE_COUNT; i++) {
+					sum += seconds[i];
+				}
+				return sum;
+			}
+
+			// one line per phase with the percentage of the total.
+			void write(std::ostream& os) const {
+				const double sum = total();
+				for (int i = 0; i < PHASE_COUNT; i++) {
+					os << std::left << std::setw(12) << name(i) << std::right << " "
+						<< std::fixed << std::setprecision(6) << seconds[i] << "[sec] "
+						<< std::setprecision(1) << std::setw(5) << (sum > 0.0 ? 100.0 * seconds[i] / sum : 0.0) << "%"
+						<< std::defaultfloat << std::endl;
+				}
+			}
+		};
+
+		/**
+		 * Accumulates the time of the current phase on each switch.
+		 * A nested phase pauses the outer one, so the times are exclusive.
+		 *
+		 * The phases entered once per answer candidate (foldability, duplication and output) are
+		 * too short to read the clock on every call. They only mark themselves as running, and
+		 * a sampler thread counts which phase is running every samplingInterval().
+		 * The time of an outer phase is split among it and its inner phases by those counts.
+		 *
+		 * PhaseTimer<false> does nothing and is optimized out.
+		 */
+		template<bool enabled>
+		class PhaseTimer {
+			typedef std::chrono::steady_clock Clock;
+
+			// PHASE_COUNT while no phase is running.
+			int current;
+			Clock::time_point last;
+			Clock::duration durations[PhaseTimes::PHASE_COUNT];
+
+			// the running phase for the sampler: a switched phase, PHASE_COUNT + an inner phase,
+			// or 2 * PHASE_COUNT while no phase is running.
+			std::atomic<int> running;
+			std::atomic<unsigned long long> hits[2 * PhaseTimes::PHASE_COUNT + 1];
+			// the phase an inner phase was entered in.
+			int outerPhases[PhaseTimes::PHASE_COUNT];
+
+			std::atomic<bool> stops;
+			std::thread sampler;
+
+			void sample() {
+				while (!stops.load()) {
+					std::this_thread::sleep_for(samplingInterval());
+					hits[running.load(std::memory_order_relaxed)].fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+
+		public:
+			static std::chrono::microseconds samplingInterval() {
+				return std::chrono::microseconds(500);
+			}
+
+			PhaseTimer() : current(PhaseTimes::PHASE_COUNT), running(2 * PhaseTimes::PHASE_COUNT), stops(false) {
+				for (int i = 0; i < PhaseTimes::PHASE_COUNT; i++) {
+					durations[i] = Clock::duration::zero();
+					outerPhases[i] = PhaseTimes::PHASE_COUNT;
+				}
+				for (auto& hit : hits) {
+					hit = 0ULL;
+				}
+				sampler = std::thread(&PhaseTimer::sample, this);
+			}
+
+			~PhaseTimer() {
+				stops = true;
+				sampler.join();
+			}
+
+			PhaseTimer(const PhaseTimer&) = delete;
+			PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+			// returns the previous phase.
+			inline int switchTo(const int phase) {
+				const auto now = Clock::now();
+				if (current != PhaseTimes::PHASE_COUNT) {
+					durations[current] += now - last;
+				}
+				last = now;
+
+				const int previous = current;
+				current = phase;
+				running.store(phase == PhaseTimes::PHASE_COUNT ? 2 * PhaseTimes::PHASE_COUNT : phase, std::memory_order_relaxed);
+				return previous;
+			}
+
+			// marks an inner phase of the current one as running, without reading the clock.
+			// returns the mark to be restored by leave().
+			inline int enter(const int phase) {
+				outerPhases[phase] = current;
+				const int previous = running.load(std::memory_order_relaxed);
+				running.store(PhaseTimes::PHASE_COUNT + phase, std::memory_order_relaxed);
+				return previous;
+			}
+
+			inline void leave(const int previous) {
+				running.store(previous, std::memory_order_relaxed);
+			}
+
+			PhaseTimes times() const {
+				PhaseTimes times;
+				for (int i = 0; i < PhaseTimes::PHASE_COUNT; i++) {
+					times.seconds[i] = std::chrono::duration<double>(durations[i]).count();
+				}
+
+				for (int outer = 0; outer < PhaseTimes::PHASE_COUNT; outer++) {
+					unsigned long long outerHits = hits[outer];
+					for (int inner = 0; inner < PhaseTimes::PHASE_COUNT; inner++) {
+						if (outerPhases[inner] == outer) {
+							outerHits += hits[PhaseTimes::PHASE_COUNT + inner];
+						}
+					}
+					if (outerHits == 0) {
+						continue;
+					}
+
+					const double outerSeconds = times.seconds[outer];
+					times.seconds[outer] = outerSeconds * hits[outer] / outerHits;
+					for (int inner = 0; inner < PhaseTimes::PHASE_COUNT; inner++) {
+						if (outerPhases[inner] == outer) {
+							times.seconds[inner] += outerSeconds * hits[PhaseTimes::PHASE_COUNT + inner] / outerHits;
+						}
+					}
+				}
+				return times;
+			}
+		};
+
+		template<>
+		class PhaseTimer<false> {
+		public:
+			inline int switchTo(const int phase) {
+				return phase;
+			}
+
+			PhaseTimes times() const {
+				return PhaseTimes();
+			}
+		};
+
+		template<bool enabled>
+		class ScopedPhase {
+			PhaseTimer<enabled>& timer;
+			const int previous;
+
+		public:
+			ScopedPhase(PhaseTimer<enabled>& timer, const int phase) : timer(timer), previous(timer.switchTo(phase)) {
+			}
+
+			~ScopedPhase() {
+				timer.switchTo(previous);
+			}
+
+			ScopedPhase(const ScopedPhase&) = delete;
+			ScopedPhase& operator=(const ScopedPhase&) = delete;
+		};
+
+		template<>
+		class ScopedPhase<false> {
+		public:
+			ScopedPhase(PhaseTimer<false>&, const int) {
+			}
+		};
+
+		// marks a phase nested in the current one while in scope. see PhaseTimer.
+		class InnerPhase {
+			PhaseTimer<true>& timer;
+			const int previous;
+
+		public:
+			InnerPhase(PhaseTimer<true>& timer, const int phase) : timer(timer), previous(timer.enter(phase)) {
+			}
+
+			~InnerPhase() {
+				timer.leave(previous);
+			}
+
+			InnerPhase(const InnerPhase&) = delete;
+			InnerPhase& operator=(const InnerPhase&) = delete;
+		};
+
+		// times isAnswer() of the detecter as FOLDABILITY.
+		template<typename TSet_Assignment>
+		class TimedAnswerDetecter : public mylib::IAnswerDetecter<TSet_Assignment> {
+			mylib::IAnswerDetecter<TSet_Assignment>& detecter;
+			PhaseTimer<true>& timer;
+
+		public:
+			TimedAnswerDetecter(mylib::IAnswerDetecter<TSet_Assignment>& detecter, PhaseTimer<true>& timer) :
+				detecter(detecter), timer(timer) {
+			}
+
+			virtual bool isAnswer(const TSet_Assignment& pattern) {
+				InnerPhase phase(timer, PhaseTimes::FOLDABILITY);
+				return detecter.isAnswer(pattern);
+			}
+		};
+
+		// times hasGenerated() of the detecter as DUPLICATION.
+		template<typename TSet_Assignment>
+		class TimedDuplicationDetecter : public ppc::AbstractDuplicationDetecter<TSet_Assignment> {
+			const ppc::AbstractDuplicationDetecter<TSet_Assignment>& detecter;
+			PhaseTimer<true>& timer;
+
+		public:
+			TimedDuplicationDetecter(const ppc::AbstractDuplicationDetecter<TSet_Assignment>& detecter, PhaseTimer<true>& timer) :
+				detecter(detecter), timer(timer) {
+			}
+
+			virtual bool hasGenerated(const TSet_Assignment& pattern, const int elemEnd, const int prefixTail) const {
+				InnerPhase phase(timer, PhaseTimes::DUPLICATION);
+				return detecter.hasGenerated(pattern, elemEnd, prefixTail);
+			}
+		};
+
+		// times the output to the stream as ENCODING.
+		template<typename TStream>
+		class TimedStream {
+			TStream& stream;
+			PhaseTimer<true>& timer;
+
+		public:
+			TimedStream(TStream& stream, PhaseTimer<true>& timer) : stream(stream), timer(timer) {
+			}
+
+			template<typename T>
+			TimedStream& operator<<(const T& value) {
+				InnerPhase phase(timer, PhaseTimes::ENCODING);
+				stream << value;
+				return *this;
+			}
+
+			void flush() {
+				ScopedPhase<true> phase(timer, PhaseTimes::ENCODING);
+				stream.flush();
+			}
+		};
+	}
+}
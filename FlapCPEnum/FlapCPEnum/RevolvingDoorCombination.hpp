@@ -0,0 +1,110 @@
+﻿#pragma once
+
+#include <vector>
+#include "abbreviation.h"
+
+namespace mylib {
+
+	/**
+	 * Generates all t-combinations of {0, ..., n-1} in revolving-door (Gray code) order,
+	 * where two consecutive combinations differ by one swap: one item leaves and one item enters.
+	 *
+	 * This algorithm is Algorithm R of "The Art of Computer Programming Vol. 4A" (Knuth), section 7.2.1.3.
+	 *
+	 * usage:
+	 * RevolvingDoorCombination comb(n, t);
+	 * visit(comb.items());
+	 * while (comb.next()) { update(comb.removedItem(), comb.addedItem()); }
+	 */
+	class RevolvingDoorCombination {
+		// c[0] is unused, c[1..t] are items in increasing order and c[t+1] = n is a sentinel.
+		std::vector<int> c;
+		const int n, t;
+
+		int removed = -1;
+		int added = -1;
+
+		void swap(const int& removedItem, const int& addedItem) {
+			removed = removedItem;
+			added = addedItem;
+		}
+
+	public:
+		RevolvingDoorCombination(const int n, const int t) : c(t + 2), n(n), t(t) {
+			for (int j = 1; j <= t; j++) {
+				c[j] = j - 1;
+			}
+			c[t + 1] = n;
+		}
+
+		// items of current combination in increasing order.
+		const int* items() const {
+			return c.data() + 1;
+		}
+
+		const int& itemCount() const {
+			return t;
+		}
+
+		// the item which left by the last next().
+		const int& removedItem() const {
+			return removed;
+		}
+
+		// the item which entered by the last next().
+		const int& addedItem() const {
+			return added;
+		}
+
+		// moves to the next combination.
+		// return: false if all combinations have been visited.
+		bool next() {
+			if (t == 0 || t >= n) {
+				return false;
+			}
+
+			// R3: easy case
+			if (t % 2 == 1) {
+				if (c[1] + 1 < c[2]) {
+					swap(c[1], c[1] + 1);
+					c[1]++;
+					return true;
+				}
+			}
+			else if (c[1] > 0) {
+				swap(c[1], c[1] - 1);
+				c[1]--;
+				return true;
+			}
+
+			int j = 2;
+			bool tryDecrease = (t % 2 == 1);
+
+			while (j <= t) {
+				if (tryDecrease) {
+					// R4: try to decrease c[j]
+					if (c[j] >= j) {
+						swap(c[j], j - 2);
+						c[j] = c[j - 1];
+						c[j - 1] = j - 2;
+						return true;
+					}
+					j++;
+				}
+				else {
+					// R5: try to increase c[j]
+					if (c[j] + 1 < c[j + 1]) {
+						swap(j - 2, c[j] + 1);
+						c[j - 1] = c[j];
+						c[j]++;
+						return true;
+					}
+					j++;
+				}
+				tryDecrease = !tryDecrease;
+			}
+
+			return false;
+		}
+	};
+}
@@ -4,6 +4,7 @@
 #include "abbreviation.h"
 
 #include <memory>
+#include <new>
 #include <vector>
 #include <stdexcept>
 #include <sstream>
@@ -107,36 +108,34 @@ namespace mylib {
 		}
 	};
 
+	// Free list of nodes in one contiguous slab, so that lists built from the pool
+	// are traversed within a few cache lines.
+	// Nodes refer to the ListProperty of their list, so a pool belongs to one list.
 	template<typename TNode>
 	class NodePool {
-		TNode **pool;
+		TNode *slab;
 		TNode *head;
 
 		int size;
 
-		void substitute(const NodePool<TNode>& right) {
-			pool = right.pool;
-			size = right.size;
-			head = right.head;
-		}
 	public:
 		NodePool(ListProperty<TNode>& prop, const int size) : size(size) {
-			pool = new TNode*[size];
+			slab = static_cast<TNode *>(::operator new(sizeof(TNode) * size));
 
-			for (int i = 0; i < size; i++) pool[i] = new TNode(prop);
+			for (int i = 0; i < size; i++) new (slab + i) TNode(prop);
 
 			clear();
 
 		}
 
-		NodePool(NodePool<TNode>& source) {
-			substitute(source);
-		}
+		// nodes are owned by the slab.
+		NodePool(const NodePool<TNode>& source) = delete;
+		NodePool<TNode>& operator=(const NodePool<TNode>& right) = delete;
 
 		~NodePool() {
-			for (int i = 0; i < size; i++) delete pool[i];
+			for (int i = 0; i < size; i++) slab[i].~TNode();
 
-			delete[] pool;
+			::operator delete(slab);
 		}
 
 
@@ -152,16 +151,11 @@ namespace mylib {
 			head = node;
 		}
 
+		// nodes are handed out in address order.
 		void clear() {
-			head = pool[0];
-			for (int i = 1; i < size; i++) pool[i - 1]->nextNode = pool[i];
-		}
-
-		// narrow copy
-		NodePool<TNode>& operator=(const NodePool<TNode>& right) {
-			substitute(right);
-
-			return *this;
+			head = (size > 0) ? slab : nullptr;
+			for (int i = 1; i < size; i++) slab[i - 1].nextNode = slab + i;
+			if (size > 0) slab[size - 1].nextNode = nullptr;
 		}
 	};
 
@@ -183,12 +177,12 @@ namespace mylib {
 		template<typename TNode>
 		class Iterator {
 			TNode *node;
-			NodePool<TNode>& pool;
+			NodePool<TNode> *pool;
 		public:
 			Iterator(const Iterator<TNode>& itr) : node(itr.node), pool(itr.pool) {
 			}
 
-			Iterator(TNode* node, NodePool<TNode>& pool) : node(node), pool(pool) {
+			Iterator(TNode* node, NodePool<TNode>& pool) : node(node), pool(&pool) {
 
 			}
 
@@ -229,7 +223,7 @@ namespace mylib {
 				auto next = (*node).nextNode;
 				node->leave();
 
-				pool.add(node);
+				pool->add(node);
 				node = next;
 
 				return *this;
@@ -401,8 +395,12 @@ namespace mylib {
 		}
 
 		// existing values will be deleted.
+		// the storage is reused if it has the same size.
 		void allocate(const u_int& newSize) {
 			if (elements != nullptr){
+				if (size_ == newSize) {
+					return;
+				}
 				delete[] elements;
 			}
 			elements = new Element[newSize];
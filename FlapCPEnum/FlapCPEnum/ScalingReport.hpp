@@ -0,0 +1,371 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+#include "searchtool.hpp"
+
+namespace mylib {
+
+	// peak resident set size of this process in KiB.
+	inline unsigned long long peakResidentKiloBytes() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return 0ULL;
+		}
+		return (unsigned long long)counters.PeakWorkingSetSize / 1024;
+#else
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0) {
+			return 0ULL;
+		}
+#ifdef __APPLE__
+		return (unsigned long long)usage.ru_maxrss / 1024;
+#else
+		return (unsigned long long)usage.ru_maxrss;
+#endif
+#endif
+	}
+
+	// one run of the application. (algorithm, placeCount, processCount) is the key.
+	struct ScalingRecord {
+		std::string algorithm;
+		unsigned placeCount = 0;
+		int processCount = 0;
+		double seconds = 0.0;
+		unsigned long long patternCount = 0ULL;
+		// max of the processes.
+		unsigned long long peakRSSKiloBytes = 0ULL;
+		EnumerationStats kawasakiStats;
+		EnumerationStats mvStats;
+
+		std::string key() const {
+			return algorithm + " n=" + std::to_string(placeCount) + " np=" + std::to_string(processCount);
+		}
+
+		// in the column order of the CSV.
+		std::vector<std::pair<std::string, std::string> > fields() const {
+			std::ostringstream secondsText;
+			secondsText.precision(9);
+			secondsText << seconds;
+
+			return {
+				{ "algorithm", algorithm },
+				{ "n", std::to_string(placeCount) },
+				{ "processes", std::to_string(processCount) },
+				{ "seconds", secondsText.str() },
+				{ "patterns", std::to_string(patternCount) },
+				{ "peak_rss_kb", std::to_string(peakRSSKiloBytes) },
+				{ "kawasaki_calls", std::to_string(kawasakiStats.callCount) },
+				{ "kawasaki_valid_calls", std::to_string(kawasakiStats.validCallCount) },
+				{ "kawasaki_answers", std::to_string(kawasakiStats.answerCount) },
+				{ "mv_calls", std::to_string(mvStats.callCount) },
+				{ "mv_valid_calls", std::to_string(mvStats.validCallCount) },
+				{ "mv_answers", std::to_string(mvStats.answerCount) }
+			};
+		}
+
+		// missing fields are left zero.
+		static ScalingRecord fromFields(const std::map<std::string, std::string>& fields) {
+			auto text = [&](const std::string& name) {
+				auto it = fields.find(name);
+				return (it == fields.end()) ? std::string() : it->second;
+			};
+			auto number = [&](const std::string& name) {
+				const std::string value = text(name);
+				return value.empty() ? 0ULL : std::stoull(value);
+			};
+
+			ScalingRecord record;
+			record.algorithm = text("algorithm");
+			record.placeCount = (unsigned)number("n");
+			record.processCount = (int)number("processes");
+			record.seconds = text("seconds").empty() ? 0.0 : std::stod(text("seconds"));
+			record.patternCount = number("patterns");
+			record.peakRSSKiloBytes = number("peak_rss_kb");
+			record.kawasakiStats.callCount = number("kawasaki_calls");
+			record.kawasakiStats.validCallCount = number("kawasaki_valid_calls");
+			record.kawasakiStats.answerCount = number("kawasaki_answers");
+			record.mvStats.callCount = number("mv_calls");
+			record.mvStats.validCallCount = number("mv_valid_calls");
+			record.mvStats.answerCount = number("mv_answers");
+			return record;
+		}
+	};
+
+	/**
+	 * A file of ScalingRecords. CSV with a header line,
+	 * or JSON lines (one flat object per run) if the path ends with ".json".
+	 * Runs are appended so that a sweep can be written by separate processes.
+	 */
+	class ScalingReport {
+		static bool isJSON(const std::string& path) {
+			const std::string extension = ".json";
+			return path.size() >= extension.size() &&
+				path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+		}
+
+		static std::vector<std::string> splitCSV(const std::string& line) {
+			std::vector<std::string> values;
+			std::string value;
+			std::istringstream ss(line);
+			while (std::getline(ss, value, ',')) {
+				if (!value.empty() && value.back() == '\r') {
+					value.pop_back();
+				}
+				values.push_back(value);
+			}
+			return values;
+		}
+
+		// a flat object whose values are numbers or strings without escapes.
+		static std::map<std::string, std::string> parseJSONObject(const std::string& line) {
+			std::map<std::string, std::string> fields;
+			size_t i = line.find('{');
+			if (i == std::string::npos) {
+				throw std::invalid_argument("ScalingReport: not a JSON object: " + line);
+			}
+
+			auto readString = [&](size_t& p) {
+				const size_t end = line.find('"', p + 1);
+				if (end == std::string::npos) {
+					throw std::invalid_argument("ScalingReport: unterminated string: " + line);
+				}
+				std::string text = line.substr(p + 1, end - p - 1);
+				p = end + 1;
+				return text;
+			};
+
+			for (i++; i < line.size();) {
+				const char c = line[i];
+				if (c == '}') {
+					break;
+				}
+				if (c != '"') {
+					i++;
+					continue;
+				}
+				const std::string name = readString(i);
+				const size_t colon = line.find(':', i);
+				if (colon == std::string::npos) {
+					throw std::invalid_argument("ScalingReport: no value for " + name + ": " + line);
+				}
+				i = colon + 1;
+				while (i < line.size() && line[i] == ' ') {
+					i++;
+				}
+				if (i == line.size()) {
+					throw std::invalid_argument("ScalingReport: no value for " + name + ": " + line);
+				}
+				if (line[i] == '"') {
+					fields[name] = readString(i);
+				}
+				else {
+					const size_t end = line.find_first_of(",}", i);
+					fields[name] = line.substr(i, end - i);
+					i = end;
+				}
+			}
+			return fields;
+		}
+
+	public:
+		static void writeCSVHeader(std::ostream& os) {
+			const auto fields = ScalingRecord().fields();
+			for (size_t i = 0; i < fields.size(); i++) {
+				os << (i == 0 ? "" : ",") << fields[i].first;
+			}
+			os << '\n';
+		}
+
+		static void writeCSV(std::ostream& os, const ScalingRecord& record) {
+			const auto fields = record.fields();
+			for (size_t i = 0; i < fields.size(); i++) {
+				os << (i == 0 ? "" : ",") << fields[i].second;
+			}
+			os << '\n';
+		}
+
+		// algorithm is the only string field.
+		static void writeJSON(std::ostream& os, const ScalingRecord& record) {
+			const auto fields = record.fields();
+			os << '{';
+			for (size_t i = 0; i < fields.size(); i++) {
+				os << (i == 0 ? "" : ",") << '"' << fields[i].first << "\":";
+				if (i == 0) {
+					os << '"' << fields[i].second << '"';
+				}
+				else {
+					os << fields[i].second;
+				}
+			}
+			os << "}\n";
+		}
+
+		// the CSV header is written if the file is new or empty.
+		static void append(const std::string& path, const ScalingRecord& record) {
+			bool isEmpty;
+			{
+				std::ifstream fin(path);
+				isEmpty = !fin || fin.peek() == std::ifstream::traits_type::eof();
+			}
+
+			std::ofstream fout(path, std::ios::app);
+			if (!fout) {
+				throw std::invalid_argument("ScalingReport: cannot open " + path);
+			}
+
+			if (isJSON(path)) {
+				writeJSON(fout, record);
+				return;
+			}
+			if (isEmpty) {
+				writeCSVHeader(fout);
+			}
+			writeCSV(fout, record);
+		}
+
+		static std::vector<ScalingRecord> read(std::istream& is, const bool json) {
+			std::vector<ScalingRecord> records;
+			std::string line;
+
+			if (json) {
+				while (std::getline(is, line)) {
+					if (line.find_first_not_of(" \t\r") == std::string::npos) {
+						continue;
+					}
+					records.push_back(ScalingRecord::fromFields(parseJSONObject(line)));
+				}
+				return records;
+			}
+
+			if (!std::getline(is, line)) {
+				return records;
+			}
+			const auto names = splitCSV(line);
+			while (std::getline(is, line)) {
+				const auto values = splitCSV(line);
+				if (values.empty()) {
+					continue;
+				}
+				if (values.size() != names.size()) {
+					throw std::invalid_argument("ScalingReport: wrong column count: " + line);
+				}
+				std::map<std::string, std::string> fields;
+				for (size_t i = 0; i < names.size(); i++) {
+					fields[names[i]] = values[i];
+				}
+				records.push_back(ScalingRecord::fromFields(fields));
+			}
+			return records;
+		}
+
+		static std::vector<ScalingRecord> read(const std::string& path) {
+			std::ifstream fin(path);
+			if (!fin) {
+				throw std::invalid_argument("ScalingReport: cannot open " + path);
+			}
+			return read(fin, isJSON(path));
+		}
+	};
+
+	// a change of a run from the baseline.
+	struct ScalingDifference {
+		enum Kind { TIME, COUNT, MISSING };
+
+		Kind kind;
+		std::string key;
+		double baselineValue;
+		double currentValue;
+
+		// MISSING is reported but is not a regression.
+		bool isRegression() const {
+			return kind != MISSING;
+		}
+
+		std::string toString() const {
+			std::ostringstream ss;
+			if (kind == TIME) {
+				ss << "time regression: " << key << " " << baselineValue << "[sec] -> " << currentValue << "[sec]";
+			}
+			else if (kind == COUNT) {
+				ss.precision(20);
+				ss << "count mismatch:  " << key << " " << baselineValue << " -> " << currentValue;
+			}
+			else {
+				ss << "missing:         " << key;
+			}
+			return ss.str();
+		}
+	};
+
+	/**
+	 * Compares runs with the baseline runs of the same key.
+	 * The last run of a key is used if the key appears more than once.
+	 * A time regression is a slowdown over timeTolerance (relative) for runs of minSeconds or longer,
+	 * and any difference of the pattern count is a mismatch.
+	 */
+	class ScalingComparison {
+		double timeTolerance;
+		double minSeconds;
+
+		static std::map<std::string, ScalingRecord> byKey(const std::vector<ScalingRecord>& records) {
+			std::map<std::string, ScalingRecord> map;
+			for (const auto& record : records) {
+				map[record.key()] = record;
+			}
+			return map;
+		}
+
+	public:
+		ScalingComparison(const double timeTolerance = 0.1, const double minSeconds = 0.1) :
+			timeTolerance(timeTolerance), minSeconds(minSeconds) {}
+
+		std::vector<ScalingDifference> compare(const std::vector<ScalingRecord>& baseline,
+			const std::vector<ScalingRecord>& current) const {
+
+			std::vector<ScalingDifference> differences;
+			const auto currentMap = byKey(current);
+
+			for (const auto& entry : byKey(baseline)) {
+				const ScalingRecord& base = entry.second;
+				auto it = currentMap.find(entry.first);
+				if (it == currentMap.end()) {
+					differences.push_back({ ScalingDifference::MISSING, entry.first, 0.0, 0.0 });
+					continue;
+				}
+
+				const ScalingRecord& run = it->second;
+				if (run.patternCount != base.patternCount) {
+					differences.push_back({ ScalingDifference::COUNT, entry.first,
+						(double)base.patternCount, (double)run.patternCount });
+				}
+				if (std::max(base.seconds, run.seconds) >= minSeconds && run.seconds > base.seconds * (1.0 + timeTolerance)) {
+					differences.push_back({ ScalingDifference::TIME, entry.first, base.seconds, run.seconds });
+				}
+			}
+			return differences;
+		}
+	};
+}
@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include <memory>
+#include <type_traits>
+#include "MonotonicArena.hpp"
 
 namespace mylib {
 	template<typename Value>
@@ -14,9 +16,21 @@ namespace mylib {
 			shared = source.shared;
 		}
 
+		SharedArrayPointer& operator=(const SharedArrayPointer<Value>& source) {
+			shared = source.shared;
+			return *this;
+		}
+
 		SharedArrayPointer(const unsigned int size) : shared(new Value[size], std::default_delete<Value[]>()) {
 		}
 
+		// the array and the reference counter are on the arena.
+		// every copy should be released before the arena is reset.
+		SharedArrayPointer(const unsigned int size, MonotonicArena& arena) :
+			shared(arena.allocateArray<Value>(size), [](Value*) {}, ArenaAllocator<Value>(&arena)) {
+			static_assert(std::is_trivially_destructible<Value>::value, "values on an arena are not destroyed.");
+		}
+
 		Value& operator[] (const unsigned int index) {
 			return shared.get()[index];
 		}
@@ -25,11 +39,11 @@ namespace mylib {
 			return shared.get()[index];
 		}
 
-		Value* getRawArray() {
+		Value* getRawArray() const {
 			return shared.get();
 		}
 
-		u_int useCount() {
+		u_int useCount() const {
 			return shared.use_count();
 		}
 	};
@@ -0,0 +1,517 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "abbreviation.h"
+#include "BitSet.hpp"
+#include "FlapPattern.hpp"
+#include "BinaryCPFormat.hpp"
+#include "IndexedCPFormat.hpp"
+#include "CPArchive.hpp"
+#include "EncoderStream.hpp"
+#include "ItemCountingStream.hpp"
+#include "MappedFile.hpp"
+
+namespace enumeration {
+	namespace origami {
+
+		// colex rank of r-subsets of {0, ..., n - 1}: rank({s_1 < s_2 < ... < s_r}) = sum_i C(s_i, i).
+		// the ranks of r-subsets are dense in [0, C(n, r)).
+		class CombinationRanker {
+		public:
+			static const u_int MAX_N = 64;
+
+		private:
+			struct Table {
+				uint64_t values[MAX_N + 1][MAX_N + 1];
+
+				Table() {
+					for (u_int n = 0; n <= MAX_N; n++) {
+						values[n][0] = 1;
+						for (u_int r = 1; r <= MAX_N; r++) {
+							values[n][r] = (n == 0) ? 0 : values[n - 1][r - 1] + values[n - 1][r];
+						}
+					}
+				}
+			};
+
+			static const Table& table() {
+				static const Table table_;
+				return table_;
+			}
+
+		public:
+			static uint64_t binomial(const u_int n, const u_int r) {
+				if (n > MAX_N) {
+					throw std::length_error("CombinationRanker: n is too large.");
+				}
+				return (r > n) ? 0 : table().values[n][r];
+			}
+
+			// items of subset should be less than n.
+			template <typename TSet>
+			static uint64_t rank(const TSet& subset, const u_int n) {
+				uint64_t rank_ = 0;
+				u_int i = 0;
+				for (u_int item = subset.findNext(0); item < n; item = subset.findNext(item + 1)) {
+					rank_ += binomial(item, ++i);
+				}
+				return rank_;
+			}
+
+			// adds the r-subset of rank to subset.
+			template <typename TSet>
+			static void unrank(uint64_t rank, const u_int n, u_int r, TSet& subset) {
+				if (rank >= binomial(n, r)) {
+					throw std::invalid_argument("CombinationRanker: rank is out of range.");
+				}
+				u_int item = n;
+				while (r > 0) {
+					do {
+						item--;
+					} while (binomial(item, r) > rank);
+
+					subset.add(item);
+					rank -= binomial(item, r);
+					r--;
+				}
+			}
+		};
+
+		/**
+		* File layout (integers are little endian):
+		*   BinaryCPHeader with magic "FCPR",
+		*   for each flap: flap key (as IndexedCPFormat), position of the first line (u8), #line (u8), #minor (u8),
+		*     kind (u8), #answer (varint), payload bytes (varint), payload,
+		*   index: (flap key, offset of the flap (u64)) sorted by flap key,
+		*   footer: offset of the index (u64), #flap (u64), "FCPR".
+		*
+		* The answers of a flap are the colex ranks of their minor line sets (by shrinked index).
+		* The payload is whichever is smaller of
+		*   BITMAP: bit r of byte r / 8 is set if rank r is an answer (C(#line, #minor) bits),
+		*   DELTA: ascending ranks as varints of the difference from the previous rank (the first from 0).
+		* A lookup of a rank is O(1) in a BITMAP flap and O(#answer) in a DELTA flap, which has to be decoded from the front.
+		*/
+		struct SuccinctCPFormat {
+			static const unsigned char BITMAP = 0;
+			static const unsigned char DELTA = 1;
+			static const size_t FOOTER_SIZE = 20;
+
+			static const char* magic() {
+				return "FCPR";
+			}
+
+			static size_t indexEntrySize(const u_int placeCount) {
+				return IndexedCPFormat::keySize(placeCount) + 8;
+			}
+
+			// payload of ascending unique ranks.
+			static unsigned char encode(const std::vector<uint64_t>& ranks, const uint64_t rankCount, std::string& payload) {
+				payload.clear();
+				uint64_t previous = 0;
+				for (auto rank : ranks) {
+					CPArchiveFormat::writeVarint(payload, rank - previous);
+					previous = rank;
+				}
+
+				const uint64_t bitmapSize = (rankCount + 7) / 8;
+				if (payload.size() <= bitmapSize) {
+					return DELTA;
+				}
+
+				payload.assign(bitmapSize, 0);
+				for (auto rank : ranks) {
+					payload[rank / 8] |= (char)(1 << (rank % 8));
+				}
+				return BITMAP;
+			}
+		};
+
+		// the answers of a flap given to SuccinctCPWriter. nothing is owned.
+		struct SuccinctCPRecord {
+			const unsigned char* key;
+			u_int firstLine;
+			u_int lineCount;
+			u_int minorCount;
+			// ascending and unique.
+			const std::vector<uint64_t>& ranks;
+
+			SuccinctCPRecord(const unsigned char* key, const u_int firstLine, const u_int lineCount, const u_int minorCount,
+				const std::vector<uint64_t>& ranks) :
+				key(key), firstLine(firstLine), lineCount(lineCount), minorCount(minorCount), ranks(ranks) {}
+		};
+
+		/**
+		* TOStream.add(#line, #answer, SuccinctCPRecord) once per flap.
+		* the flap is written by endFlap(), which FlapGroupingEncoderStream calls after the flap is enumerated.
+		*/
+		template<typename TOStream>
+		class SuccinctCPEncoder {
+			TOStream& outStream;
+			std::vector<unsigned char> key;
+			std::vector<uint64_t> ranks;
+			u_int minorCount;
+
+			void write(const EncodablePatternBase& flap) {
+				std::sort(ranks.begin(), ranks.end());
+				ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+				key.resize(IndexedCPFormat::keySize(flap.capacity()));
+				IndexedCPFormat::writeKey(flap, key.data());
+				u_int firstLine = flap.capacity();
+				flap.scanCP([](const u_int) {},
+					[&firstLine](const u_int i, const u_int) {
+						firstLine = std::min(firstLine, i);
+					});
+
+				outStream.add(flap.count() / 2 - 1, ranks.size(),
+					SuccinctCPRecord(key.data(), firstLine, flap.count(), minorCount, ranks));
+				ranks.clear();
+			}
+
+		public:
+			SuccinctCPEncoder(TOStream& os) : outStream(os), minorCount(0) {
+			}
+
+			// a flap without assignment: the only rank of the empty set.
+			void operator()(const EncodablePatternBase& flap) {
+				ranks.assign(1, 0);
+				minorCount = 0;
+				write(flap);
+			}
+
+			SuccinctCPEncoder& operator<<(const EncodablePatternBase& flap) {
+				(*this)(flap);
+				return *this;
+			}
+
+			template <typename TBitSet>
+			void operator()(const EncodablePatternBase& flap, const TBitSet& minors) {
+				if (ranks.empty()) {
+					minorCount = minors.count();
+				}
+				else if (minors.count() != minorCount) {
+					throw std::invalid_argument("SuccinctCPEncoder: #minor differs in a flap.");
+				}
+				ranks.push_back(CombinationRanker::rank(minors, flap.count()));
+			}
+
+			void endFlap(const EncodablePatternBase& flap) {
+				if (!ranks.empty()) {
+					write(flap);
+				}
+			}
+		};
+
+		template<typename TOStream>
+		struct EncoderStreamOf<SuccinctCPEncoder<TOStream> > {
+			typedef FlapGroupingEncoderStream<SuccinctCPEncoder<TOStream> > type;
+		};
+
+		// writes flaps and the index on close(). each flap should be given once.
+		class SuccinctCPWriter {
+			std::ostream& os;
+			const u_int placeCount;
+			const size_t keySize;
+			uint64_t offset;
+
+			std::vector<unsigned char> keys;
+			std::vector<uint64_t> offsets;
+			std::string block;
+			std::string payload;
+			bool closed;
+
+		public:
+			SuccinctCPWriter(std::ostream& os, const BinaryCPHeader& header) :
+				os(os), placeCount(header.placeCount), keySize(IndexedCPFormat::keySize(header.placeCount)),
+				offset(header.size()), closed(false) {
+				IndexedCPFormat::checkPlaceCount(header.placeCount);
+				header.write(os, SuccinctCPFormat::magic());
+			}
+
+			SuccinctCPWriter(const SuccinctCPWriter&) = delete;
+			SuccinctCPWriter& operator=(const SuccinctCPWriter&) = delete;
+
+			~SuccinctCPWriter() {
+				close();
+			}
+
+			SuccinctCPWriter& operator<<(const SuccinctCPRecord& record) {
+				if (record.lineCount > CombinationRanker::MAX_N || record.firstLine > 255) {
+					throw std::length_error("SuccinctCPWriter: too many lines.");
+				}
+				const unsigned char kind = SuccinctCPFormat::encode(record.ranks,
+					CombinationRanker::binomial(record.lineCount, record.minorCount), payload);
+
+				block.assign((const char*)record.key, keySize);
+				block += (char)record.firstLine;
+				block += (char)record.lineCount;
+				block += (char)record.minorCount;
+				block += (char)kind;
+				CPArchiveFormat::writeVarint(block, record.ranks.size());
+				CPArchiveFormat::writeVarint(block, payload.size());
+				block += payload;
+
+				keys.insert(keys.end(), record.key, record.key + keySize);
+				offsets.push_back(offset);
+				os.write(block.data(), block.size());
+				offset += block.size();
+				return *this;
+			}
+
+			// writes the index and the footer.
+			void close() {
+				if (closed) {
+					return;
+				}
+				closed = true;
+
+				std::vector<u_int> order(offsets.size());
+				for (u_int i = 0; i < order.size(); i++) {
+					order[i] = i;
+				}
+				std::sort(order.begin(), order.end(), [this](const u_int a, const u_int b) {
+					return std::memcmp(&keys[a * keySize], &keys[b * keySize], keySize) < 0;
+				});
+
+				const uint64_t indexOffset = offset;
+				for (auto i : order) {
+					os.write((const char*)&keys[i * keySize], keySize);
+					IndexedCPFormat::writeUInt64(os, offsets[i]);
+				}
+				IndexedCPFormat::writeUInt64(os, indexOffset);
+				IndexedCPFormat::writeUInt64(os, offsets.size());
+				os.write(SuccinctCPFormat::magic(), 4);
+				os.flush();
+			}
+
+			size_t flapCount() const {
+				return offsets.size();
+			}
+		};
+
+		// the answers of a flap in a SuccinctCPFile.
+		class FlapRanks {
+			const unsigned char* key;
+			u_int placeCount;
+			u_int firstLine;
+			u_int lineCount_;
+			u_int minorCount_;
+			unsigned char kind;
+			uint64_t count_;
+			const unsigned char* payload;
+			uint64_t payloadSize;
+
+		public:
+			FlapRanks() : key(nullptr), placeCount(0), firstLine(0), lineCount_(0), minorCount_(0),
+				kind(SuccinctCPFormat::DELTA), count_(0), payload(nullptr), payloadSize(0) {}
+
+			FlapRanks(const unsigned char* key, const u_int placeCount, const u_int firstLine, const u_int lineCount, const u_int minorCount,
+				const unsigned char kind, const uint64_t count, const unsigned char* payload, const uint64_t payloadSize) :
+				key(key), placeCount(placeCount), firstLine(firstLine), lineCount_(lineCount), minorCount_(minorCount),
+				kind(kind), count_(count), payload(payload), payloadSize(payloadSize) {}
+
+			const uint64_t& count() const {
+				return count_;
+			}
+
+			bool empty() const {
+				return count_ == 0;
+			}
+
+			const u_int& lineCount() const {
+				return lineCount_;
+			}
+
+			const u_int& minorCount() const {
+				return minorCount_;
+			}
+
+			bool isBitmap() const {
+				return kind == SuccinctCPFormat::BITMAP;
+			}
+
+			// O(1) for a bitmap. a delta list is decoded up to the first rank not less than rank, O(#answer) at worst.
+			bool contains(const uint64_t rank) const {
+				if (isBitmap()) {
+					return rank / 8 < payloadSize && (payload[rank / 8] >> (rank % 8)) & 1;
+				}
+				const unsigned char* p = payload;
+				const unsigned char* end = payload + payloadSize;
+				uint64_t r = 0;
+				while (p < end) {
+					r += CPArchiveFormat::readVarint(p, end);
+					if (r >= rank) {
+						return r == rank;
+					}
+				}
+				return false;
+			}
+
+			template <typename TSet>
+			bool contains(const TSet& minors) const {
+				return minors.count() == minorCount_ && contains(CombinationRanker::rank(minors, lineCount_));
+			}
+
+			// calls f(rank) in ascending order.
+			template <typename F>
+			void forEachRank(const F& f) const {
+				if (isBitmap()) {
+					for (uint64_t i = 0; i < payloadSize; i++) {
+						for (unsigned char bits = payload[i]; bits != 0; bits &= bits - 1) {
+							u_int bit = 0;
+							while (((bits >> bit) & 1) == 0) {
+								bit++;
+							}
+							f(8 * i + bit);
+						}
+					}
+					return;
+				}
+				const unsigned char* p = payload;
+				const unsigned char* end = payload + payloadSize;
+				uint64_t rank = 0;
+				while (p < end) {
+					rank += CPArchiveFormat::readVarint(p, end);
+					f(rank);
+				}
+			}
+
+			// EncodablePatternBase::encode(minors) of the minor set of rank.
+			std::string cpString(const uint64_t rank) const {
+				mylib::BitSet minors(std::max<u_int>(lineCount_, 1));
+				CombinationRanker::unrank(rank, lineCount_, minorCount_, minors);
+
+				std::string text;
+				if (firstLine > 0) {
+					text += std::to_string(firstLine);
+				}
+				u_int position = firstLine;
+				for (u_int k = 0; k < lineCount_; k++) {
+					text += minors.contains(k) ? '-' : '+';
+					const u_int gap = key[k];
+					const u_int next = std::min(position + gap, placeCount);
+					if (next > position + 1) {
+						text += std::to_string(next - position - 1);
+					}
+					position = next;
+				}
+				return text;
+			}
+		};
+
+		/**
+		* random access to a file written by SuccinctCPWriter.
+		* the file is memory mapped and find() binary-searches the index.
+		*/
+		class SuccinctCPFile {
+			mylib::MappedFile file;
+			BinaryCPHeader header_;
+			const unsigned char* index;
+			uint64_t flapCount_;
+			size_t keySize;
+			size_t entrySize;
+
+			void broken() const {
+				throw std::invalid_argument("SuccinctCPFile: broken file.");
+			}
+
+		public:
+			explicit SuccinctCPFile(const std::string& path) : file(path) {
+				const unsigned char* data = file.data();
+				const size_t size = file.size();
+				if (size < 4 + SuccinctCPFormat::FOOTER_SIZE) {
+					broken();
+				}
+
+				mylib::MemoryStreamBuffer buffer(data, size);
+				std::istream is(&buffer);
+				header_.read(is, SuccinctCPFormat::magic());
+				IndexedCPFormat::checkPlaceCount(header_.placeCount);
+
+				const unsigned char* footer = data + size - SuccinctCPFormat::FOOTER_SIZE;
+				if (std::memcmp(footer + 16, SuccinctCPFormat::magic(), 4) != 0) {
+					broken();
+				}
+				const uint64_t indexOffset = IndexedCPFormat::readUInt64(footer);
+				flapCount_ = IndexedCPFormat::readUInt64(footer + 8);
+
+				keySize = IndexedCPFormat::keySize(header_.placeCount);
+				entrySize = SuccinctCPFormat::indexEntrySize(header_.placeCount);
+				if (indexOffset < header_.size() || indexOffset > size - SuccinctCPFormat::FOOTER_SIZE ||
+					flapCount_ != (size - SuccinctCPFormat::FOOTER_SIZE - indexOffset) / entrySize) {
+					broken();
+				}
+				index = data + indexOffset;
+			}
+
+			const BinaryCPHeader& header() const {
+				return header_;
+			}
+
+			const uint64_t& flapCount() const {
+				return flapCount_;
+			}
+
+			// the key of the i-th flap in the key order.
+			const unsigned char* key(const uint64_t i) const {
+				return index + i * entrySize;
+			}
+
+			// empty if the flap has no answer in this file.
+			FlapRanks find(const unsigned char* flapKey) const {
+				uint64_t low = 0, high = flapCount_;
+				while (low < high) {
+					const uint64_t middle = low + (high - low) / 2;
+					if (std::memcmp(key(middle), flapKey, keySize) < 0) {
+						low = middle + 1;
+					}
+					else {
+						high = middle;
+					}
+				}
+				if (low == flapCount_ || std::memcmp(key(low), flapKey, keySize) != 0) {
+					return FlapRanks();
+				}
+
+				const unsigned char* end = index;
+				const unsigned char* p = file.data() + IndexedCPFormat::readUInt64(key(low) + keySize);
+				if (p + keySize + 4 > end) {
+					broken();
+				}
+				const unsigned char* blockKey = p;
+				p += keySize;
+				const u_int firstLine = p[0];
+				const u_int lineCount = p[1];
+				const u_int minorCount = p[2];
+				const unsigned char kind = p[3];
+				p += 4;
+				const uint64_t count = CPArchiveFormat::readVarint(p, end);
+				const uint64_t payloadSize = CPArchiveFormat::readVarint(p, end);
+				if (payloadSize > (uint64_t)(end - p) || lineCount > CombinationRanker::MAX_N) {
+					broken();
+				}
+				return FlapRanks(blockKey, header_.placeCount, firstLine, lineCount, minorCount, kind, count, p, payloadSize);
+			}
+
+			FlapRanks find(const EncodablePatternBase& flap) const {
+				if (flap.capacity() != header_.placeCount) {
+					throw std::invalid_argument("SuccinctCPFile: the flap has a different #place.");
+				}
+				std::vector<unsigned char> flapKey(keySize);
+				IndexedCPFormat::writeKey(flap, flapKey.data());
+				return find(flapKey.data());
+			}
+
+			// gaps between lines from the base point.
+			FlapRanks find(const std::vector<u_int>& gaps) const {
+				return find(IndexedCPFormat::createKey(gaps, header_.placeCount).data());
+			}
+		};
+	}
+}
@@ -0,0 +1,171 @@
+﻿#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+#include <mpi.h>
+
+namespace mylib {
+
+	// one span on the timeline of a process. times are in nanoseconds from the origin of the recorder.
+	struct TraceEvent {
+		enum Kind {
+			// master
+			GENERATE, WAIT_WORKER, SEND_JOB,
+			// worker
+			WAIT_JOB, RECEIVE_JOB, JOB,
+			KIND_COUNT
+		};
+
+		long long start;
+		long long duration;
+		int rank;
+		int kind;
+		// the process on the other side of the message.
+		int peer;
+		// bytes of the message, or the size of the job.
+		int value;
+
+		static const char* name(const int kind) {
+			static const char* const NAMES[KIND_COUNT] = {
+				"generate", "wait worker", "send job", "wait job", "receive job", "job"
+			};
+			return NAMES[kind];
+		}
+
+		static const char* valueName(const int kind) {
+			return (kind == JOB) ? "lines" : "bytes";
+		}
+	};
+
+	/**
+	 * Records TraceEvents of this process into memory.
+	 * TraceRecorder<false> records nothing and is optimized out.
+	 *
+	 * usage:
+	 * auto start = trace.now();
+	 * ... work ...
+	 * trace.record(TraceEvent::JOB, start, peer, value);
+	 */
+	template<bool enabled>
+	class TraceRecorder {
+		typedef std::chrono::steady_clock Clock;
+
+		Clock::time_point origin;
+		int rank;
+		std::vector<TraceEvent> events_;
+
+	public:
+		typedef Clock::time_point TimePoint;
+
+		// the origin should be taken just after a barrier so that the timelines of the processes are aligned.
+		explicit TraceRecorder(const int rank) : origin(Clock::now()), rank(rank) {
+			events_.reserve(1 << 12);
+		}
+
+		TimePoint now() const {
+			return Clock::now();
+		}
+
+		// the span from start to now.
+		void record(const int kind, const TimePoint& start, const int peer, const int value) {
+			const auto end = Clock::now();
+
+			TraceEvent event;
+			event.start = std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count();
+			event.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+			event.rank = rank;
+			event.kind = kind;
+			event.peer = peer;
+			event.value = value;
+			events_.push_back(event);
+		}
+
+		const std::vector<TraceEvent>& events() const {
+			return events_;
+		}
+	};
+
+	template<>
+	class TraceRecorder<false> {
+	public:
+		struct TimePoint {};
+
+		explicit TraceRecorder(const int) {
+		}
+
+		TimePoint now() const {
+			return TimePoint();
+		}
+
+		void record(const int, const TimePoint&, const int, const int) {
+		}
+
+		const std::vector<TraceEvent>& events() const {
+			static const std::vector<TraceEvent> empty;
+			return empty;
+		}
+	};
+
+	/**
+	 * Writes TraceEvents in the chrome trace event format (JSON),
+	 * which chrome://tracing and Perfetto can open.
+	 * each rank is shown as a thread of one process.
+	 */
+	class ChromeTraceWriter {
+	public:
+		// gathers the events of all processes to root. the result is empty except on root.
+		static std::vector<TraceEvent> gather(const std::vector<TraceEvent>& events, const int root) {
+			int myID, processCount;
+			MPI_Comm_rank(MPI_COMM_WORLD, &myID);
+			MPI_Comm_size(MPI_COMM_WORLD, &processCount);
+
+			int byteCount = (int)(events.size() * sizeof(TraceEvent));
+			std::vector<int> byteCounts(processCount);
+			MPI_Gather(&byteCount, 1, MPI_INT, byteCounts.data(), 1, MPI_INT, root, MPI_COMM_WORLD);
+
+			std::vector<int> displacements(processCount, 0);
+			int totalBytes = 0;
+			for (int i = 0; i < processCount; i++) {
+				displacements[i] = totalBytes;
+				totalBytes += byteCounts[i];
+			}
+
+			std::vector<TraceEvent> gathered((myID == root) ? totalBytes / sizeof(TraceEvent) : 0);
+			MPI_Gatherv(events.data(), byteCount, MPI_BYTE,
+				gathered.data(), byteCounts.data(), displacements.data(), MPI_BYTE, root, MPI_COMM_WORLD);
+
+			return gathered;
+		}
+
+		static void write(std::ostream& os, const std::vector<TraceEvent>& events, const int processCount, const int masterID = 0) {
+			os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+			const char* separator = "\n";
+			for (int rank = 0; rank < processCount; rank++) {
+				os << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << rank
+					<< ",\"args\":{\"name\":\"rank " << rank << (rank == masterID ? " (master)" : "") << "\"}}";
+				separator = ",\n";
+			}
+
+			// microseconds with nanosecond digits.
+			auto writeMicro = [&](const long long nanoSec) {
+				os << nanoSec / 1000 << "." << (char)('0' + nanoSec / 100 % 10) << (char)('0' + nanoSec / 10 % 10)
+					<< (char)('0' + nanoSec % 10);
+			};
+
+			for (const auto& event : events) {
+				os << separator << "{\"name\":\"" << TraceEvent::name(event.kind) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.rank
+					<< ",\"ts\":";
+				writeMicro(event.start);
+				os << ",\"dur\":";
+				writeMicro(event.duration);
+				os << ",\"args\":{\"peer\":" << event.peer << ",\"" << TraceEvent::valueName(event.kind) << "\":" << event.value << "}}";
+				separator = ",\n";
+			}
+
+			os << "\n]}\n";
+		}
+	};
+}
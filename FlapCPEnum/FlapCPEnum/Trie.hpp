@@ -3,6 +3,13 @@
 #include <string>
 #include <map>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <limits>
+#include "abbreviation.h"
 
 namespace mylib {
 	class Trie {
@@ -383,5 +390,278 @@ namespace mylib {
 		}
 	};
 
+
+	/**
+	 * Patricia trie whose nodes and labels are allocated from chunked arenas.
+	 * A node is 16 bytes: its label is a slice of the label arena (splitting does not copy
+	 * characters) and its children form a sibling list sorted by their first characters.
+	 *
+	 * clear() forgets all keys in O(1) and keeps the chunks for the next use; release() frees them.
+	 * The interface follows FingerprintSet so that it can be used as a cache of strings,
+	 * but keys are compared exactly and canHold() needs the key length.
+	 * Allocation beyond byteLimit throws std::length_error; use canHold() before a search.
+	 */
+	class ArenaPatriciaTrie {
+		typedef u_int NodeIndex;
+
+		struct Node {
+			u_int labelOffset;
+			uint16_t labelLength;
+			uint8_t isEndOfWord;
+			char firstChar;
+			NodeIndex firstChild;
+			NodeIndex nextSibling;
+		};
+
+		// the root is 0 and is never a child, so 0 also means "no node".
+		static const NodeIndex ROOT = 0;
+		static const NodeIndex NIL = 0;
+
+		static const u_int NODE_CHUNK_BITS = 12;
+		static const u_int NODE_CHUNK_SIZE = 1u << NODE_CHUNK_BITS;
+		static const u_int LABEL_CHUNK_BITS = 16;
+		static const u_int LABEL_CHUNK_SIZE = 1u << LABEL_CHUNK_BITS;
+
+		std::vector<std::unique_ptr<Node[]> > nodeChunks;
+		std::vector<std::unique_ptr<char[]> > labelChunks;
+
+		u_int nodeCount = 0;
+		// offset where the next label is written.
+		u_int labelEnd = 0;
+
+		size_t count_ = 0;
+		size_t byteLimit_;
+
+		Node& node(const NodeIndex index) {
+			return nodeChunks[index >> NODE_CHUNK_BITS][index & (NODE_CHUNK_SIZE - 1)];
+		}
+		const Node& node(const NodeIndex index) const {
+			return nodeChunks[index >> NODE_CHUNK_BITS][index & (NODE_CHUNK_SIZE - 1)];
+		}
+
+		const char *labelOf(const Node& n) const {
+			return &labelChunks[n.labelOffset >> LABEL_CHUNK_BITS][n.labelOffset & (LABEL_CHUNK_SIZE - 1)];
+		}
+
+		static size_t nodeChunkBytes() {
+			return NODE_CHUNK_SIZE * sizeof(Node);
+		}
+
+		void reserveBytes(const size_t bytes) const {
+			if (memoryUsage() + bytes > byteLimit_) {
+				throw std::length_error("ArenaPatriciaTrie: memory limit exceeded.");
+			}
+		}
+
+		NodeIndex newNode() {
+			if ((nodeCount >> NODE_CHUNK_BITS) == nodeChunks.size()) {
+				reserveBytes(nodeChunkBytes());
+				nodeChunks.emplace_back(new Node[NODE_CHUNK_SIZE]);
+			}
+
+			Node& n = node(nodeCount);
+			n.labelOffset = 0;
+			n.labelLength = 0;
+			n.isEndOfWord = 0;
+			n.firstChar = 0;
+			n.firstChild = NIL;
+			n.nextSibling = NIL;
+
+			return nodeCount++;
+		}
+
+		// a label never straddles chunks.
+		u_int appendLabel(const char *data, const size_t length) {
+			if ((labelEnd & (LABEL_CHUNK_SIZE - 1)) + length > LABEL_CHUNK_SIZE) {
+				labelEnd = ((labelEnd >> LABEL_CHUNK_BITS) + 1) << LABEL_CHUNK_BITS;
+			}
+			if ((labelEnd >> LABEL_CHUNK_BITS) == labelChunks.size()) {
+				reserveBytes(LABEL_CHUNK_SIZE);
+				labelChunks.emplace_back(new char[LABEL_CHUNK_SIZE]);
+			}
+
+			const auto offset = labelEnd;
+			std::memcpy(&labelChunks[offset >> LABEL_CHUNK_BITS][offset & (LABEL_CHUNK_SIZE - 1)], data, length);
+			labelEnd += (u_int)length;
+
+			return offset;
+		}
+
+		// cuts the label of the given node at prefixLength; the rest becomes its only child.
+		void splitNode(const NodeIndex index, const u_int prefixLength) {
+			const auto restIndex = newNode();
+			Node& n = node(index);
+			Node& rest = node(restIndex);
+
+			rest.labelOffset = n.labelOffset + prefixLength;
+			rest.labelLength = n.labelLength - prefixLength;
+			rest.firstChar = labelOf(n)[prefixLength];
+			rest.isEndOfWord = n.isEndOfWord;
+			rest.firstChild = n.firstChild;
+
+			n.labelLength = prefixLength;
+			n.isEndOfWord = 0;
+			n.firstChild = restIndex;
+		}
+
+		static size_t chunkCountFor(const size_t itemCount, const size_t chunkCapacity) {
+			return (itemCount + chunkCapacity - 1) / chunkCapacity;
+		}
+
+	public:
+		// keys should not be longer than this.
+		static const size_t MAX_KEY_LENGTH = 0xffff;
+
+		ArenaPatriciaTrie(const size_t byteLimit = std::numeric_limits<size_t>::max()) : byteLimit_(byteLimit) {
+			clear();
+		}
+
+		// true if keyCount keys of the given length can be stored under the memory limit.
+		// an insertion adds at most 2 nodes and keyLength label characters.
+		bool canHold(const size_t keyCount, const size_t keyLength) const {
+			if (keyLength > MAX_KEY_LENGTH) {
+				return false;
+			}
+			const auto nodeBytes = chunkCountFor(1 + 2 * keyCount, NODE_CHUNK_SIZE) * nodeChunkBytes();
+			const auto labelBytes = (keyLength == 0) ? 0 :
+				chunkCountFor(keyCount, LABEL_CHUNK_SIZE / keyLength) * (size_t)LABEL_CHUNK_SIZE;
+
+			return nodeBytes + labelBytes <= byteLimit_;
+		}
+
+		bool contains(const char *key, const size_t length) const {
+			NodeIndex current = ROOT;
+			size_t position = 0;
+
+			while (position < length) {
+				const char c = key[position];
+				NodeIndex child = node(current).firstChild;
+				while (child != NIL && node(child).firstChar < c) {
+					child = node(child).nextSibling;
+				}
+				if (child == NIL || node(child).firstChar != c) {
+					return false;
+				}
+
+				const Node& n = node(child);
+				if (length - position < n.labelLength
+					|| std::memcmp(labelOf(n), key + position, n.labelLength) != 0) {
+					return false;
+				}
+
+				current = child;
+				position += n.labelLength;
+			}
+
+			return node(current).isEndOfWord != 0;
+		}
+
+		// return: false if key already exists.
+		bool insert(const char *key, const size_t length) {
+			if (length > MAX_KEY_LENGTH) {
+				throw std::length_error("ArenaPatriciaTrie: too long key.");
+			}
+
+			NodeIndex current = ROOT;
+			size_t position = 0;
+
+			while (position < length) {
+				const char c = key[position];
+
+				NodeIndex prev = NIL;
+				NodeIndex child = node(current).firstChild;
+				while (child != NIL && node(child).firstChar < c) {
+					prev = child;
+					child = node(child).nextSibling;
+				}
+
+				// put key suffix to a new leaf
+				if (child == NIL || node(child).firstChar != c) {
+					const auto labelOffset = appendLabel(key + position, length - position);
+					const auto leafIndex = newNode();
+					Node& leaf = node(leafIndex);
+
+					leaf.labelOffset = labelOffset;
+					leaf.labelLength = (uint16_t)(length - position);
+					leaf.firstChar = c;
+					leaf.isEndOfWord = 1;
+					leaf.nextSibling = child;
+
+					if (prev == NIL) {
+						node(current).firstChild = leafIndex;
+					}
+					else {
+						node(prev).nextSibling = leafIndex;
+					}
+
+					count_++;
+					return true;
+				}
+
+				// prefix matching
+				const Node& n = node(child);
+				const char *label = labelOf(n);
+				u_int prefixLength = 1;
+				while (prefixLength < n.labelLength && position + prefixLength < length
+					&& label[prefixLength] == key[position + prefixLength]) {
+					prefixLength++;
+				}
+
+				if (prefixLength < n.labelLength) {
+					splitNode(child, prefixLength);
+				}
+
+				current = child;
+				position += prefixLength;
+			}
+
+			// existing node represents the given key
+			Node& n = node(current);
+			if (n.isEndOfWord) {
+				return false;
+			}
+			n.isEndOfWord = 1;
+			count_++;
+			return true;
+		}
+
+		template<typename TString>
+		bool contains(const TString& key) const {
+			return contains(key.data(), key.size());
+		}
+
+		template<typename TString>
+		bool insert(const TString& key) {
+			return insert(key.data(), key.size());
+		}
+
+		// forgets all keys. chunks are kept for reuse.
+		void clear() {
+			nodeCount = 0;
+			labelEnd = 0;
+			count_ = 0;
+			newNode();
+		}
+
+		// forgets all keys and frees the chunks except one for the root.
+		void release() {
+			nodeChunks.resize(1);
+			labelChunks.clear();
+			clear();
+		}
+
+		const size_t& count() const {
+			return count_;
+		}
+
+		const size_t& byteLimit() const {
+			return byteLimit_;
+		}
+
+		// bytes of allocated chunks.
+		size_t memoryUsage() const {
+			return nodeChunks.size() * nodeChunkBytes() + labelChunks.size() * (size_t)LABEL_CHUNK_SIZE;
+		}
+	};
 }
 
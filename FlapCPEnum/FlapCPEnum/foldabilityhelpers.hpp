@@ -1,13 +1,14 @@
 ﻿#pragma once
 #include <algorithm>
 #include <vector>
-#include <deque>
 #include <sstream>
 #include <set>
 
 #include "RingList.hpp"
+#include "CompactRing.hpp"
 #include "BitSet.hpp"
 #include "SharedArrayPointer.hpp"
+#include "inverters.hpp"
 
 namespace enumeration {
 	namespace origami {
@@ -115,10 +116,41 @@ namespace enumeration {
 				return isMinimalAngle(prev, center, next);
 			}
 
+			template<u_int MAX_SIZE>
+			bool isMinimalToBeFolded(const CompactLineGapRing<MAX_SIZE>& ring, const int& index) const {
+				const auto center = ring.angleToNext(index);
+
+				return ring.angleToNext(ring.prevIndexOf(index)) >= center
+					&& ring.angleToNext(ring.nextIndexOf(index)) >= center
+					&& ring.lineType(index) != ring.lineType(ring.nextIndexOf(index));
+			}
+
+			// the first index to be folded from startIndex on. -1 if no such index.
+			// TRing is RingArrayList<LineGap> or CompactLineGapRing.
+			template <typename TRing>
+			int findMinimalToBeFolded(const TRing& ring, const int startIndex) const {
+				int index = startIndex;
+
+				for (u_int i = 0; i < ring.count(); i++) {
+					if (isMinimalToBeFolded(ring, index)) {
+						return index;
+					}
+					index = ring.nextIndexOf(index);
+				}
+
+				return -1;
+			}
+
 			template <typename TIntStack>
 			TIntStack findMinimalIndices(const mylib::RingArrayList<LineGap>& ring, bool angleOnly = false) const {
 				TIntStack minimals;
+				appendMinimalIndices(ring, minimals, angleOnly);
+
+				return minimals;
+			}
 
+			template <typename TIntStack>
+			void appendMinimalIndices(const mylib::RingArrayList<LineGap>& ring, TIntStack& minimals, bool angleOnly = false) const {
 				int index = ring.peekHeadIndex();
 
 				for (u_int i = 0; i < ring.count(); i++) {
@@ -132,7 +164,6 @@ namespace enumeration {
 					}
 					index = ring.nextIndexOf(index);
 				}
-				return minimals;
 			}
 
 			// return : prev. index which holds merged value.
@@ -155,6 +186,20 @@ namespace enumeration {
 				return prevIndex;
 			}
 
+			// same as foldPartially() for RingArrayList.
+			template<u_int MAX_SIZE>
+			int foldPartially(CompactLineGapRing<MAX_SIZE>& ring, const int& index) const {
+				const int nextIndex = ring.nextIndexOf(index);
+				const int prevIndex = ring.prevIndexOf(index);
+
+				ring.angleToNext(prevIndex) += ring.angleToNext(nextIndex) - ring.angleToNext(index);
+
+				ring.remove(nextIndex);
+				ring.remove(index);
+
+				return prevIndex;
+			}
+
 			void reverseCrease(mylib::RingArrayList<LineGap>& ring, const int& index) const {
 				auto& crease = ring[index].lineType;
 				if (crease == Crease::MAJOR)
@@ -211,6 +256,23 @@ namespace enumeration {
 				const mylib::SharedArrayPointer<u_int>& map) const {
 
 				mylib::RingArrayList<LineGap> ring(placeCount);
+				resetRingArray(ring, placeCount, lineCount, assignments, map);
+
+				return ring;
+
+			}
+
+			// same as createRingArray() but overwrites the given ring in place.
+			// ring.size() should be placeCount; no memory is allocated then.
+			template<typename TSet_Assignment>
+			void resetRingArray(
+				mylib::RingArrayList<LineGap>& ring,
+				const u_int& placeCount,
+				const u_int& lineCount,
+				const TSet_Assignment& assignments,
+				const mylib::SharedArrayPointer<u_int>& map) const {
+
+				ring.clear();
 
 				for (u_int i = 0; i < lineCount; i++) {
 					LineGap lineGap;
@@ -221,9 +283,24 @@ namespace enumeration {
 				}
 
 				ring.makeLinks();
+			}
 
-				return ring;
+			// a ring of UNDEF lines with the angles of the flap.
+			// copy it and assign line types to get the ring of an assignment.
+			template<u_int MAX_SIZE>
+			void resetRingArray(
+				CompactLineGapRing<MAX_SIZE>& ring,
+				const u_int& placeCount,
+				const u_int& lineCount,
+				const mylib::SharedArrayPointer<u_int>& map) const {
+
+				ring.resize(lineCount);
 
+				for (u_int i = 0; i < lineCount; i++) {
+					ring.set(i, (placeCount + map[(i + 1) % lineCount] - map[i]) % placeCount, Crease::UNDEF);
+				}
+
+				ring.makeLinks();
 			}
 
 			template<char FLAT, char MAJOR, char MINOR, typename TCharArray>
@@ -345,17 +422,39 @@ namespace enumeration {
 		};
 
 
+		// a stack of minimal angle indices without duplication.
+		// the storage is kept over reset() in order to avoid memory allocation.
 		class MinimalAngleIndexManager {
-			std::deque<int> minimals;
+			std::vector<int> minimals;
 			mylib::BitSet isInMinimals;
 			FoldabilityRingArrayHelper helper;
 
 		public:
 
+			MinimalAngleIndexManager() : isInMinimals(0) {}
+
 			MinimalAngleIndexManager(
-				const mylib::RingArrayList<LineGap>& ring, bool angleOnly = false) : isInMinimals(ring.count()) {
+				const mylib::RingArrayList<LineGap>& ring, bool angleOnly = false) : isInMinimals(ring.size()) {
+
+				reset(ring, angleOnly);
+			}
+
+			// makes reset() on rings up to ringSize allocation-free.
+			void reserve(const u_int ringSize) {
+				if (isInMinimals.capacity() < ringSize) {
+					isInMinimals = mylib::BitSet(ringSize);
+					minimals.reserve(ringSize);
+				}
+			}
+
+			void reset(const mylib::RingArrayList<LineGap>& ring, bool angleOnly = false) {
+				reserve(ring.size());
+
+				while (!empty()) {
+					pop();
+				}
 
-				minimals = helper.findMinimalIndices<std::deque<int> >(ring, angleOnly);
+				helper.appendMinimalIndices(ring, minimals, angleOnly);
 
 				//initialize
 				for (auto& index : minimals) {
@@ -39,15 +39,20 @@ namespace enumeration {
 			TSet operator()(const TSet& pattern) const {
 				TSet inverse(pattern.capacity());
 
-				for (u_int i = 0; i < placeCount; i++) {
-					if (pattern.contains(i)) {
-						inverse.add((*this)(i));
-					}
+				for (u_int i = pattern.findNext(0); i < placeCount; i = pattern.findNext(i + 1)) {
+					inverse.add((*this)(i));
 				}
 
 				return inverse;
 			}
 
+			mylib::BitSet operator()(const mylib::BitSet& pattern) const {
+				mylib::BitSet inverse(pattern);
+				inverse.rotateToLower(amount);
+
+				return inverse;
+			}
+
 			virtual bool reversesOrder() const {
 				return false;
 			}
@@ -86,15 +91,22 @@ namespace enumeration {
 			TSet operator()(const TSet& pattern) const {
 				TSet inverse(pattern.capacity());
 
-				for (u_int i = 0; i < placeCount; i++) {
-					if (pattern.contains(i)) {
-						inverse.add((*this)(i));
-					}
+				for (u_int i = pattern.findNext(0); i < placeCount; i = pattern.findNext(i + 1)) {
+					inverse.add((*this)(i));
 				}
 
 				return inverse;
 			}
 
+			// i -> 2 * axis - i: reverse, then rotate.
+			mylib::BitSet operator()(const mylib::BitSet& pattern) const {
+				mylib::BitSet inverse(pattern);
+				inverse.reverse();
+				inverse.rotateToLower((placeCount - (2 * axis + 1) % placeCount) % placeCount);
+
+				return inverse;
+			}
+
 			virtual bool reversesOrder() const {
 				return true;
 			}
@@ -129,15 +141,22 @@ namespace enumeration {
 			TSet operator()(const TSet& pattern) const {
 				TSet inverse(pattern.capacity());
 
-				for (u_int i = 0; i < placeCount; i++) {
-					if (pattern.contains(i)) {
-						inverse.add((*this)(i));
-					}
+				for (u_int i = pattern.findNext(0); i < placeCount; i = pattern.findNext(i + 1)) {
+					inverse.add((*this)(i));
 				}
 
 				return inverse;
 			}
 
+			// i -> 2 * priorOfAxis + 1 - i: reverse, then rotate.
+			mylib::BitSet operator()(const mylib::BitSet& pattern) const {
+				mylib::BitSet inverse(pattern);
+				inverse.reverse();
+				inverse.rotateToLower((placeCount - (2 * priorOfAxis + 2) % placeCount) % placeCount);
+
+				return inverse;
+			}
+
 			virtual bool reversesOrder() const {
 				return true;
 			}
@@ -206,7 +225,7 @@ namespace enumeration {
 		const u_int FAILED = std::numeric_limits<u_int>::max();
 
 		MappedIndexInverter(const MappedIndexInverter& source) : 
-			inverter(source.inverter), mapSize(source.valueSize), valueSize(source.valueSize), reverseMap(source.reverseMap) {
+			inverter(source.inverter), mapSize(source.mapSize), valueSize(source.valueSize), reverseMap(source.reverseMap) {
 			indexMap = source.indexMap;
 
 			//reverseMap = new u_int[valueSize];
@@ -230,6 +249,15 @@ namespace enumeration {
 			}
 		}
 
+		/**
+		 * shares reverseMap: y -> x, or FAILED if y is not in the map.
+		 * the reverse map does not depend on inv, so the inverters of a flap can share one.
+		 */
+		MappedIndexInverter(const TInverter& inv, u_int placeCount, const mylib::SharedArrayPointer<u_int>& indexMap,
+			const mylib::SharedArrayPointer<u_int>& reverseMap, u_int keyCount) :
+			inverter(inv), indexMap(indexMap), mapSize(keyCount), valueSize(placeCount), reverseMap(reverseMap) {
+		}
+
 		bool canInvert() {
 			for (u_int i = 0; i < mapSize; i++) {
 				if ((*this)(i) == FAILED) {
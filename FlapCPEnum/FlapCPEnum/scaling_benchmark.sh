@@ -0,0 +1,45 @@
+#!/bin/sh
+# sweeps n, algorithms and process counts, appends every run to a report,
+# and compares the report with a baseline report if it is given.
+#
+# usage: scaling_benchmark.sh executable report(.csv|.json) [baselineReport [timeTolerance]]
+#
+# the sweep can be changed by environment variables:
+#   PLACE_COUNTS      n to run (default: 8 12 16 20 24)
+#   SERIAL_ALGORITHMS algorithms run with one process
+#   PARALLEL_ALGORITHMS algorithms run with each of PROCESS_COUNTS (master + workers)
+#   PROCESS_COUNTS    (default: 2 3 5 9)
+#   MPIEXEC           (default: mpiexec)
+
+if [ $# -lt 2 ]; then
+	echo "usage: $0 executable report [baselineReport [timeTolerance]]" >&2
+	exit 1
+fi
+
+EXECUTABLE=$1
+REPORT=$2
+BASELINE=$3
+TOLERANCE=${4:-0.1}
+
+PLACE_COUNTS=${PLACE_COUNTS:-"8 12 16 20 24"}
+SERIAL_ALGORITHMS=${SERIAL_ALGORITHMS:-"kawasaki maekawa maekawa_revolving cp cp_revolving cp_linearMV cp_linearMVTrie cp_MVLSL cp_ExMVLSL cp_crimpPruning cp_memo cp_adaptive cp_batch"}
+PARALLEL_ALGORITHMS=${PARALLEL_ALGORITHMS:-"cp_parallel cp_exLSLparallel cp_crimpParallel maekawa_parallel"}
+PROCESS_COUNTS=${PROCESS_COUNTS:-"2 3 5 9"}
+MPIEXEC=${MPIEXEC:-mpiexec}
+
+for n in $PLACE_COUNTS; do
+	for algorithm in $SERIAL_ALGORITHMS; do
+		echo "$algorithm n=$n np=1"
+		$MPIEXEC -n 1 "$EXECUTABLE" "$n" "$algorithm" "report=$REPORT" > /dev/null || exit 1
+	done
+	for algorithm in $PARALLEL_ALGORITHMS; do
+		for np in $PROCESS_COUNTS; do
+			echo "$algorithm n=$n np=$np"
+			$MPIEXEC -n "$np" "$EXECUTABLE" "$n" "$algorithm" "report=$REPORT" > /dev/null || exit 1
+		done
+	done
+done
+
+if [ -n "$BASELINE" ]; then
+	$MPIEXEC -n 1 "$EXECUTABLE" compare "$BASELINE" "$REPORT" "$TOLERANCE"
+fi
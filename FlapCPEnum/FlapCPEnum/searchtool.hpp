@@ -7,14 +7,15 @@ namespace mylib {
 	struct EnumerationStats {
 		unsigned long long int callCount, validCallCount, answerCount;
 
-		EnumerationStats() : callCount(0ULL), validCallCount(0ULL), answerCount(0ULL) {}
+		// for answer detecters with memo.
+		unsigned long long int memoHitCount, memoMissCount;
+
+		EnumerationStats() : callCount(0ULL), validCallCount(0ULL), answerCount(0ULL),
+			memoHitCount(0ULL), memoMissCount(0ULL) {}
 
 		EnumerationStats operator+(const EnumerationStats& right) const {
 			auto result = *this;
-
-			result.callCount += right.callCount;
-			result.validCallCount += right.validCallCount;
-			result.answerCount += right.answerCount;
+			result += right;
 
 			return result;
 		}
@@ -23,6 +24,8 @@ namespace mylib {
 			callCount += right.callCount;
 			validCallCount += right.validCallCount;
 			answerCount += right.answerCount;
+			memoHitCount += right.memoHitCount;
+			memoMissCount += right.memoMissCount;
 		}
 
 		long double searchEfficiency() const {
@@ -33,10 +36,18 @@ namespace mylib {
 			return (long double)validCallCount / callCount;
 		}
 
+		// 0 when no lookup was made.
+		long double memoHitRate() const {
+			const auto lookupCount = memoHitCount + memoMissCount;
+			return (lookupCount == 0) ? 0.0L : (long double)memoHitCount / lookupCount;
+		}
+
 		void clear() {
 			validCallCount = 0ULL;
 			callCount = 0ULL; 
 			answerCount = 0ULL;
+			memoHitCount = 0ULL;
+			memoMissCount = 0ULL;
 		}
 	};
 
@@ -46,6 +57,11 @@ namespace mylib {
 	class IPruningSuggester {
 	public:
 		virtual bool needPruning(const TSet_Assignment& pattern, int depth) const = 0;
+
+		// no node deeper than this is visited on a pattern of itemCount items.
+		virtual int maxDepth(const int itemCount) const {
+			return itemCount;
+		}
 	};
 
 	template<typename TSet_Assignment>
@@ -0,0 +1,120 @@
+﻿#include "gtest/gtest.h"
+
+#include "IsFoldable.hpp"
+#include "FlapPattern.hpp"
+#include "BitSet.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// counts the calls of the global operator new while counting is on.
+// the replacement applies to the whole test program, but only counts inside AllocationCounter scopes.
+namespace {
+	std::atomic<bool> countsAllocation(false);
+	std::atomic<long long> allocationCount(0);
+
+	class AllocationCounter {
+	public:
+		AllocationCounter() {
+			allocationCount = 0;
+			countsAllocation = true;
+		}
+
+		~AllocationCounter() {
+			countsAllocation = false;
+		}
+
+		long long count() const {
+			return allocationCount;
+		}
+	};
+}
+
+void* operator new(std::size_t size) {
+	if (countsAllocation) {
+		allocationCount++;
+	}
+	void* p = std::malloc(size == 0 ? 1 : size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+namespace {
+	using namespace enumeration::origami;
+	using namespace mylib;
+
+	class AllocationCountTest : public ::testing::Test {
+	protected:
+		const u_int lineCount = 10;
+		FlapPatternForBraceletEnum flap;
+		std::vector<BitSet> assignmentsList;
+
+		AllocationCountTest() : flap(16) {
+			const u_int places[] = { 0, 1, 2, 3, 4, 5, 6, 8, 10, 13 };
+			for (const auto& place : places) {
+				flap.add(place);
+			}
+
+			// every assignment of the flap, made before counting.
+			for (u_int bits = 0; bits < (1u << lineCount); bits++) {
+				BitSet assignments(lineCount);
+				for (u_int i = 0; i < lineCount; i++) {
+					if (bits & (1u << i)) {
+						assignments.add(i);
+					}
+				}
+				assignmentsList.push_back(assignments);
+			}
+		}
+
+		// the detecter allocates its scratch ring on construction and reuses it in every call.
+		template<typename TDetecter>
+		void assertNoAllocationAfterConstruction() {
+			TDetecter detecter(flap);
+
+			int foldableCount = 0;
+			long long count = 0;
+			{
+				AllocationCounter counter;
+				for (const auto& assignments : assignmentsList) {
+					foldableCount += detecter.isAnswer(assignments) ? 1 : 0;
+				}
+				count = counter.count();
+			}
+
+			ASSERT_LT(0, foldableCount);
+			ASSERT_EQ(0, count);
+		}
+	};
+
+	TEST_F(AllocationCountTest, testCounterCountsNew) {
+		std::vector<int> values;
+		long long count = 0;
+		{
+			AllocationCounter counter;
+			values.reserve(100);
+			count = counter.count();
+		}
+		ASSERT_EQ(1, count);
+		ASSERT_LE(100u, values.capacity());
+	}
+
+	TEST_F(AllocationCountTest, testIsFoldableDoesNotAllocate) {
+		assertNoAllocationAfterConstruction<IsFoldable<BitSet> >();
+	}
+
+	TEST_F(AllocationCountTest, testIsFoldableLinearDoesNotAllocate) {
+		assertNoAllocationAfterConstruction<IsFoldableLinear<BitSet> >();
+	}
+}
@@ -0,0 +1,107 @@
+﻿#include "gtest/gtest.h"
+#include "AsyncWriter.hpp"
+#include "BinaryCPFormat.hpp"
+#include <sstream>
+#include <string>
+#include <stdexcept>
+
+namespace {
+	using namespace mylib;
+
+	std::string createText(const size_t size) {
+		std::string text(size, ' ');
+		for (size_t i = 0; i < size; i++) {
+			text[i] = (char)('a' + (i * 7) % 26);
+		}
+		return text;
+	}
+
+	TEST(AsyncWriterTest, testRingWrapsAround) {
+		ASSERT_THROW(SPSCByteRing ring(12), std::invalid_argument);
+
+		SPSCByteRing ring(8);
+		const std::string text = createText(20);
+
+		std::string actual;
+		size_t written = 0;
+		while (actual.size() < text.size()) {
+			written += ring.tryWrite(text.data() + written, std::min<size_t>(5, text.size() - written));
+			ASSERT_GE(ring.capacity(), ring.size());
+
+			const char* data;
+			const size_t n = ring.peek(data);
+			actual.append(data, std::min<size_t>(n, 3));
+			ring.consume(std::min<size_t>(n, 3));
+		}
+		ASSERT_EQ(text, actual);
+		ASSERT_EQ(0, ring.size());
+
+		// full
+		ASSERT_EQ(8, ring.tryWrite(text.data(), 10));
+		ASSERT_EQ(0, ring.tryWrite(text.data(), 1));
+	}
+
+	TEST(AsyncWriterTest, testWritesEveryByteInOrder) {
+		const std::string text = createText(100000);
+
+		std::stringstream ss;
+		{
+			// much smaller than the text: write() has to wait for the writer thread.
+			AsyncWriter writer(ss, 64);
+			for (size_t i = 0; i < text.size(); i += 37) {
+				writer.write(text.data() + i, std::min<size_t>(37, text.size() - i));
+			}
+			writer.close();
+
+			ASSERT_LT(0ULL, writer.stallCount());
+			ASSERT_LE(0.0, writer.stallSeconds());
+		}
+		ASSERT_EQ(text, ss.str());
+	}
+
+	// write() waiting for space wakes up and throws when the writer thread fails.
+	TEST(AsyncWriterTest, testFailedStreamThrows) {
+		const std::string text = createText(100000);
+
+		std::stringstream ss;
+		ss.setstate(std::ios::badbit);
+		AsyncWriter writer(ss, 64);
+		ASSERT_THROW({
+			for (size_t i = 0; i < text.size(); i += 37) {
+				writer.write(text.data() + i, std::min<size_t>(37, text.size() - i));
+			}
+			writer.close();
+		}, std::runtime_error);
+	}
+
+	TEST(AsyncWriterTest, testStreamBufferKeepsBinaryFormat) {
+		using namespace enumeration::origami;
+
+		const std::string text = createText(1000);
+		const BinaryCPHeader header(12, "cp", 0);
+
+		std::stringstream expected;
+		{
+			BinaryCPWriter writer(expected, header, 16);
+			for (size_t i = 0; i + 3 <= text.size(); i += 3) {
+				writer << BinaryCPRecord((const unsigned char*)text.data() + i, 3);
+			}
+		}
+
+		std::stringstream actual;
+		{
+			AsyncWriter async(actual, 256);
+			AsyncWriterBuffer buffer(async, 100);
+			std::ostream os(&buffer);
+			{
+				BinaryCPWriter writer(os, header, 16);
+				for (size_t i = 0; i + 3 <= text.size(); i += 3) {
+					writer << BinaryCPRecord((const unsigned char*)text.data() + i, 3);
+				}
+			}
+			os.flush();
+			async.close();
+		}
+		ASSERT_EQ(expected.str(), actual.str());
+	}
+}
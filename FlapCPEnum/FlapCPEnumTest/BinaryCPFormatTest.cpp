@@ -0,0 +1,124 @@
+﻿#include "gtest/gtest.h"
+#include "BinaryCPFormat.hpp"
+#include "FlapCPEnumeration.hpp"
+#include "BitSet.hpp"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace enumeration;
+	using namespace enumeration::origami;
+
+	class BinaryCPFormatTest : public ::testing::Test {
+	protected:
+		struct StringCollector {
+			std::vector<std::string> cpStrings;
+
+			template<typename TKey>
+			StringCollector& operator<<(const Countable<TKey, CPStringView>& item) {
+				cpStrings.push_back(item.value);
+				return *this;
+			}
+		};
+
+		struct RecordCollector {
+			BinaryCPWriter& writer;
+
+			RecordCollector(BinaryCPWriter& writer) : writer(writer) {}
+
+			template<typename TKey>
+			RecordCollector& operator<<(const Countable<TKey, BinaryCPRecord>& item) {
+				writer << item.value;
+				return *this;
+			}
+		};
+	};
+
+	TEST_F(BinaryCPFormatTest, testDecodeMatchesCPString) {
+		const u_int placeCount = 13;
+
+		// the base point is not 0.
+		FlapPatternForBraceletEnum flap(placeCount);
+		const u_int lines[] = { 3, 4, 7, 8, 11, 12 };
+		for (const auto& line : lines) {
+			flap.add(line);
+		}
+
+		mylib::BitSet minors(flap.count());
+		minors.add(1);
+		minors.add(4);
+
+		std::vector<unsigned char> bytes(flap.binarySize());
+		ASSERT_EQ(4, bytes.size());
+
+		flap.encodeBinary(minors, bytes.data());
+		ASSERT_EQ(flap.encode(minors), BinaryCPReader::decode(bytes.data(), placeCount));
+
+		flap.encodeBinary(bytes.data());
+		ASSERT_EQ(flap.encode(), BinaryCPReader::decode(bytes.data(), placeCount));
+	}
+
+	TEST_F(BinaryCPFormatTest, testHeaderRoundTrip) {
+		std::stringstream ss;
+		{
+			BinaryCPWriter writer(ss, BinaryCPHeader(24, "cp_linearMV", 3));
+		}
+
+		BinaryCPReader reader(ss);
+		ASSERT_EQ(24, reader.header().placeCount);
+		ASSERT_EQ(3, reader.header().rank);
+		ASSERT_EQ("cp_linearMV", reader.header().algorithm);
+		ASSERT_EQ(6, reader.header().recordSize());
+
+		std::string cpString;
+		ASSERT_FALSE(reader.next(cpString));
+
+		std::stringstream broken("FCPX");
+		ASSERT_THROW(BinaryCPReader brokenReader(broken), std::invalid_argument);
+	}
+
+	TEST_F(BinaryCPFormatTest, testEnumerationWritesTheSamePatterns) {
+		const u_int placeCount = 12;
+
+		StringCollector expected;
+		{
+			FoldableFlapCPEnumeration<false> enumerator;
+			CPStringEncoder<StringCollector> encoder(expected);
+			enumerator.enumerate(placeCount, encoder);
+		}
+		ASSERT_LT(0, expected.cpStrings.size());
+
+		std::stringstream file;
+		{
+			// small buffer: records are flushed many times.
+			BinaryCPWriter writer(file, BinaryCPHeader(placeCount, "cp", 0), 16);
+			RecordCollector records(writer);
+
+			FoldableFlapCPEnumeration<false> enumerator;
+			BinaryCPEncoder<RecordCollector> encoder(records);
+			enumerator.enumerate(placeCount, encoder);
+
+			ASSERT_EQ(expected.cpStrings.size(), writer.recordCount());
+		}
+
+		BinaryCPReader reader(file);
+		std::vector<std::string> actual;
+		std::string cpString;
+		while (reader.next(cpString)) {
+			actual.push_back(cpString);
+		}
+
+		ASSERT_EQ(expected.cpStrings, actual);
+	}
+
+	TEST_F(BinaryCPFormatTest, testTruncatedRecordThrows) {
+		std::stringstream file;
+		BinaryCPHeader(8, "cp", 0).write(file);
+		file.write("\x01", 1);
+
+		BinaryCPReader reader(file);
+		std::string cpString;
+		ASSERT_THROW(reader.next(cpString), std::invalid_argument);
+	}
+}
@@ -49,4 +49,90 @@ namespace {
 		ASSERT_TRUE(result.areAllZero(length / 4 *3, length));
 
 	}
+
+	TEST(BitArrayCalcTest, CompoundOpTest) {
+		const int length = 200;
+		BitArray b1(length);
+		BitArray b2(length);
+
+		b1.fillOne(0, length / 2);
+		b2.fillOne(length / 4, length);
+
+		BitArray andResult(b1);
+		andResult &= b2;
+		ASSERT_TRUE(andResult.areAllZero(0, length / 4));
+		ASSERT_TRUE(andResult.areAllOne(length / 4, length / 2));
+		ASSERT_TRUE(andResult.areAllZero(length / 2, length));
+		ASSERT_EQ(length / 4, andResult.countOnes());
+
+		BitArray orResult(b1);
+		orResult |= b2;
+		ASSERT_TRUE(orResult.areAllOne(0, length));
+
+		BitArray xorResult(b1);
+		xorResult ^= b2;
+		ASSERT_TRUE(xorResult == (b1 ^ b2));
+		ASSERT_EQ(length / 4 * 3, xorResult.countOnes());
+	}
+
+	TEST(BitArrayCalcTest, MoveTest) {
+		// inline (<= 128 bits) and heap storage
+		for (const int length : { 16, 128, 129, 300 }) {
+			BitArray source(length);
+			source.setOne(0);
+			source.setOne(length - 1);
+			const BitArray expected(source);
+
+			BitArray moved(std::move(source));
+			ASSERT_TRUE(moved == expected) << length;
+			ASSERT_EQ(0u, source.bitLength()) << length;
+
+			BitArray assigned(8);
+			assigned = std::move(moved);
+			ASSERT_EQ((unsigned int)length, assigned.bitLength()) << length;
+			ASSERT_TRUE(assigned.isOne(0)) << length;
+			ASSERT_TRUE(assigned.isOne(length - 1)) << length;
+			ASSERT_TRUE(assigned.areAllZero(1, length - 1)) << length;
+		}
+	}
+
+	TEST(BitArrayCalcTest, RotateOddLengthTest) {
+		for (const unsigned int length : { 22u, 64u, 70u, 128u, 131u, 200u, 257u }) {
+			for (unsigned int amount = 0; amount < length; amount++) {
+				BitArray bits(length);
+				for (unsigned int i = 0; i < length; i += 5) {
+					bits.setOne(i);
+				}
+
+				bits.rotateToLower(amount);
+
+				for (unsigned int i = 0; i < length; i++) {
+					ASSERT_EQ((i + amount) % length % 5 == 0, bits.isOne(i))
+						<< "length: " << length << " amount: " << amount << " index: " << i;
+				}
+			}
+		}
+	}
+
+	TEST(BitArrayCalcTest, ReverseOddLengthTest) {
+		for (const unsigned int length : { 1u, 22u, 63u, 64u, 65u, 70u, 128u, 131u, 200u, 257u }) {
+			BitArray bits(length);
+			unsigned int seed = length;
+			for (unsigned int i = 0; i < length; i++) {
+				seed = seed * 1103515245u + 12345u;
+				if ((seed >> 16) & 1) {
+					bits.setOne(i);
+				}
+			}
+			const BitArray original(bits);
+
+			bits.reverse();
+
+			ASSERT_EQ(original.countOnes(), bits.countOnes()) << "length: " << length;
+			for (unsigned int i = 0; i < length; i++) {
+				ASSERT_EQ(original.isOne(length - 1 - i), bits.isOne(i))
+					<< "length: " << length << " index: " << i;
+			}
+		}
+	}
 }
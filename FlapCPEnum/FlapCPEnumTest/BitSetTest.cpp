@@ -2,6 +2,7 @@
 
 #include "BitSet.hpp"
 #include "SetTestBase.hpp"
+#include <vector>
 
 namespace {
 	using namespace mylib;
@@ -60,4 +61,48 @@ namespace {
 
 		
 	}
+
+	TEST_F(BitSetTest, testSetBitIteration) {
+		const unsigned int capacity = 150;
+		BitSet bitset(capacity);
+		std::vector<unsigned int> items = { 0, 3, 63, 64, 100, 149 };
+		for (auto item : items) {
+			bitset.add(item);
+		}
+
+		ASSERT_EQ(0u, bitset.findNext(0));
+		ASSERT_EQ(63u, bitset.findNext(4));
+		ASSERT_EQ(64u, bitset.findNext(64));
+		ASSERT_EQ(149u, bitset.findNext(101));
+		ASSERT_EQ(capacity, bitset.findNext(150));
+
+		std::vector<unsigned int> visited;
+		bitset.forEachItem([&visited](unsigned int i) { visited.push_back(i); });
+		ASSERT_EQ(items, visited);
+
+		std::vector<unsigned int> iterated;
+		for (auto item : bitset) {
+			iterated.push_back(item);
+		}
+		ASSERT_EQ(items, iterated);
+
+		BitSet empty(capacity);
+		ASSERT_EQ(capacity, empty.findNext(0));
+		ASSERT_TRUE(empty.begin() == empty.end());
+	}
+
+	TEST_F(BitSetTest, testReverse) {
+		for (const unsigned int capacity : { 16u, 70u, 150u }) {
+			BitSet bitset(capacity);
+			for (unsigned int i = 0; i < capacity; i += 7) {
+				bitset.add(i);
+			}
+
+			bitset.reverse();
+
+			for (unsigned int i = 0; i < capacity; i++) {
+				ASSERT_EQ((capacity - 1 - i) % 7 == 0, bitset.contains(i)) << capacity << " " << i;
+			}
+		}
+	}
 }
@@ -0,0 +1,271 @@
+﻿#include "gtest/gtest.h"
+#include "CPArchive.hpp"
+#include "CPArchiveMerger.hpp"
+#include "BinaryCPFormat.hpp"
+#include "FlapCPEnumeration.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+	using namespace enumeration;
+	using namespace enumeration::origami;
+
+	class CPArchiveTest : public ::testing::Test {
+	protected:
+		const std::string archivePath = "CPArchiveTest.cpa";
+		std::vector<std::string> inputPaths;
+
+		virtual void TearDown() {
+			std::remove(archivePath.c_str());
+			for (const auto& path : inputPaths) {
+				std::remove(path.c_str());
+			}
+		}
+
+		static bool fileExists(const std::string& path) {
+			return (bool)std::ifstream(path);
+		}
+
+		static void makeDirectory(const std::string& path) {
+#ifdef _MSC_VER
+			_mkdir(path.c_str());
+#else
+			mkdir(path.c_str(), 0755);
+#endif
+		}
+
+		static void removeDirectory(const std::string& path) {
+#ifdef _MSC_VER
+			_rmdir(path.c_str());
+#else
+			std::remove(path.c_str());
+#endif
+		}
+
+		std::vector<std::string> readArchive() {
+			CPArchiveReader reader(archivePath);
+			std::vector<std::string> cpStrings;
+			reader.forEach([&cpStrings](const std::string& cpString) {
+				cpStrings.push_back(cpString);
+			});
+			return cpStrings;
+		}
+
+		struct StringCollector {
+			std::vector<std::string> cpStrings;
+
+			template<typename TKey>
+			StringCollector& operator<<(const Countable<TKey, CPStringView>& item) {
+				cpStrings.push_back(item.value);
+				return *this;
+			}
+		};
+	};
+
+	TEST_F(CPArchiveTest, testBlocksAreFrontCodedAndIndependent) {
+		std::vector<std::string> expected = { "+", "++2-", "++2-+", "++3", "+-", "-", "-+1", "1++", "10-+" };
+		std::sort(expected.begin(), expected.end());
+
+		{
+			std::ofstream fout(archivePath, std::ios::binary);
+			CPArchiveWriter writer(fout, 4);
+			for (const auto& cpString : expected) {
+				writer << cpString;
+			}
+			ASSERT_THROW(writer << std::string("+"), std::invalid_argument);
+		}
+
+		CPArchiveReader reader(archivePath);
+		ASSERT_EQ(expected.size(), reader.patternCount());
+		ASSERT_EQ(3, reader.blockCount());
+		ASSERT_EQ(1, reader.blockPatternCount(2));
+
+		// the last block alone.
+		std::vector<std::string> lastBlock;
+		reader.forEachInBlock(2, [&lastBlock](const std::string& cpString) {
+			lastBlock.push_back(cpString);
+		});
+		ASSERT_EQ(std::vector<std::string>{ expected.back() }, lastBlock);
+
+		ASSERT_EQ(expected, readArchive());
+	}
+
+	TEST_F(CPArchiveTest, testIndexFindsBlocks) {
+		// the first 15 blocks have the same first key since the patterns share more than FIRST_KEY_SIZE characters.
+		std::vector<std::string> expected;
+		for (int i = 0; i < 200; i++) {
+			const std::string prefix = (i < 120) ? std::string(30, '+') : std::to_string(i % 7) + "-";
+			expected.push_back(prefix + std::to_string(1000 + i));
+		}
+		std::sort(expected.begin(), expected.end());
+
+		{
+			std::ofstream fout(archivePath, std::ios::binary);
+			CPArchiveWriter writer(fout, 8);
+			for (const auto& cpString : expected) {
+				writer << cpString;
+			}
+		}
+
+		CPArchiveReader reader(archivePath);
+		ASSERT_EQ(25, reader.blockCount());
+		ASSERT_EQ(expected[0].substr(0, CPArchiveFormat::FIRST_KEY_SIZE), reader.blockFirstKey(0));
+		ASSERT_EQ(expected[8 * 24], reader.blockFirstKey(24));
+
+		for (size_t k = 0; k < expected.size(); k++) {
+			const auto blocks = reader.findBlocks(expected[k]);
+			ASSERT_LE(blocks.first, k / 8) << expected[k];
+			ASSERT_GT(blocks.second, k / 8) << expected[k];
+			ASSERT_TRUE(reader.contains(expected[k])) << expected[k];
+		}
+		// one block unless the key is shared.
+		const auto blocks = reader.findBlocks(expected.back());
+		ASSERT_EQ(1, blocks.second - blocks.first);
+
+		for (const auto& absent : { std::string(""), std::string("+"), std::string(30, '+'), expected[5] + "0", std::string("9") }) {
+			ASSERT_FALSE(reader.contains(absent)) << absent;
+		}
+	}
+
+	TEST_F(CPArchiveTest, testFileWriterReplacesOnlyOnCommit) {
+		const std::string temporaryPath = archivePath + ".tmp";
+		{
+			std::ofstream old(archivePath);
+			old << "old";
+		}
+
+		// not committed: the old file is kept.
+		{
+			CPArchiveFileWriter file(archivePath, 4);
+			file.archive() << "+" << "-";
+			ASSERT_TRUE(fileExists(temporaryPath));
+		}
+		ASSERT_FALSE(fileExists(temporaryPath));
+		{
+			std::ifstream old(archivePath);
+			std::string text;
+			old >> text;
+			ASSERT_EQ("old", text);
+		}
+
+		{
+			CPArchiveFileWriter file(archivePath, 4);
+			file.archive() << "+" << "-";
+			file.commit();
+		}
+		ASSERT_FALSE(fileExists(temporaryPath));
+		ASSERT_EQ((std::vector<std::string>{ "+", "-" }), readArchive());
+	}
+
+	TEST_F(CPArchiveTest, testWriterThrowsIfTheStreamFails) {
+		std::ostringstream failed;
+		failed.setstate(std::ios::badbit);
+		ASSERT_THROW(CPArchiveWriter writer(failed), std::runtime_error);
+
+		// a directory cannot be opened as a file.
+		const std::string directory = "CPArchiveTest_directory";
+		makeDirectory(directory + ".tmp");
+		ASSERT_THROW(CPArchiveFileWriter file(directory), std::runtime_error);
+		removeDirectory(directory + ".tmp");
+	}
+
+	TEST_F(CPArchiveTest, testMergeSortsEveryInput) {
+		const u_int placeCount = 14;
+
+		StringCollector collector;
+		{
+			FoldableFlapCPEnumeration<false> enumerator;
+			CPStringEncoder<StringCollector> encoder(collector);
+			enumerator.enumerate(placeCount, encoder);
+		}
+		std::vector<std::string> expected = collector.cpStrings;
+		ASSERT_LT(100, expected.size());
+
+		// two text files and a binary file, like outputs of ranks.
+		const size_t third = expected.size() / 3;
+		inputPaths = { "CPArchiveTest_ID_0.txt", "CPArchiveTest_ID_1.txt", "CPArchiveTest_ID_2.cpb" };
+		{
+			std::ofstream text0(inputPaths[0]);
+			std::ofstream text1(inputPaths[1]);
+			for (size_t i = 0; i < 2 * third; i++) {
+				((i % 2 == 0) ? text0 : text1) << expected[i] << '\n';
+			}
+
+			std::ofstream binaryFile(inputPaths[2], std::ios::binary);
+			BinaryCPWriter writer(binaryFile, BinaryCPHeader(placeCount, "cp", 2));
+			for (size_t i = 2 * third; i < expected.size(); i++) {
+				const std::string& cpString = expected[i];
+				// back to the binary record.
+				std::vector<unsigned char> bytes((2 * placeCount + 7) / 8, 0);
+				u_int place = 0;
+				for (size_t c = 0; c < cpString.size(); ) {
+					if (cpString[c] == '+' || cpString[c] == '-') {
+						const unsigned char code = (cpString[c] == '+') ? EncodablePatternBase::BINARY_MAJOR : EncodablePatternBase::BINARY_MINOR;
+						bytes[place / 4] |= code << (2 * (place % 4));
+						place++;
+						c++;
+					}
+					else {
+						size_t length = 0;
+						place += std::stoi(cpString.substr(c), &length);
+						c += length;
+					}
+				}
+				writer << BinaryCPRecord(bytes.data(), bytes.size());
+			}
+		}
+
+		{
+			std::ofstream fout(archivePath, std::ios::binary);
+			CPArchiveWriter archive(fout, 16);
+			// a few KB: many runs and several merge passes.
+			CPArchiveMerger merger(archivePath, 4096, 2);
+			merger.merge(inputPaths, archive);
+
+			ASSERT_EQ(expected.size(), merger.inputPatternCount());
+			ASSERT_LT(4, merger.runCount());
+		}
+
+		std::sort(expected.begin(), expected.end());
+		ASSERT_EQ(expected, readArchive());
+	}
+
+	TEST_F(CPArchiveTest, testFailedMergeRemovesRuns) {
+		inputPaths = { "CPArchiveTest_ID_0.txt" };
+		{
+			std::ofstream text(inputPaths[0]);
+			for (const auto& cpString : { "--", "+-", "++", "-", "+" }) {
+				text << cpString << '\n';
+			}
+		}
+
+		// one run per pattern: run0 to run4. the first pass merges them into run5, run6 and run7.
+		// a directory at run6 makes the pass fail after run5 is written.
+		const std::string prefix = "CPArchiveTest_merge";
+		const std::string blocked = prefix + ".run6";
+		makeDirectory(blocked);
+		{
+			std::ofstream fout(archivePath, std::ios::binary);
+			CPArchiveWriter archive(fout, 16);
+			CPArchiveMerger merger(prefix, 1, 2);
+			ASSERT_THROW(merger.merge(inputPaths, archive), std::runtime_error);
+			ASSERT_EQ(7, (int)merger.runCount());
+		}
+		removeDirectory(blocked);
+
+		for (int i = 0; i < 8; i++) {
+			const std::string path = prefix + ".run" + std::to_string(i);
+			ASSERT_FALSE(path != blocked && fileExists(path)) << path;
+		}
+	}
+}
@@ -0,0 +1,106 @@
+﻿#include "gtest/gtest.h"
+#include "CPStringWriter.hpp"
+#include "FlapCPEnumeration.hpp"
+#include "BitSet.hpp"
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace enumeration;
+	using namespace enumeration::origami;
+
+	class CPStringWriterTest : public ::testing::Test {
+	protected:
+		// collects encode(minors) of every answer.
+		struct ReferenceEncoder {
+			std::vector<std::string> cpStrings;
+
+			void operator()(const EncodablePatternBase& flap) {
+				cpStrings.push_back(flap.encode());
+			}
+
+			template <typename TBitSet>
+			void operator()(const EncodablePatternBase& flap, const TBitSet& minors) {
+				cpStrings.push_back(flap.encode(minors));
+			}
+		};
+
+		struct StringCollector {
+			std::vector<std::string> cpStrings;
+
+			template<typename TKey>
+			StringCollector& operator<<(const Countable<TKey, CPStringView>& item) {
+				cpStrings.push_back(item.value);
+				return *this;
+			}
+		};
+	};
+
+	TEST_F(CPStringWriterTest, testEveryAssignmentMatchesEncode) {
+		const u_int placeCount = 13;
+
+		// the base point is not 0.
+		FlapPatternForBraceletEnum flap(placeCount);
+		const u_int lines[] = { 3, 4, 7, 8, 11, 12 };
+		for (const auto& line : lines) {
+			flap.add(line);
+		}
+
+		CPStringWriter writer;
+		ASSERT_EQ(flap.encode(), std::string(writer.write(flap)));
+
+		for (u_int bits = 0; bits < (1u << flap.count()); bits++) {
+			mylib::BitSet minors(flap.count());
+			for (u_int k = 0; k < flap.count(); k++) {
+				if (bits & (1u << k)) {
+					minors.add(k);
+				}
+			}
+			ASSERT_EQ(flap.encode(minors), std::string(writer.write(flap, minors)));
+		}
+	}
+
+	TEST_F(CPStringWriterTest, testCacheIsKeptUntilInvalidated) {
+		const u_int placeCount = 250;
+
+		// runs of 1, 2 and 3 digits.
+		FlapPatternForBraceletEnum flap(placeCount);
+		const u_int lines[] = { 2, 4, 15, 16, 130, 249 };
+		for (const auto& line : lines) {
+			flap.add(line);
+		}
+
+		CPStringWriter writer;
+		mylib::BitSet minors(flap.count());
+		minors.add(2);
+		ASSERT_EQ(flap.encode(minors), std::string(writer.write(flap, minors)));
+
+		// the same object with another line: the cache is kept until invalidated.
+		const std::string before = flap.encode(minors);
+		flap.remove(249);
+		flap.add(248);
+		ASSERT_EQ(before, std::string(writer.write(flap, minors)));
+
+		writer.invalidate();
+		ASSERT_EQ(flap.encode(minors), std::string(writer.write(flap, minors)));
+		ASSERT_EQ(flap.encode(), std::string(writer.write(flap)));
+	}
+
+	TEST_F(CPStringWriterTest, testEncoderWritesTheSameStringsAsEncode) {
+		const u_int placeCount = 14;
+
+		ReferenceEncoder expected;
+		{
+			FoldableFlapCPEnumeration<false> enumerator;
+			enumerator.enumerate(placeCount, expected);
+		}
+		ASSERT_LT(0, expected.cpStrings.size());
+
+		StringCollector actual;
+		{
+			FoldableFlapCPEnumeration<false> enumerator;
+			enumerator.enumerateCPString(placeCount, actual);
+		}
+		ASSERT_EQ(expected.cpStrings, actual.cpStrings);
+	}
+}
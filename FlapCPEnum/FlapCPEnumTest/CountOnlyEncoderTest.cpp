@@ -0,0 +1,44 @@
+﻿#include "gtest/gtest.h"
+#include "FlapCPEnumeration.hpp"
+#include "ItemCountingStream.hpp"
+#include <type_traits>
+
+namespace {
+	using namespace enumeration;
+	using namespace enumeration::origami;
+
+	TEST(CountOnlyEncoderTest, testCountingStreamIsSelected) {
+		typedef ItemCountingStream<> Stream;
+
+		ASSERT_TRUE((std::is_same<CountingEncoderStream<CountOnlyEncoder<Stream> >,
+			EncoderStreamOf<CountOnlyEncoder<Stream> >::type>::value));
+		ASSERT_TRUE((std::is_same<FlapGroupingEncoderStream<CPStringEncoder<Stream> >,
+			EncoderStreamOf<CPStringEncoder<Stream> >::type>::value));
+	}
+
+	TEST(CountOnlyEncoderTest, testCountsAreTheSameAsEncodedOnes) {
+		const u_int placeCount = 16;
+		const int size = placeCount / 2;
+
+		// every answer is passed to the stream.
+		ItemCountingStream<> expected(size);
+		{
+			FoldableFlapCPEnumeration<false> enumerator;
+			CPStringEncoder<ItemCountingStream<> > encoder(expected);
+			enumerator.enumerate(placeCount, encoder);
+		}
+		ASSERT_LT(0ULL, expected.total());
+
+		// answers are added once per flap.
+		ItemCountingStream<> actual(size);
+		{
+			FoldableFlapCPEnumeration<false> enumerator;
+			CountOnlyEncoder<ItemCountingStream<> > encoder(actual);
+			enumerator.enumerate(placeCount, encoder);
+		}
+
+		for (int i = 0; i < size; i++) {
+			ASSERT_EQ(expected.count(i), actual.count(i));
+		}
+	}
+}
@@ -0,0 +1,88 @@
+﻿#include "gtest/gtest.h"
+#include "FingerprintSet.hpp"
+#include <string>
+
+namespace {
+
+	class FingerprintSetTest : public ::testing::Test {
+	};
+
+	TEST(FingerprintSetTest, testInsertAndFind) {
+		std::string keys[] = { "the", "a", "there",
+			"answer", "any", "by",
+			"bye", "their" };
+		int n = sizeof(keys) / sizeof(keys[0]);
+
+		mylib::FingerprintSet<> fingerprints(1 << 20);
+
+		for (int i = 0; i < n; i++)
+			ASSERT_TRUE(fingerprints.insert(keys[i]));
+
+		// second insertion fails
+		ASSERT_FALSE(fingerprints.insert(std::string("the")));
+
+		ASSERT_TRUE(fingerprints.contains(std::string("the")));
+		ASSERT_FALSE(fingerprints.contains(std::string("these")));
+		ASSERT_EQ(n, fingerprints.count());
+	}
+
+	TEST(FingerprintSetTest, testGrowthUnderLimit) {
+		const size_t byteLimit = 1 << 16;
+		mylib::FingerprintSet<mylib::Fingerprint64> fingerprints(byteLimit);
+
+		// 8192 slots of 8 bytes: 4096 keys at most.
+		ASSERT_TRUE(fingerprints.canHold(4096));
+		ASSERT_FALSE(fingerprints.canHold(4097));
+
+		for (int i = 0; i < 4096; i++) {
+			ASSERT_TRUE(fingerprints.insert(std::to_string(i)));
+		}
+		for (int i = 0; i < 4096; i++) {
+			ASSERT_TRUE(fingerprints.contains(std::to_string(i)));
+		}
+		ASSERT_LE(fingerprints.memoryUsage(), byteLimit);
+
+		ASSERT_THROW(fingerprints.insert(std::string("overflow")), std::length_error);
+
+		fingerprints.clear();
+		ASSERT_EQ(0, fingerprints.count());
+		ASSERT_FALSE(fingerprints.contains(std::string("0")));
+	}
+
+	TEST(FingerprintSetTest, testSmallLimitSizesTheTable) {
+		// 32 slots of 8 bytes: 16 keys at most.
+		mylib::FingerprintSet<mylib::Fingerprint64> fingerprints(256);
+		ASSERT_GE(256u, fingerprints.memoryUsage());
+		ASSERT_TRUE(fingerprints.canHold(16));
+		ASSERT_FALSE(fingerprints.canHold(17));
+
+		for (int i = 0; i < 16; i++) {
+			ASSERT_TRUE(fingerprints.insert(std::to_string(i)));
+		}
+		ASSERT_THROW(fingerprints.insert(std::string("overflow")), std::length_error);
+
+		// nothing can be stored, and only one slot is allocated.
+		mylib::FingerprintSet<> empty(0);
+		ASSERT_EQ(sizeof(mylib::Fingerprint128), empty.memoryUsage());
+		ASSERT_FALSE(empty.canHold(1));
+		ASSERT_FALSE(empty.contains(std::string("key")));
+		ASSERT_THROW(empty.insert(std::string("key")), std::length_error);
+	}
+
+	TEST(FingerprintSetTest, testClearKeepsTheTable) {
+		mylib::FingerprintSet<> fingerprints(1 << 20);
+		for (int i = 0; i < 2000; i++) {
+			ASSERT_TRUE(fingerprints.insert(std::to_string(i)));
+		}
+		const size_t grown = fingerprints.memoryUsage();
+
+		fingerprints.clear();
+		ASSERT_EQ(0, fingerprints.count());
+		ASSERT_EQ(grown, fingerprints.memoryUsage());
+		for (int i = 0; i < 2000; i++) {
+			ASSERT_FALSE(fingerprints.contains(std::to_string(i)));
+		}
+		ASSERT_TRUE(fingerprints.insert(std::string("0")));
+		ASSERT_EQ(grown, fingerprints.memoryUsage());
+	}
+}
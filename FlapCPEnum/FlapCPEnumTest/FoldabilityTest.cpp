@@ -1,7 +1,13 @@
 ﻿#include "gtest/gtest.h"
 
 #include "IsFoldable.hpp"
+#include "BitSlicedFoldability.hpp"
+#include "FoldabilityBenchmark.hpp"
 #include "FlapPattern.hpp"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
 
 namespace {
 	using namespace enumeration::origami;
@@ -40,4 +46,200 @@ namespace {
 
 		ASSERT_TRUE(isFoldable.isAnswer(assignments));
 	}
+
+	// detecters reuse their rings; results should not depend on the previous call.
+	TEST_F(FoldabilityTest, reusedDetectersAgreeWithFreshOnes) {
+		FlapPatternForBraceletEnum flap(16);
+
+		const u_int places[] = { 0, 1, 2, 3, 4, 5, 6, 8, 10, 13 };
+		for (const auto& place : places) {
+			flap.add(place);
+		}
+
+		IsFoldable<mylib::BitSet> reusedQuadratic(flap);
+		IsFoldableLinear<mylib::BitSet> reusedLinear(flap);
+
+		int foldableCount = 0;
+		for (u_int bits = 0; bits < (1u << 10); bits++) {
+			BitSet assignments(10);
+			for (u_int i = 0; i < 10; i++) {
+				if (bits & (1u << i)) {
+					assignments.add(i);
+				}
+			}
+
+			IsFoldable<mylib::BitSet> fresh(flap);
+			const auto expected = fresh.isAnswer(assignments);
+
+			ASSERT_EQ(expected, reusedQuadratic.isAnswer(assignments)) << assignments.toString();
+			ASSERT_EQ(expected, reusedLinear.isAnswer(assignments)) << assignments.toString();
+
+			if (expected)
+				foldableCount++;
+		}
+
+		ASSERT_LT(0, foldableCount);
+	}
+
+	// flaps with more lines than the compact ring holds use the RingArrayList path.
+	TEST_F(FoldabilityTest, largeFlapAgreesWithIsFoldableLinear) {
+		const u_int placeCount = 48;
+		const u_int lineCount = 40;
+		FlapPatternForBraceletEnum flap(placeCount);
+		for (u_int i = 0; i < placeCount; i++) {
+			if (i % 6 != 5) {
+				flap.add(i);
+			}
+		}
+
+		IsFoldable<mylib::BitSet> quadratic(flap);
+		IsFoldableLinear<mylib::BitSet> linear(flap);
+
+		std::mt19937 random(1);
+		const int trialCount = 2000;
+		int foldableCount = 0;
+		for (int trial = 0; trial < trialCount; trial++) {
+			// maekawa: #minor = #line / 2 - 1.
+			std::vector<u_int> lines(lineCount);
+			std::iota(lines.begin(), lines.end(), 0);
+			std::shuffle(lines.begin(), lines.end(), random);
+
+			BitSet assignments(lineCount);
+			for (u_int i = 0; i < lineCount / 2 - 1; i++) {
+				assignments.add(lines[i]);
+			}
+
+			const auto expected = linear.isAnswer(assignments);
+			ASSERT_EQ(expected, quadratic.isAnswer(assignments)) << assignments.toString();
+			if (expected)
+				foldableCount++;
+		}
+
+		ASSERT_LT(0, foldableCount);
+		ASSERT_LT(foldableCount, trialCount);
+	}
+
+	TEST_F(FoldabilityTest, memoizedAgreesWithIsFoldable) {
+		FlapPatternForBraceletEnum flap(16);
+
+		const u_int halfPlaces[] = { 0, 1, 2, 4, 7 };
+		for (const auto& place : halfPlaces) {
+			flap.add(place);
+			flap.add(place + 8);
+		}
+		const u_int lineCount = 10;
+
+		IsFoldable<mylib::BitSet> expectedTester(flap);
+		MemoizedIsFoldable<mylib::BitSet> memoized(flap);
+		// nothing is stored.
+		MemoizedIsFoldable<mylib::BitSet> noMemo(flap, 0);
+
+		// no lookup yet.
+		ASSERT_EQ(0.0L, memoized.detecterStats().memoHitRate());
+
+		for (u_int bits = 0; bits < (1u << lineCount); bits++) {
+			BitSet assignments(lineCount);
+			for (u_int i = 0; i < lineCount; i++) {
+				if (bits & (1u << i)) {
+					assignments.add(i);
+				}
+			}
+
+			const auto expected = expectedTester.isAnswer(assignments);
+			ASSERT_EQ(expected, memoized.isAnswer(assignments)) << assignments.toString();
+			ASSERT_EQ(expected, noMemo.isAnswer(assignments)) << assignments.toString();
+		}
+
+		ASSERT_LT(0, memoized.detecterStats().memoHitCount);
+		ASSERT_EQ(0, noMemo.detecterStats().memoHitCount);
+		ASSERT_LT(0.0L, memoized.detecterStats().memoHitRate());
+		ASSERT_EQ(0.0L, noMemo.detecterStats().memoHitRate());
+		ASSERT_EQ(noMemo.detecterStats().memoMissCount,
+			memoized.detecterStats().memoHitCount + memoized.detecterStats().memoMissCount);
+	}
+
+	TEST_F(FoldabilityTest, adaptiveFactorySwitchesByLineCount) {
+		FoldabilityBenchmark benchmark;
+		auto small = benchmark.createFlap(8);
+		auto large = benchmark.createFlap(12);
+
+		AdaptiveFoldabilityDetecterFactory<mylib::BitSet> factory(10);
+
+		auto smallDetecter = factory.create(small);
+		auto largeDetecter = factory.create(large);
+
+		ASSERT_TRUE(dynamic_cast<IsFoldable<mylib::BitSet>*>(smallDetecter) != nullptr);
+		ASSERT_TRUE(dynamic_cast<IsFoldableLinear<mylib::BitSet>*>(largeDetecter) != nullptr);
+
+		delete smallDetecter;
+		delete largeDetecter;
+	}
+
+	TEST_F(FoldabilityTest, findCrossover) {
+		std::vector<FoldabilityTimings> timingsList = {
+			{ 4, 1.0, 2.0 }, { 6, 2.0, 1.0 }, { 8, 3.0, 4.0 }, { 10, 4.0, 3.0 }, { 12, 5.0, 4.0 }
+		};
+		ASSERT_EQ(10, FoldabilityBenchmark::findCrossover(timingsList));
+
+		timingsList.back().linearNanoSec = 6.0;
+		ASSERT_EQ(14, FoldabilityBenchmark::findCrossover(timingsList));
+	}
+
+	TEST_F(FoldabilityTest, bitSlicedAgreesWithIsFoldable) {
+		typedef BitSlicedFoldabilityTester::LaneMask LaneMask;
+		FlapPatternForBraceletEnum flap(16);
+
+		// point symmetric with odd half count: satisfies kawasaki theorem.
+		const u_int halfPlaces[] = { 0, 1, 2, 4, 7 };
+		for (const auto& place : halfPlaces) {
+			flap.add(place);
+			flap.add(place + 8);
+		}
+		const u_int lineCount = 10;
+
+		IsFoldable<mylib::BitSet> expectedTester(flap);
+		BitSlicedFoldabilityTester tester(flap);
+
+		// maekawa-valid assignments, packed to lanes.
+		std::vector<BitSet> assignmentsList;
+		for (u_int bits = 0; bits < (1u << lineCount); bits++) {
+			BitSet assignments(lineCount);
+			for (u_int i = 0; i < lineCount; i++) {
+				if (bits & (1u << i)) {
+					assignments.add(i);
+				}
+			}
+			if (assignments.count() == lineCount / 2 - 1) {
+				assignmentsList.push_back(assignments);
+			}
+		}
+
+		int foldableCount = 0;
+		for (size_t begin = 0; begin < assignmentsList.size(); begin += BitSlicedFoldabilityTester::LANE_COUNT) {
+			std::vector<LaneMask> lines(lineCount, 0ULL);
+			LaneMask activeLanes = 0ULL;
+
+			for (u_int lane = 0; lane < BitSlicedFoldabilityTester::LANE_COUNT && begin + lane < assignmentsList.size(); lane++) {
+				activeLanes |= 1ULL << lane;
+				for (u_int i = 0; i < lineCount; i++) {
+					if (assignmentsList[begin + lane].contains(i)) {
+						lines[i] |= 1ULL << lane;
+					}
+				}
+			}
+
+			const auto foldables = tester.test(lines.data(), activeLanes);
+
+			for (u_int lane = 0; lane < BitSlicedFoldabilityTester::LANE_COUNT && begin + lane < assignmentsList.size(); lane++) {
+				const auto& assignments = assignmentsList[begin + lane];
+				const bool expected = expectedTester.isAnswer(assignments);
+				ASSERT_EQ(expected, (foldables & (1ULL << lane)) != 0ULL) << assignments.toString();
+
+				if (expected)
+					foldableCount++;
+			}
+		}
+
+		ASSERT_LT(0, foldableCount);
+	}
 }
@@ -0,0 +1,127 @@
+﻿#include "gtest/gtest.h"
+#include "IndexedCPFormat.hpp"
+#include "FlapCPEnumeration.hpp"
+#include "BitSet.hpp"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace enumeration;
+	using namespace enumeration::origami;
+
+	class IndexedCPFormatTest : public ::testing::Test {
+	protected:
+		typedef std::vector<unsigned char> Key;
+
+		const std::string path = "IndexedCPFormatTest.cpi";
+
+		virtual void TearDown() {
+			std::remove(path.c_str());
+		}
+
+		// CP strings of every answer by flap key.
+		struct ReferenceEncoder {
+			std::map<Key, std::vector<std::string> > cpStrings;
+
+			template <typename TBitSet>
+			void operator()(const EncodablePatternBase& flap, const TBitSet& minors) {
+				Key key(IndexedCPFormat::keySize(flap.capacity()));
+				IndexedCPFormat::writeKey(flap, key.data());
+				cpStrings[key].push_back(flap.encode(minors));
+			}
+		};
+
+		struct RecordCollector {
+			IndexedCPWriter& writer;
+
+			RecordCollector(IndexedCPWriter& writer) : writer(writer) {}
+
+			template<typename TKey>
+			RecordCollector& operator<<(const Countable<TKey, IndexedCPRecord>& item) {
+				writer << item.value;
+				return *this;
+			}
+		};
+	};
+
+	TEST_F(IndexedCPFormatTest, testKeyIsGapSequence) {
+		const u_int placeCount = 13;
+
+		// the base point is 3.
+		FlapPatternForBraceletEnum flap(placeCount);
+		const u_int lines[] = { 3, 4, 7, 8, 11, 12 };
+		for (const auto& line : lines) {
+			flap.add(line);
+		}
+
+		Key key(IndexedCPFormat::keySize(placeCount));
+		IndexedCPFormat::writeKey(flap, key.data());
+		ASSERT_EQ(IndexedCPFormat::createKey({ 1, 3, 1, 3, 1, 4 }, placeCount), key);
+
+		ASSERT_THROW(IndexedCPFormat::createKey({ 1, 0 }, placeCount), std::invalid_argument);
+		ASSERT_THROW(IndexedCPFormat::checkPlaceCount(256), std::length_error);
+	}
+
+	TEST_F(IndexedCPFormatTest, testFindReturnsRecordsOfTheFlap) {
+		const u_int placeCount = 14;
+
+		ReferenceEncoder expected;
+		{
+			FoldableFlapCPEnumeration<false> enumerator;
+			enumerator.enumerate(placeCount, expected);
+		}
+		ASSERT_LT(1, expected.cpStrings.size());
+
+		{
+			std::ofstream fout(path, std::ios::binary);
+			// small buffer: records are flushed many times.
+			IndexedCPWriter writer(fout, BinaryCPHeader(placeCount, "cp", 2), 16);
+			RecordCollector records(writer);
+
+			FoldableFlapCPEnumeration<false> enumerator;
+			IndexedCPEncoder<RecordCollector> encoder(records);
+			enumerator.enumerate(placeCount, encoder);
+
+			writer.close();
+			ASSERT_EQ(expected.cpStrings.size(), writer.flapCount());
+		}
+
+		IndexedCPFile file(path);
+		ASSERT_EQ(placeCount, file.header().placeCount);
+		ASSERT_EQ(2, file.header().rank);
+		ASSERT_EQ(expected.cpStrings.size(), file.flapCount());
+
+		for (const auto& flap : expected.cpStrings) {
+			auto records = file.find(flap.first.data());
+			ASSERT_EQ(flap.second.size(), records.count());
+			for (u_int i = 0; i < records.count(); i++) {
+				ASSERT_EQ(flap.second[i], records.cpString(i));
+			}
+		}
+
+		// no such flap.
+		ASSERT_TRUE(file.find(std::vector<u_int>{ placeCount }).empty());
+	}
+
+	TEST_F(IndexedCPFormatTest, testBrokenFileIsRejected) {
+		{
+			std::ofstream fout(path, std::ios::binary);
+			IndexedCPWriter writer(fout, BinaryCPHeader(12, "cp", 0));
+		}
+		{
+			IndexedCPFile file(path);
+			ASSERT_EQ(0, file.flapCount());
+		}
+
+		{
+			std::ofstream fout(path, std::ios::binary);
+			fout << "FCPI and not an indexed file";
+		}
+		ASSERT_THROW(IndexedCPFile file(path), std::invalid_argument);
+
+		ASSERT_THROW(IndexedCPFile file("no such file.cpi"), std::invalid_argument);
+	}
+}
@@ -74,4 +74,37 @@ namespace {
 		ASSERT_EQ(6, inverterMirror3(0));
 
 	}
+
+	// BitSet overloads use bulk rotation/reverse; they must match the per-item mapping.
+	TEST_F(InverterTest, testBitSetOverloads) {
+		for (const unsigned int count : { 8u, 22u, 67u }) {
+			mylib::BitSet pattern(count);
+			for (unsigned int i = 0; i < count; i += 3) {
+				pattern.add(i);
+			}
+			if (!pattern.contains(count - 1)) {
+				pattern.add(count - 1);
+			}
+
+			auto assertSameMapping = [&](const enumeration::IInverter& inverter, const mylib::BitSet& inverse) {
+				mylib::BitSet expected(count);
+				for (unsigned int i = 0; i < count; i++) {
+					if (pattern.contains(i)) {
+						expected.add(inverter(i));
+					}
+				}
+				ASSERT_EQ(expected, inverse) << inverter.toString();
+				ASSERT_EQ(expected.count(), inverse.count()) << inverter.toString();
+			};
+
+			for (unsigned int i = 0; i < count; i++) {
+				RotationInverter rotation(i, count);
+				assertSameMapping(rotation, rotation(pattern));
+				MirrorInverter mirror(i, count);
+				assertSameMapping(mirror, mirror(pattern));
+				MiddleMirrorInverter middleMirror(i, count);
+				assertSameMapping(middleMirror, middleMirror(pattern));
+			}
+		}
+	}
 }
@@ -0,0 +1,45 @@
+﻿#include "gtest/gtest.h"
+#include "KernelBenchmark.hpp"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace enumeration::origami;
+
+	TEST(KernelBenchmarkTest, testCorpusIsKawasakiFlaps) {
+		KernelBenchmark benchmark(12, 1, 4);
+
+		ASSERT_FALSE(benchmark.corpus().empty());
+		for (const auto& flap : benchmark.corpus()) {
+			ASSERT_EQ(0, flap.count() % 2);
+		}
+	}
+
+	TEST(KernelBenchmarkTest, testCorpusIsLimited) {
+		KernelBenchmark benchmark(16, 1, 4, 10);
+
+		ASSERT_GE(10u, benchmark.corpus().size());
+		ASSERT_LT(0u, benchmark.corpus().size());
+	}
+
+	TEST(KernelBenchmarkTest, testWriteCSV) {
+		std::vector<KernelTiming> timings = {
+			{ "bitarray_fill", "bits=64", 120ULL, 35.5 },
+			{ "mv_enumeration", "lsl,n=12", 7ULL, 2.25 }
+		};
+
+		std::stringstream ss;
+		KernelBenchmark::writeCSV(ss, timings);
+
+		std::string line;
+		std::getline(ss, line);
+		ASSERT_EQ("benchmark,parameter,operations,ns_per_op", line);
+		std::getline(ss, line);
+		ASSERT_EQ("bitarray_fill,\"bits=64\",120,35.5", line);
+		// the parameter is quoted since it may have commas.
+		std::getline(ss, line);
+		ASSERT_EQ("mv_enumeration,\"lsl,n=12\",7,2.25", line);
+		ASSERT_TRUE(std::getline(ss, line).fail());
+	}
+}
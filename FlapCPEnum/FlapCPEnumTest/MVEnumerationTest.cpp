@@ -7,6 +7,9 @@
 #include "BitSet.hpp"
 #include "MVEnumeration.hpp"
 #include "inverters.hpp"
+#include "IsFoldable.hpp"
+#include "StatsMaekawaTheorem.hpp"
+#include "CrimpPruningMVEnumeration.hpp"
 
 namespace {
 	using namespace std;
@@ -141,6 +144,268 @@ namespace {
 		ASSERT_EQ(9, os.answers.size());
 	}
 
+	TEST_F(MVEnumerationTest, testEnumerationMirrorSym_FAST_PPCFallback) {
+		FlapPattern flap(8);
+		OutputReceiver os;
+
+		flap.add(0);
+		flap.add(2);
+		flap.add(4);
+		flap.add(6);
+
+		flap.add(1);
+		flap.add(3);
+
+		// no room for the cache
+		LinearMVEnumeration<OutputReceiver, BitSet> enumerator(0);
+		enumerator.enumerate(flap, os);
+
+		ASSERT_EQ(1, enumerator.ppcFallbackCount());
+		ASSERT_EQ(9, os.answers.size());
+	}
+
+	TEST_F(MVEnumerationTest, testEnumerationMirrorSym_RevolvingDoor) {
+		FlapPattern flap(8);
+		OutputReceiver os;
+
+		flap.add(0);
+		flap.add(2);
+		flap.add(4);
+		flap.add(6);
+
+		flap.add(1);
+		flap.add(3);
+
+		RevolvingDoorMVEnumeration<OutputReceiver, BitSet> enumerator;
+		enumerator.enumerate(flap, os);
+
+		ASSERT_EQ(9, os.answers.size());
+	}
+
+	TEST_F(MVEnumerationTest, testRevolvingDoorFindsTheSameAsPPC) {
+		const u_int placeCount = 16;
+		FlapPattern flap(placeCount);
+
+		for (u_int i = 0; i < placeCount; i += 3) {
+			flap.add(i);
+		}
+		flap.add(1);
+		flap.add(8);
+
+		OutputReceiver expected, actual;
+
+		MVEnumeration<OutputReceiver, BitSet> ppc;
+		ppc.enumerate(flap, expected);
+
+		RevolvingDoorMVEnumeration<OutputReceiver, BitSet> revolvingDoor;
+		revolvingDoor.enumerate(flap, actual);
+
+		ASSERT_EQ(expected.answers.size(), actual.answers.size());
+
+		for (const auto& answer : actual.answers) {
+			auto found = std::find(expected.answers.begin(), expected.answers.end(), answer);
+			ASSERT_TRUE(found != expected.answers.end()) << answer.toString();
+		}
+	}
+
+	TEST_F(MVEnumerationTest, testCrimpPruningFindsTheSameAsIsFoldable) {
+		const u_int placeCount = 16;
+		FlapPattern flap(placeCount);
+
+		// point symmetric with odd half count: satisfies kawasaki theorem.
+		const u_int halfLines[] = { 0, 1, 2, 4, 7 };
+		for (const auto& i : halfLines) {
+			flap.add(i);
+			flap.add(i + placeCount / 2);
+		}
+
+		OutputReceiver expected, actual;
+
+		IsFoldable<BitSet> foldable(flap);
+		MVEnumeration<OutputReceiver, BitSet> ppc;
+		ppc.enumerate(flap, expected, foldable);
+
+		StatsMaekawaTheorem<BitSet> maekawa;
+		CrimpPruningMVEnumeration<OutputReceiver, BitSet> crimpPruning;
+		crimpPruning.enumerate(flap, actual, maekawa);
+
+		ASSERT_LT(0, expected.answers.size());
+		ASSERT_EQ(expected.answers.size(), actual.answers.size());
+
+		for (const auto& answer : actual.answers) {
+			auto found = std::find(expected.answers.begin(), expected.answers.end(), answer);
+			ASSERT_TRUE(found != expected.answers.end()) << answer.toString();
+		}
+	}
+
+	TEST_F(MVEnumerationTest, testFlapContextMatchesPerStageSetup) {
+		const u_int placeCount = 16;
+		FlapPattern flap(placeCount);
+
+		// only the rotation by a half survives among rotations.
+		const u_int halfLines[] = { 0, 1, 3, 6, 7 };
+		for (const auto& i : halfLines) {
+			flap.add(i);
+			flap.add(i + placeCount / 2);
+		}
+		const u_int lineCount = flap.count();
+
+		const FlapContext context(flap);
+
+		ASSERT_EQ(placeCount, context.placeCount());
+		ASSERT_EQ(lineCount, context.lineCount());
+
+		LineIndexMapFactory mapFactory;
+		auto map = mapFactory.create(flap);
+		for (u_int i = 0; i < lineCount; i++) {
+			ASSERT_EQ(map[i], context.lineMap()[i]);
+			ASSERT_EQ(i, context.reverseMap()[map[i]]);
+		}
+		ASSERT_EQ(std::numeric_limits<u_int>::max(), context.reverseMap()[2]);
+
+		FlapPatternStringFactory stringFactory;
+		auto circularString = stringFactory.createCircularString(flap);
+		auto contextString = context.circularString();
+		ASSERT_EQ(circularString.asString(), contextString.asString());
+
+		for (u_int i = 0; i < lineCount; i++) {
+			ASSERT_EQ(circularString.getAngle(i), context.angles()[i]);
+
+			const auto& interval = context.equalAngleIntervals()[i];
+			if (interval.second != -1) {
+				ASSERT_LE(interval.first, (int)i);
+				ASSERT_LT((int)i, interval.second);
+			}
+		}
+
+		// the same inverters as the ones with their own reverse maps.
+		using namespace enumeration;
+		u_int rotCount = 0;
+		for (u_int i = 1; i < placeCount; i++) {
+			MappedIndexInverter<circular::RotationInverter> inv(circular::RotationInverter(i, placeCount), placeCount, map, lineCount);
+			rotCount += inv.canInvert() ? 1 : 0;
+		}
+		u_int mirrorCount = 0;
+		for (u_int i = 1; i < placeCount / 2 + 1; i++) {
+			MappedIndexInverter<circular::MirrorInverter> inv(circular::MirrorInverter(i, placeCount), placeCount, map, lineCount);
+			mirrorCount += inv.canInvert() ? 1 : 0;
+		}
+		ASSERT_EQ(1, rotCount);
+		ASSERT_EQ(rotCount, context.rotationInverters().size());
+		ASSERT_EQ(mirrorCount, context.mirrorInverters().size());
+
+		const auto& rot = context.rotationInverters().front();
+		for (u_int i = 0; i < lineCount; i++) {
+			ASSERT_EQ((i + lineCount / 2) % lineCount, rot(i));
+		}
+
+		MVSymmetryDetecter<BitSet> detecter(context);
+		ASSERT_EQ(context.rotationInverters().size() + context.mirrorInverters().size() + context.middleMirrorInverters().size(),
+			detecter.createInverterReferences().size());
+	}
+
+	TEST_F(MVEnumerationTest, testPruningMaxDepth) {
+		for (const int lineCount : { 4, 10, 22 }) {
+			BitSet pattern(lineCount);
+			MaekawaPruning<BitSet> maekawa;
+
+			// the deepest visited node is pruned, and its parent is not.
+			const int maxDepth = maekawa.maxDepth(lineCount);
+			ASSERT_TRUE(maekawa.needPruning(pattern, maxDepth)) << lineCount;
+			ASSERT_FALSE(maekawa.needPruning(pattern, maxDepth - 1)) << lineCount;
+
+			ASSERT_EQ(lineCount, mylib::NoPruning<BitSet>().maxDepth(lineCount));
+		}
+	}
+
+	TEST_F(MVEnumerationTest, testEqualAngleIntervalWrapsAroundLineZero) {
+		FlapPattern flap(12);
+
+		// angles: 4, 1, 1, 4, 1, 1
+		const u_int lines[] = { 0, 4, 5, 6, 10, 11 };
+		for (const auto& i : lines) {
+			flap.add(i);
+		}
+
+		const FlapContext context(flap);
+		const auto& intervals = context.equalAngleIntervals();
+
+		// the interval of lines 4 and 5 ends at line 0 after wrapping around.
+		// it is not written beyond the last line, so line 0 keeps no interval.
+		ASSERT_EQ(context.lineCount(), intervals.size());
+		for (u_int i = 1; i < 4; i++) {
+			ASSERT_EQ(std::make_pair(1, 4), intervals[i]);
+		}
+		ASSERT_EQ(std::make_pair(4, 7), intervals[4]);
+		ASSERT_EQ(std::make_pair(4, 7), intervals[5]);
+		ASSERT_EQ(-1, intervals[0].second);
+	}
+
+	TEST_F(MVEnumerationTest, testEnumerationInContextFindsTheSame) {
+		const u_int placeCount = 16;
+		FlapPattern flap(placeCount);
+
+		const u_int halfLines[] = { 0, 1, 2, 4, 7 };
+		for (const auto& i : halfLines) {
+			flap.add(i);
+			flap.add(i + placeCount / 2);
+		}
+
+		const FlapContext context(flap);
+
+		auto assertSame = [&](auto& enumerator) {
+			OutputReceiver expected, actual;
+
+			IsFoldable<BitSet> foldable(flap);
+			enumerator.enumerate(flap, expected, foldable);
+
+			FoldabilityDetecterFactory<BitSet> factory;
+			auto detecter = factory.create(context);
+			enumerator.enumerateInContext(context, actual, *detecter, MaekawaPruning<BitSet>());
+			delete detecter;
+
+			ASSERT_LT(0, expected.answers.size());
+			ASSERT_EQ(expected.answers, actual.answers);
+		};
+
+		MVEnumeration<OutputReceiver, BitSet> ppc;
+		assertSame(ppc);
+
+		MVLSLEnumeration<OutputReceiver, BitSet> lsl;
+		assertSame(lsl);
+
+		ExtendedMVLSLEnumeration<OutputReceiver, BitSet> extendedLsl;
+		assertSame(extendedLsl);
+
+		RevolvingDoorMVEnumeration<OutputReceiver, BitSet> revolvingDoor;
+		assertSame(revolvingDoor);
+
+		LinearMVEnumeration<OutputReceiver, BitSet> linear;
+		assertSame(linear);
+	}
+
+	TEST_F(MVEnumerationTest, testPartiallyCrimpedRingDetectsLargeSmallLarge) {
+		std::vector<u_int> angles = { 2, 1, 2, 3 };
+		PartiallyCrimpedRing ring(angles);
+
+		// angle 1 is bounded by line 1 and line 2.
+		ring.fix(1, PartiallyCrimpedRing::MAJOR);
+		ASSERT_TRUE(ring.reduce());
+		ring.fix(2, PartiallyCrimpedRing::MAJOR);
+		ASSERT_FALSE(ring.reduce());
+
+		PartiallyCrimpedRing crimped(angles);
+		crimped.fix(1, PartiallyCrimpedRing::MAJOR);
+		crimped.fix(2, PartiallyCrimpedRing::MINOR);
+		ASSERT_TRUE(crimped.reduce());
+		ASSERT_EQ(2, crimped.count());
+
+		crimped.fix(0, PartiallyCrimpedRing::MAJOR);
+		crimped.fix(3, PartiallyCrimpedRing::MAJOR);
+		ASSERT_TRUE(crimped.reduce());
+		ASSERT_TRUE(crimped.isFoldableCompletely());
+	}
+
 	TEST_F(MVEnumerationTest, test16Lines) {
 		u_int placeCount = 16;
 
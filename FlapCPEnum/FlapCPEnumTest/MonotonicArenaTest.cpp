@@ -0,0 +1,129 @@
+﻿#include "gtest/gtest.h"
+#include "MonotonicArena.hpp"
+#include "SharedArrayPointer.hpp"
+#include "FlapPattern.hpp"
+#include "MVEnumeration.hpp"
+#include "IsFoldable.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace {
+	using namespace enumeration::origami;
+
+	class MonotonicArenaTest : public ::testing::Test {
+	protected:
+		FlapPattern createFlap(const u_int placeCount, const u_int shift) {
+			FlapPattern flap(placeCount);
+
+			const u_int halfLines[] = { 0, 1, 2, 4, 7 };
+			for (const auto& i : halfLines) {
+				flap.add((i + shift) % placeCount);
+				flap.add((i + shift + placeCount / 2) % placeCount);
+			}
+			return flap;
+		}
+	};
+
+	TEST_F(MonotonicArenaTest, testAlignmentAndOwnership) {
+		mylib::MonotonicArena arena(256);
+
+		auto* c = arena.allocateArray<char>(3);
+		auto* d = arena.allocateArray<double>(5);
+		auto* big = arena.allocateArray<char>(1000);
+
+		ASSERT_EQ(0, (uintptr_t)d % alignof(double));
+		ASSERT_EQ(3 + 5 * sizeof(double) + 1000, arena.bytesAllocated());
+		ASSERT_EQ(2, arena.chunkCount());
+
+		ASSERT_TRUE(arena.owns(c));
+		ASSERT_TRUE(arena.owns(d + 4));
+		ASSERT_TRUE(arena.owns(big + 999));
+
+		int onStack = 0;
+		ASSERT_FALSE(arena.owns(&onStack));
+	}
+
+	TEST_F(MonotonicArenaTest, testResetReusesChunks) {
+		mylib::MonotonicArena arena(1024);
+
+		for (int round = 0; round < 10; round++) {
+			for (int i = 0; i < 100; i++) {
+				auto* values = arena.allocateArray<u_int>(64);
+				values[63] = i;
+			}
+			arena.reset();
+			ASSERT_EQ(0, arena.bytesAllocated());
+		}
+
+		const auto capacity = arena.capacity();
+		const auto chunkCount = arena.chunkCount();
+
+		for (int i = 0; i < 100; i++) {
+			arena.allocateArray<u_int>(64);
+		}
+		ASSERT_EQ(capacity, arena.capacity());
+		ASSERT_EQ(chunkCount, arena.chunkCount());
+	}
+
+	TEST_F(MonotonicArenaTest, testAllocatorAndSharedArray) {
+		mylib::MonotonicArena arena;
+
+		std::vector<u_int, mylib::ArenaAllocator<u_int> > values(&arena);
+		for (u_int i = 0; i < 1000; i++) {
+			values.push_back(i);
+		}
+		ASSERT_TRUE(arena.owns(values.data()));
+		ASSERT_EQ(999, values.back());
+
+		// no arena: heap
+		std::vector<u_int, mylib::ArenaAllocator<u_int> > heapValues(10, 1);
+		ASSERT_FALSE(arena.owns(heapValues.data()));
+
+		mylib::SharedArrayPointer<u_int> shared(8, arena);
+		ASSERT_TRUE(arena.owns(shared.getRawArray()));
+
+		auto copy = shared;
+		copy[3] = 5;
+		ASSERT_EQ(5, shared[3]);
+		ASSERT_EQ(2, shared.useCount());
+	}
+
+	TEST_F(MonotonicArenaTest, testFlapContextOnArena) {
+		const u_int placeCount = 16;
+		mylib::MonotonicArena arena;
+		FoldabilityDetecterFactory<mylib::BitSet> factory;
+
+		size_t capacity = 0;
+
+		for (u_int shift = 0; shift < placeCount; shift++) {
+			auto flap = createFlap(placeCount, shift);
+			{
+				const FlapContext expected(flap);
+				const FlapContext context(flap, arena);
+
+				ASSERT_TRUE(arena.owns(context.lineMap().getRawArray()));
+				ASSERT_TRUE(arena.owns(context.rotationInverters().data()));
+
+				for (u_int i = 0; i < context.lineCount(); i++) {
+					ASSERT_EQ(expected.lineMap()[i], context.lineMap()[i]);
+					ASSERT_EQ(expected.angles()[i], context.angles()[i]);
+					ASSERT_EQ(expected.equalAngleIntervals()[i], context.equalAngleIntervals()[i]);
+				}
+				ASSERT_EQ(expected.rotationInverters().size(), context.rotationInverters().size());
+				ASSERT_EQ(expected.mirrorInverters().size(), context.mirrorInverters().size());
+				ASSERT_EQ(expected.middleMirrorInverters().size(), context.middleMirrorInverters().size());
+
+				auto detecter = factory.create(context, arena);
+				ASSERT_TRUE(arena.owns(detecter));
+				factory.destroy(detecter, arena);
+			}
+			arena.reset();
+
+			// the same shape for every shift: no growth after the first flap.
+			if (shift == 0) {
+				capacity = arena.capacity();
+			}
+			ASSERT_EQ(capacity, arena.capacity());
+		}
+	}
+}
@@ -0,0 +1,98 @@
+﻿#include "gtest/gtest.h"
+#include "FlapCPEnumeration.hpp"
+#include "ItemCountingStream.hpp"
+#include "PhaseTimer.hpp"
+#include <thread>
+
+namespace {
+	using namespace enumeration;
+	using namespace enumeration::origami;
+
+	TEST(PhaseTimerTest, testNestedPhasesAreExclusive) {
+		PhaseTimer<true> timer;
+		{
+			ScopedPhase<true> outer(timer, PhaseTimes::KAWASAKI);
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			{
+				ScopedPhase<true> inner(timer, PhaseTimes::FOLDABILITY);
+				std::this_thread::sleep_for(std::chrono::milliseconds(40));
+			}
+		}
+		// out of phases.
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		auto times = timer.times();
+		ASSERT_LE(0.02, times.seconds[PhaseTimes::KAWASAKI]);
+		ASSERT_GT(0.04, times.seconds[PhaseTimes::KAWASAKI]);
+		ASSERT_LE(0.04, times.seconds[PhaseTimes::FOLDABILITY]);
+		ASSERT_EQ(0.0, times.seconds[PhaseTimes::ENCODING]);
+		ASSERT_GT(0.08, times.total());
+	}
+
+	// half of the outer phase is spent in the inner one, so the sampler splits its time about evenly.
+	TEST(PhaseTimerTest, testInnerPhaseIsEstimatedFromSamples) {
+		typedef std::chrono::steady_clock Clock;
+		auto busyFor = [](const std::chrono::milliseconds duration) {
+			const auto start = Clock::now();
+			while (Clock::now() - start < duration) {
+			}
+		};
+
+		PhaseTimer<true> timer;
+		{
+			ScopedPhase<true> outer(timer, PhaseTimes::MV_SEARCH);
+			for (int i = 0; i < 100; i++) {
+				{
+					InnerPhase inner(timer, PhaseTimes::FOLDABILITY);
+					busyFor(std::chrono::milliseconds(1));
+				}
+				busyFor(std::chrono::milliseconds(1));
+			}
+		}
+
+		auto times = timer.times();
+		ASSERT_LT(0.05, times.seconds[PhaseTimes::FOLDABILITY]);
+		ASSERT_GT(0.15, times.seconds[PhaseTimes::FOLDABILITY]);
+		ASSERT_LT(0.05, times.seconds[PhaseTimes::MV_SEARCH]);
+		ASSERT_LE(0.2, times.total());
+		ASSERT_EQ(0.0, times.seconds[PhaseTimes::DUPLICATION]);
+	}
+
+	TEST(PhaseTimerTest, testDisabledTimerIsZero) {
+		PhaseTimer<false> timer;
+		{
+			ScopedPhase<false> phase(timer, PhaseTimes::KAWASAKI);
+		}
+		ASSERT_EQ(0.0, timer.times().total());
+	}
+
+	TEST(PhaseTimerTest, testTimersDoNotChangeResults) {
+		const u_int placeCount = 16;
+
+		ItemCountingStream<> plainCounts(placeCount / 2);
+		CountOnlyEncoder<ItemCountingStream<> > plainEncoder(plainCounts);
+		FoldableFlapCPEnumeration<true> plain;
+		plain.enumerate(placeCount, plainEncoder);
+
+		ItemCountingStream<> timedCounts(placeCount / 2);
+		CountOnlyEncoder<ItemCountingStream<> > timedEncoder(timedCounts);
+		FoldableFlapCPEnumeration<true, mylib::BitSet, true> timed;
+		timed.enumerate(placeCount, timedEncoder);
+
+		ASSERT_EQ(plainCounts.total(), timedCounts.total());
+		ASSERT_EQ(plain.mvStats().answerCount, timed.mvStats().answerCount);
+		ASSERT_EQ(0.0, plain.phaseTimes().total());
+
+		const auto& times = timed.phaseTimes();
+		for (int phase : { PhaseTimes::KAWASAKI, PhaseTimes::FLAP_SETUP }) {
+			ASSERT_LT(0.0, times.seconds[phase]) << PhaseTimes::name(phase);
+		}
+		// the search is split among the inner phases by a few samples in such a short run.
+		double searchSeconds = 0.0;
+		for (int phase : { PhaseTimes::MV_SEARCH, PhaseTimes::DUPLICATION, PhaseTimes::FOLDABILITY, PhaseTimes::ENCODING }) {
+			ASSERT_LE(0.0, times.seconds[phase]) << PhaseTimes::name(phase);
+			searchSeconds += times.seconds[phase];
+		}
+		ASSERT_LT(0.0, searchSeconds);
+	}
+}
@@ -0,0 +1,51 @@
+﻿#include "gtest/gtest.h"
+#include "RevolvingDoorCombination.hpp"
+#include <set>
+
+namespace {
+
+	class RevolvingDoorCombinationTest : public ::testing::Test {
+	protected:
+		unsigned int toBits(const mylib::RevolvingDoorCombination& combination) {
+			unsigned int bits = 0;
+			for (int i = 0; i < combination.itemCount(); i++) {
+				bits |= 1u << combination.items()[i];
+			}
+			return bits;
+		}
+
+		unsigned long long binomial(int n, int t) {
+			unsigned long long c = 1;
+			for (int i = 0; i < t; i++) {
+				c = c * (n - i) / (i + 1);
+			}
+			return c;
+		}
+	};
+
+	TEST_F(RevolvingDoorCombinationTest, testAllCombinationsBySwap) {
+		for (int n = 0; n <= 12; n++) {
+			for (int t = 0; t <= n; t++) {
+				mylib::RevolvingDoorCombination combination(n, t);
+				std::set<unsigned int> visited;
+
+				auto last = toBits(combination);
+				visited.insert(last);
+
+				while (combination.next()) {
+					auto current = toBits(combination);
+
+					// one item leaves and another enters.
+					ASSERT_EQ(last ^ current,
+						(1u << combination.removedItem()) | (1u << combination.addedItem())) << n << " " << t;
+					ASSERT_TRUE(current & (1u << combination.addedItem()));
+
+					ASSERT_TRUE(visited.insert(current).second) << "duplicated: n=" << n << " t=" << t;
+					last = current;
+				}
+
+				ASSERT_EQ(binomial(n, t), visited.size()) << "n=" << n << " t=" << t;
+			}
+		}
+	}
+}
@@ -1,6 +1,9 @@
 ﻿#include "gtest/gtest.h"
 
 #include "RingList.hpp"
+#include "CompactRing.hpp"
+#include <list>
+#include <stdexcept>
 
 namespace {
 
@@ -120,4 +123,88 @@ namespace {
 		ASSERT_EQ(5, ring1.count());
 
 	}
+
+	TEST_F(RingListTest, testCompactRing) {
+		enumeration::origami::CompactLineGapRing<8> ring(5);
+
+		ring.set(0, 1, 'M');
+		ring.set(2, 2, 'V');
+		ring.set(4, 3, 'M');
+		ring.makeLinks();
+
+		ASSERT_EQ(3, ring.count());
+		ASSERT_EQ(0, ring.peekHeadIndex());
+		ASSERT_EQ(4, ring.peekTailIndex());
+		ASSERT_EQ(2, ring.nextIndexOf(0));
+		ASSERT_EQ(0, ring.nextIndexOf(4));
+		ASSERT_FALSE(ring.exists(1));
+
+		auto copied = ring;
+		ring.remove(0);
+
+		ASSERT_EQ(2, ring.count());
+		ASSERT_EQ(2, ring.peekHeadIndex());
+		ASSERT_EQ(4, ring.prevIndexOf(2));
+		ASSERT_FALSE(ring.exists(0));
+
+		// the copy is independent.
+		ASSERT_EQ(3, copied.count());
+		ASSERT_TRUE(copied.exists(0));
+		ASSERT_EQ(2, copied.nextIndexOf(0));
+		ASSERT_EQ(3, copied.angleToNext(4));
+		ASSERT_EQ('V', copied.lineType(2));
+
+		ASSERT_THROW(ring.resize(9), std::length_error);
+	}
+
+	TEST_F(RingListTest, testNodesAreContiguous) {
+		mylib::RingList<int> ring(4);
+		for (int i = 0; i < 4; i++) {
+			ring.add(i);
+		}
+
+		// the pool hands out the slab in address order.
+		auto head = reinterpret_cast<char *>(&*ring.head());
+		auto tail = reinterpret_cast<char *>(&*ring.tail());
+		ASSERT_EQ((long long)(3 * sizeof(mylib::RingListNode<int>)), tail - head);
+
+		// removed nodes are reused.
+		auto itr = ring.head();
+		itr.remove();
+		ring.add(4);
+		ASSERT_EQ(head, reinterpret_cast<char *>(&*ring.tail()));
+	}
+
+	TEST_F(RingListTest, testRemoveEveryOtherLikeList) {
+		for (const int size : { 4, 32, 128 }) {
+			mylib::RingList<int> ring(size);
+			std::list<int> list;
+
+			// refill after clear() reuses the nodes.
+			for (int r = 0; r < 2; r++) {
+				ring.clear();
+				list.clear();
+				for (int i = 0; i < size; i++) {
+					ring.add(i);
+					list.push_back(i);
+				}
+
+				auto ringItr = ring.head();
+				auto listItr = list.begin();
+				for (int i = 0; i < size / 2; i++) {
+					ringItr.remove();
+					ringItr++;
+					listItr = list.erase(listItr);
+					listItr++;
+				}
+
+				ASSERT_EQ(list.size(), (size_t)ring.count()) << size;
+				auto itr = ring.head();
+				for (auto item : list) {
+					ASSERT_EQ(item, *itr) << size;
+					itr++;
+				}
+			}
+		}
+	}
 }
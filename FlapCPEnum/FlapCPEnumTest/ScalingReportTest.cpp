@@ -0,0 +1,97 @@
+﻿#include "gtest/gtest.h"
+#include "ScalingReport.hpp"
+#include <sstream>
+
+namespace {
+	using namespace mylib;
+
+	ScalingRecord createRecord(const std::string& algorithm, unsigned placeCount, int processCount,
+		double seconds, unsigned long long patternCount) {
+		ScalingRecord record;
+		record.algorithm = algorithm;
+		record.placeCount = placeCount;
+		record.processCount = processCount;
+		record.seconds = seconds;
+		record.patternCount = patternCount;
+		record.peakRSSKiloBytes = 1024;
+		record.kawasakiStats.callCount = 10;
+		record.mvStats.answerCount = patternCount;
+		return record;
+	}
+
+	TEST(ScalingReportTest, testCSVAndJSONAreReadBack) {
+		std::vector<ScalingRecord> records = {
+			createRecord("cp", 16, 1, 0.25, 38305),
+			createRecord("cp_parallel", 16, 3, 0.125, 38305)
+		};
+
+		for (bool json : { false, true }) {
+			std::stringstream ss;
+			if (!json) {
+				ScalingReport::writeCSVHeader(ss);
+			}
+			for (const auto& record : records) {
+				json ? ScalingReport::writeJSON(ss, record) : ScalingReport::writeCSV(ss, record);
+			}
+
+			auto loaded = ScalingReport::read(ss, json);
+			ASSERT_EQ(records.size(), loaded.size());
+			for (size_t i = 0; i < records.size(); i++) {
+				ASSERT_EQ(records[i].key(), loaded[i].key());
+				ASSERT_DOUBLE_EQ(records[i].seconds, loaded[i].seconds);
+				ASSERT_EQ(records[i].patternCount, loaded[i].patternCount);
+				ASSERT_EQ(records[i].peakRSSKiloBytes, loaded[i].peakRSSKiloBytes);
+				ASSERT_EQ(records[i].kawasakiStats.callCount, loaded[i].kawasakiStats.callCount);
+				ASSERT_EQ(records[i].mvStats.answerCount, loaded[i].mvStats.answerCount);
+			}
+		}
+	}
+
+	TEST(ScalingReportTest, testJSONNameWithoutValueThrows) {
+		for (const std::string line : { "{\"a\"}", "{\"a\":", "{\"a\": " }) {
+			std::stringstream ss(line + "\n");
+			ASSERT_THROW(ScalingReport::read(ss, true), std::invalid_argument);
+		}
+	}
+
+	TEST(ScalingReportTest, testComparisonFlagsRegressions) {
+		std::vector<ScalingRecord> baseline = {
+			createRecord("cp", 20, 1, 1.0, 100),
+			createRecord("cp", 24, 1, 2.0, 200),
+			createRecord("maekawa", 20, 1, 0.01, 300),
+			createRecord("kawasaki", 20, 1, 1.0, 400)
+		};
+		std::vector<ScalingRecord> current = {
+			createRecord("cp", 20, 1, 1.05, 100),
+			createRecord("cp", 24, 1, 3.0, 201),
+			// too short to compare the time.
+			createRecord("maekawa", 20, 1, 0.05, 300)
+		};
+
+		auto differences = ScalingComparison(0.1, 0.1).compare(baseline, current);
+
+		int timeCount = 0, countCount = 0, missingCount = 0;
+		for (const auto& difference : differences) {
+			if (difference.kind == ScalingDifference::TIME) {
+				timeCount++;
+				ASSERT_EQ("cp n=24 np=1", difference.key);
+			}
+			else if (difference.kind == ScalingDifference::COUNT) {
+				countCount++;
+				ASSERT_EQ("cp n=24 np=1", difference.key);
+			}
+			else {
+				missingCount++;
+				ASSERT_EQ("kawasaki n=20 np=1", difference.key);
+				ASSERT_FALSE(difference.isRegression());
+			}
+		}
+		ASSERT_EQ(1, timeCount);
+		ASSERT_EQ(1, countCount);
+		ASSERT_EQ(1, missingCount);
+	}
+
+	TEST(ScalingReportTest, testPeakResidentSizeIsMeasured) {
+		ASSERT_LT(0ULL, peakResidentKiloBytes());
+	}
+}
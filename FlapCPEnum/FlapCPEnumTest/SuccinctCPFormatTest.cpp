@@ -0,0 +1,149 @@
+﻿#include "gtest/gtest.h"
+#include "SuccinctCPFormat.hpp"
+#include "FlapCPEnumeration.hpp"
+#include "BitSet.hpp"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace enumeration;
+	using namespace enumeration::origami;
+
+	class SuccinctCPFormatTest : public ::testing::Test {
+	protected:
+		typedef std::vector<unsigned char> Key;
+
+		const std::string path = "SuccinctCPFormatTest.cpr";
+
+		virtual void TearDown() {
+			std::remove(path.c_str());
+		}
+
+		// CP strings of every answer by flap key.
+		struct ReferenceEncoder {
+			std::map<Key, std::set<std::string> > cpStrings;
+
+			template <typename TBitSet>
+			void operator()(const EncodablePatternBase& flap, const TBitSet& minors) {
+				Key key(IndexedCPFormat::keySize(flap.capacity()));
+				IndexedCPFormat::writeKey(flap, key.data());
+				cpStrings[key].insert(flap.encode(minors));
+			}
+		};
+
+		struct RecordCollector {
+			SuccinctCPWriter& writer;
+			unsigned long long answerCount;
+
+			RecordCollector(SuccinctCPWriter& writer) : writer(writer), answerCount(0ULL) {}
+
+			RecordCollector& add(const int, const unsigned long long n, const SuccinctCPRecord& record) {
+				answerCount += n;
+				writer << record;
+				return *this;
+			}
+		};
+	};
+
+	TEST_F(SuccinctCPFormatTest, testRankIsDenseAndUnrankIsInverse) {
+		const u_int n = 10, r = 4;
+		ASSERT_EQ(210, CombinationRanker::binomial(n, r));
+		ASSERT_EQ(0, CombinationRanker::binomial(3, 4));
+
+		std::vector<bool> seen(CombinationRanker::binomial(n, r), false);
+		for (u_int bits = 0; bits < (1u << n); bits++) {
+			mylib::BitSet subset(n);
+			for (u_int i = 0; i < n; i++) {
+				if (bits & (1u << i)) {
+					subset.add(i);
+				}
+			}
+			if (subset.count() != r) {
+				continue;
+			}
+
+			const uint64_t rank = CombinationRanker::rank(subset, n);
+			ASSERT_GT(seen.size(), rank);
+			ASSERT_FALSE(seen[rank]);
+			seen[rank] = true;
+
+			mylib::BitSet unranked(n);
+			CombinationRanker::unrank(rank, n, r, unranked);
+			ASSERT_EQ(subset.toString(), unranked.toString());
+		}
+
+		mylib::BitSet subset(n);
+		ASSERT_THROW(CombinationRanker::unrank(210, n, r, subset), std::invalid_argument);
+	}
+
+	TEST_F(SuccinctCPFormatTest, testSmallerPayloadIsChosen) {
+		std::string payload;
+
+		// 1 byte of bitmap against 8 varints.
+		std::vector<uint64_t> dense = { 0, 1, 2, 3, 4, 5, 6, 7 };
+		ASSERT_EQ((int)SuccinctCPFormat::BITMAP, (int)SuccinctCPFormat::encode(dense, 8, payload));
+		ASSERT_EQ(std::string(1, (char)0xFF), payload);
+
+		std::vector<uint64_t> sparse = { 3, 1000 };
+		ASSERT_EQ((int)SuccinctCPFormat::DELTA, (int)SuccinctCPFormat::encode(sparse, 2000, payload));
+		ASSERT_EQ(3, payload.size());
+	}
+
+	TEST_F(SuccinctCPFormatTest, testFileKeepsEveryAnswer) {
+		const u_int placeCount = 16;
+
+		ReferenceEncoder expected;
+		unsigned long long expectedCount = 0;
+		{
+			FoldableFlapCPEnumeration<false> enumerator;
+			enumerator.enumerate(placeCount, expected);
+		}
+		for (const auto& flap : expected.cpStrings) {
+			expectedCount += flap.second.size();
+		}
+		ASSERT_LT(1, expected.cpStrings.size());
+
+		{
+			std::ofstream fout(path, std::ios::binary);
+			SuccinctCPWriter writer(fout, BinaryCPHeader(placeCount, "cp", 0));
+			RecordCollector records(writer);
+
+			FoldableFlapCPEnumeration<false> enumerator;
+			SuccinctCPEncoder<RecordCollector> encoder(records);
+			enumerator.enumerate(placeCount, encoder);
+
+			writer.close();
+			ASSERT_EQ(expected.cpStrings.size(), writer.flapCount());
+			ASSERT_EQ(expectedCount, records.answerCount);
+		}
+
+		SuccinctCPFile file(path);
+		ASSERT_EQ(expected.cpStrings.size(), file.flapCount());
+
+		for (const auto& flap : expected.cpStrings) {
+			auto ranks = file.find(flap.first.data());
+			ASSERT_EQ(flap.second.size(), ranks.count());
+
+			std::set<std::string> actual;
+			ranks.forEachRank([&](const uint64_t rank) {
+				ASSERT_TRUE(ranks.contains(rank));
+				actual.insert(ranks.cpString(rank));
+			});
+			ASSERT_EQ(flap.second, actual);
+
+			// the ranks between and after the answers are not found either.
+			uint64_t containedCount = 0;
+			const uint64_t rankCount = CombinationRanker::binomial(ranks.lineCount(), ranks.minorCount());
+			for (uint64_t rank = 0; rank <= rankCount; rank++) {
+				containedCount += ranks.contains(rank) ? 1 : 0;
+			}
+			ASSERT_EQ(ranks.count(), containedCount);
+		}
+
+		ASSERT_TRUE(file.find(std::vector<u_int>{ placeCount }).empty());
+	}
+}
@@ -0,0 +1,61 @@
+﻿#include "gtest/gtest.h"
+#include "TraceRecorder.hpp"
+#include <sstream>
+#include <thread>
+
+namespace {
+	using namespace mylib;
+
+	TEST(TraceRecorderTest, testSpansAreRecorded) {
+		TraceRecorder<true> trace(2);
+
+		auto start = trace.now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		trace.record(TraceEvent::JOB, start, 0, 12);
+
+		start = trace.now();
+		trace.record(TraceEvent::WAIT_JOB, start, 0, 8);
+
+		const auto& events = trace.events();
+		ASSERT_EQ(2u, events.size());
+		ASSERT_EQ(TraceEvent::JOB, events[0].kind);
+		ASSERT_EQ(2, events[0].rank);
+		ASSERT_EQ(12, events[0].value);
+		ASSERT_LE(5000000LL, events[0].duration);
+		ASSERT_LE(events[0].start + events[0].duration, events[1].start);
+	}
+
+	TEST(TraceRecorderTest, testDisabledRecorderIsEmpty) {
+		TraceRecorder<false> trace(1);
+
+		auto start = trace.now();
+		trace.record(TraceEvent::JOB, start, 0, 12);
+
+		ASSERT_TRUE(trace.events().empty());
+		ASSERT_TRUE(std::is_empty<TraceRecorder<false> >::value);
+	}
+
+	TEST(TraceRecorderTest, testChromeTraceFormat) {
+		TraceEvent event;
+		event.start = 1234567;
+		event.duration = 2005;
+		event.rank = 1;
+		event.kind = TraceEvent::RECEIVE_JOB;
+		event.peer = 0;
+		event.value = 16;
+
+		std::stringstream ss;
+		ChromeTraceWriter::write(ss, { event }, 2);
+		const std::string json = ss.str();
+
+		ASSERT_NE(std::string::npos, json.find("\"traceEvents\":["));
+		ASSERT_NE(std::string::npos, json.find("\"name\":\"rank 0 (master)\""));
+		ASSERT_NE(std::string::npos, json.find(
+			"{\"name\":\"receive job\",\"ph\":\"X\",\"pid\":0,\"tid\":1,\"ts\":1234.567,\"dur\":2.005,\"args\":{\"peer\":0,\"bytes\":16}}"));
+		ASSERT_EQ(std::string::npos, json.find(",\n]"));
+
+		std::stringstream empty;
+		ChromeTraceWriter::write(empty, {}, 0);
+		ASSERT_EQ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n]}\n", empty.str());
+	}
+}
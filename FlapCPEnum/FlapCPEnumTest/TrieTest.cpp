@@ -1,6 +1,8 @@
 ﻿#include "gtest/gtest.h"
 #include "Trie.hpp"
 #include<string>
+#include <set>
+#include <stdexcept>
 
 namespace {
 
@@ -10,6 +12,8 @@ namespace {
 	};
 	class MapTrieTest: public ::testing::Test{
 	};
+	class ArenaPatriciaTrieTest : public ::testing::Test {
+	};
 
 	TEST(TrieTest, testInsertAndFind) {
 		std::string keys[] = { "the", "a", "there",
@@ -92,4 +96,89 @@ namespace {
 		ASSERT_FALSE(trie.contains("aswer"));
 
 	}
+
+	TEST(ArenaPatriciaTrieTest, testInsertAndFind) {
+		std::string keys[] = { "the", "a", "there",
+			"answer", "any", "by",
+			"bye", "their", "an" };
+
+		mylib::ArenaPatriciaTrie trie;
+
+		for (const auto& key : keys) {
+			ASSERT_TRUE(trie.insert(key)) << key;
+		}
+		for (const auto& key : keys) {
+			ASSERT_FALSE(trie.insert(key)) << key;
+			ASSERT_TRUE(trie.contains(key)) << key;
+		}
+		ASSERT_EQ(9u, trie.count());
+
+		ASSERT_FALSE(trie.contains(std::string("th")));
+		ASSERT_FALSE(trie.contains(std::string("these")));
+		ASSERT_FALSE(trie.contains(std::string("answers")));
+		ASSERT_FALSE(trie.contains(std::string("")));
+
+		// empty key
+		ASSERT_TRUE(trie.insert(std::string("")));
+		ASSERT_TRUE(trie.contains(std::string("")));
+
+		trie.clear();
+		ASSERT_EQ(0u, trie.count());
+		ASSERT_FALSE(trie.contains(std::string("the")));
+		ASSERT_TRUE(trie.insert(std::string("the")));
+	}
+
+	// CP-like strings with a few characters and long shared prefixes.
+	TEST(ArenaPatriciaTrieTest, testAgreesWithSet) {
+		mylib::ArenaPatriciaTrie trie;
+		std::set<std::string> expected;
+
+		unsigned long long state = 12345;
+		const char alphabet[] = { '+', '-', '1', '2' };
+		for (int i = 0; i < 20000; i++) {
+			std::string key;
+			for (int j = 0; j < 24; j++) {
+				state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+				// skewed toward '+' to share prefixes
+				const auto r = (state >> 60) & 0x7;
+				key.push_back(r < 4 ? '+' : alphabet[r & 3]);
+			}
+			if (i % 7 == 0) {
+				key.resize(i % 24);
+			}
+
+			ASSERT_EQ(expected.insert(key).second, trie.insert(key)) << key;
+		}
+
+		ASSERT_EQ(expected.size(), trie.count());
+		for (const auto& key : expected) {
+			ASSERT_TRUE(trie.contains(key)) << key;
+		}
+		ASSERT_FALSE(trie.contains(std::string(25, '+')));
+	}
+
+	TEST(ArenaPatriciaTrieTest, testMemoryLimit) {
+		mylib::ArenaPatriciaTrie trie((size_t)1 << 20);
+
+		const auto usage = trie.memoryUsage();
+		ASSERT_LT(0u, usage);
+		ASSERT_TRUE(trie.canHold(1000, 40));
+		ASSERT_FALSE(trie.canHold(1000000, 40));
+
+		// keeps the chunks over clear().
+		for (int i = 0; i < 1000; i++) {
+			trie.insert(std::to_string(i * 7919));
+		}
+		const auto filled = trie.memoryUsage();
+		trie.clear();
+		ASSERT_EQ(filled, trie.memoryUsage());
+		trie.release();
+		ASSERT_EQ(usage, trie.memoryUsage());
+
+		ASSERT_THROW({
+			for (int i = 0; i < 1000000; i++) {
+				trie.insert(std::to_string(i) + std::string(40, 'x') + std::to_string(i));
+			}
+		}, std::length_error);
+	}
 }